@@ -0,0 +1,94 @@
+/*
+ * Description: A pool of the optional components of the Entities, like their PhysicalBody. The components are only
+ * created when an Entity asks for one, so the Entities that don't need it don't pay for it, and they're kept in blocks
+ * of BLOCK_SIZE components each, instead of having one allocation per component scattered over the heap.
+ *
+ * A component never moves once it's created, so the Entity can keep a plain pointer to it. Destroyed components leave
+ * a hole in their block, which is reused by the next one created. The blocks are only released with the pool.
+ *
+ * Creating and destroying components is thread safe, as the Chunks are created by the ChunkLoader workers, but the
+ * components themselves are not: each one must only be used by the thread that is using its Entity.
+ */
+
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+#include <new>
+#include <cstdlib>
+
+template <class T>
+class ComponentPool {
+public:
+
+    /* The number of components in each block. */
+    static const int BLOCK_SIZE = 256;
+
+    ComponentPool(void) : numComponents(0), lock(0) {}
+
+    ~ComponentPool(void) {
+        for (auto it = blocks.begin(); it != blocks.end(); it++) {
+            free(*it);
+        }
+        blocks.clear();
+        freeComponents.clear();
+    }
+
+    /* Creates a component with its default constructor. */
+    T *create() {
+        SDL_AtomicLock(&lock);
+        if (freeComponents.empty() && !addBlock()) {
+            SDL_AtomicUnlock(&lock);
+            throw std::bad_alloc();
+        }
+        void *memory = freeComponents.back();
+        freeComponents.pop_back();
+        numComponents++;
+        SDL_AtomicUnlock(&lock);
+        return new (memory) T();
+    }
+
+    /* Destroys a component created by this pool, leaving its memory to the next one. */
+    void destroy(T *component) {
+        if (component == nullptr) return;
+        component->~T();
+        SDL_AtomicLock(&lock);
+        freeComponents.push_back(component);
+        numComponents--;
+        SDL_AtomicUnlock(&lock);
+    }
+
+    /* Returns the number of components alive. */
+    int size() const { return numComponents; }
+
+    /* Returns the memory taken by the blocks of the pool. */
+    size_t getBytesReserved() const { return blocks.size() * BLOCK_SIZE * sizeof(T); }
+
+protected:
+
+    /* Allocates a new block, with all of its components free. Returns false if the system is out of memory. */
+    bool addBlock() {
+        T *block = (T*) malloc(BLOCK_SIZE * sizeof(T));
+        if (block == nullptr) return false;
+        blocks.push_back(block);
+        // Pushed backwards, so the components of a block are given in order
+        for (int i = BLOCK_SIZE - 1; i >= 0; i--) {
+            freeComponents.push_back(block + i);
+        }
+        return true;
+    }
+
+    /* The blocks of components, and the ones in them that are free. */
+    std::vector<T*> blocks;
+    std::vector<T*> freeComponents;
+
+    /* The number of components alive. */
+    int numComponents;
+
+    /* Only held to take or give back a component, so a spin lock is enough. */
+    SDL_SpinLock lock;
+
+    /* A pool owns its blocks, so it can't be copied. */
+    ComponentPool(const ComponentPool &copy);
+    ComponentPool &operator=(const ComponentPool &other);
+};
@@ -1,72 +1,117 @@
 #include "Entity.h"
+#include "rendering/RenderQueue.h"
+
+ComponentPool<PhysicalBody> Entity::physicalBodies;
+
+/* The header before each Entity, with its MemoryArena and size. Keeps the Entity aligned like the arena allocations. */
+struct AllocationHeader {
+    MemoryArena *arena;
+    size_t size;
+};
+static const size_t ALLOCATION_HEADER_SIZE = MemoryArena::ALIGNMENT;
+static_assert(sizeof(AllocationHeader) <= MemoryArena::ALIGNMENT, "The allocation header must fit in the alignment");
+
+void *Entity::operator new(size_t size) {
+    char *memory = (char*) malloc(size + ALLOCATION_HEADER_SIZE);
+    if (memory == nullptr) throw std::bad_alloc();
+    AllocationHeader *header = (AllocationHeader*) memory;
+    header->arena = nullptr;
+    header->size = size;
+    return memory + ALLOCATION_HEADER_SIZE;
+}
+
+void *Entity::operator new(size_t size, MemoryArena *arena) {
+    if (arena == nullptr) return Entity::operator new(size);
+    char *memory = (char*) arena->allocate(size + ALLOCATION_HEADER_SIZE);
+    if (memory == nullptr) throw std::bad_alloc();
+    AllocationHeader *header = (AllocationHeader*) memory;
+    header->arena = arena;
+    header->size = size;
+    return memory + ALLOCATION_HEADER_SIZE;
+}
+
+void Entity::operator delete(void *pointer, size_t size) {
+    if (pointer == nullptr) return;
+    char *memory = (char*) pointer - ALLOCATION_HEADER_SIZE;
+    MemoryArena *arena = ((AllocationHeader*) memory)->arena;
+    if (arena != nullptr) {
+        arena->deallocate(memory, size + ALLOCATION_HEADER_SIZE);
+    } else {
+        free(memory);
+    }
+}
+
+void Entity::operator delete(void *pointer, MemoryArena * /* arena */) {
+    // Only called if a constructor throws. The arena and the size of the allocation are both in its header
+    if (pointer == nullptr) return;
+    AllocationHeader *header = (AllocationHeader*) ((char*) pointer - ALLOCATION_HEADER_SIZE);
+    Entity::operator delete(pointer, header->size);
+}
+
+MemoryArena *Entity::getAllocationArena() const {
+    return ((const AllocationHeader*) ((const char*) this - ALLOCATION_HEADER_SIZE))->arena;
+}
 
 Entity::Entity(void) {
     this->childEntities = new std::vector<Entity*>();
-    physicalBody = new PhysicalBody(this, 0, Vector3());
-    modelMatrix = new Matrix4();
-    modelMatrix->toIdentity();
+    physicalBody = nullptr;
+    transforms = new TransformStore();
+    transformIndex = transforms->add(this, TransformStore::NO_PARENT, Vector3(), Vector3(), Vector3(1, 1, 1));
+    ownsTransforms = true;
+    childrenInheritTransform = true;
     shader = nullptr;
     model = nullptr;
     parent = nullptr;
-    position = Vector3();
-    rotation = Vector3();
-    scale = Vector3(1, 1, 1);
     numChildEntities = 0;
-    posChanged = true;
-    rotChanged = true;
-    scaleChanged = true;
     distanceToCamera = 0;
     renderRadius = 1.0f;
     translucent = false;
+    independentUpdate = false;
 }
 
 Entity::Entity(const Entity &copy) {
-    this->modelMatrix = new Matrix4(*(copy.modelMatrix));
+    this->transforms = new TransformStore();
+    this->transformIndex = transforms->add(this, TransformStore::NO_PARENT, copy.getPosition(), copy.getRotation(),
+        copy.getScale());
+    this->ownsTransforms = true;
+    this->childrenInheritTransform = copy.childrenInheritTransform;
     this->shader = new Shader(*(copy.shader));
     this->parent = new Entity(*(copy.parent));
     this->childEntities = new std::vector<Entity*>(*(copy.childEntities));
     this->model = new Model(*(copy.model));
     this->shader = copy.shader;
-    this->physicalBody = new PhysicalBody(*(copy.physicalBody));
-    this->position = Vector3(copy.position);
-    this->rotation = Vector3(copy.rotation);
-    this->scale = Vector3(copy.scale);
+    this->physicalBody = nullptr;
+    if (copy.physicalBody != nullptr) {
+        setPhysicalBody(*(copy.physicalBody));
+    }
     this->numChildEntities = copy.numChildEntities;
-    this->posChanged = copy.posChanged;
-    this->rotChanged = copy.rotChanged;
-    this->scaleChanged = copy.scaleChanged;
     this->distanceToCamera = copy.distanceToCamera;
     this->renderRadius = copy.renderRadius;
     this->translucent = copy.translucent;
+    this->independentUpdate = copy.independentUpdate;
 }
 
 Entity::Entity(Vector3 position, Vector3 rotation, Vector3 scale) {
     this->childEntities = new std::vector<Entity*>();
-    this->position = Vector3(position);
-    this->rotation = Vector3(rotation);
-    this->scale = Vector3(scale);
-    modelMatrix = new Matrix4();
-    modelMatrix->toIdentity();
+    transforms = new TransformStore();
+    transformIndex = transforms->add(this, TransformStore::NO_PARENT, position, rotation, scale);
+    ownsTransforms = true;
+    childrenInheritTransform = true;
+    physicalBody = nullptr;
     model = nullptr;
     shader = nullptr;
     parent = nullptr;
     numChildEntities = 0;
-    posChanged = true;
-    rotChanged = true;
-    scaleChanged = true;
     distanceToCamera = 0;
     renderRadius = 1.0f;
     translucent = false;
+    independentUpdate = false;
 }
 
 Entity::~Entity(void) {
     if (parent != nullptr) {
         //parent->removeChild(this);
     }
-    if (modelMatrix != nullptr) {
-        delete modelMatrix;
-        modelMatrix = nullptr;
-    }
     if (childEntities != nullptr) {
         auto itEnd = childEntities->end();
         for (auto it = childEntities->begin(); it != itEnd; ++it) {
@@ -76,15 +121,24 @@ Entity::~Entity(void) {
         delete childEntities;
         childEntities = nullptr;
     }
-    shader = nullptr;
-    if (physicalBody != nullptr) {
-        delete physicalBody;
-        physicalBody = nullptr;
+    // The children were deleted first, as they may still be using the store
+    if (transforms != nullptr) {
+        if (ownsTransforms) {
+            delete transforms;
+        } else {
+            transforms->remove(transformIndex);
+        }
+        transforms = nullptr;
     }
+    shader = nullptr;
+    removePhysicalBody();
 }
 
 Entity &Entity::operator=(const Entity &other) {
-    *(this->modelMatrix) = *(other.modelMatrix);
+    setPosition(other.getPosition());
+    setRotation(other.getRotation());
+    setScale(other.getScale());
+    this->childrenInheritTransform = other.childrenInheritTransform;
     *(this->model) = *(other.model);
     this->shader = other.shader;
     if (parent != NULL) {
@@ -99,17 +153,16 @@ Entity &Entity::operator=(const Entity &other) {
         }
     }
     *(this->childEntities) = *(other.childEntities);
-    *(this->physicalBody) = *(other.physicalBody);
-    this->position = Vector3(other.position);
-    this->rotation = Vector3(other.rotation);
-    this->scale = Vector3(other.scale);
+    if (other.physicalBody != nullptr) {
+        setPhysicalBody(*(other.physicalBody));
+    } else {
+        removePhysicalBody();
+    }
     this->numChildEntities = other.numChildEntities;
-    this->posChanged = other.posChanged;
-    this->rotChanged = other.rotChanged;
-    this->scaleChanged = other.scaleChanged;
     this->distanceToCamera = other.distanceToCamera;
     this->renderRadius = other.renderRadius;
     this->translucent = other.translucent;
+    this->independentUpdate = other.independentUpdate;
     return *this;
 }
 
@@ -172,43 +225,13 @@ void Entity::onKeyUp(SDL_Keysym key) {
 }
 
 
-void Entity::calculateModelMatrix(Vector3 addPos, Vector3 addRot, Vector3 addSiz, bool pDiff, bool rDiff, bool sDiff) {
-    if (posChanged) {
-        // Position changed here or in the parent, update it in the matrix.
-        modelMatrix->setPositionVector(position + addPos);
-        pDiff = true;
-        posChanged = false;
-    }
-    if (rotChanged || scaleChanged) {
-        // Rotation or Scale changed, the whole matrix needs to be recalculated.
-        Vector3 rot = (rotation + addRot);
-        Matrix4 rotationMatrix =
-            Matrix4::Rotation(rot.x, Vector3(1, 0, 0)) *
-            Matrix4::Rotation(rot.y, Vector3(0, 1, 0)) *
-            Matrix4::Rotation(rot.z, Vector3(0, 0, 1));
-        *modelMatrix = Matrix4::Translation(position + addPos) * rotationMatrix * Matrix4::Scale(scale * addSiz);
-        rDiff = true;
-        sDiff = true;
-        rotChanged = false;
-        scaleChanged = false;
-    }
-    // Do the same for all the children
-    if (numChildEntities > 0) {
-        for(auto it = childEntities->begin(); it != childEntities->end(); it++) {
-            (*it)->calculateModelMatrix(position + addPos, rotation + addRot, scale * addSiz, pDiff, rDiff, sDiff);
-        }
-    }
-}
-
 void Entity::update(float millisElapsed) {
-    // Only update the matrix if this entity isn't a child, because that function also update all children's matrices.
-    if (parent == nullptr) {
-        calculateModelMatrix(Vector3(), Vector3(), Vector3(1, 1, 1), false, false, false);
-    }
+    // Only the entity that owns the transforms updates them, which also updates all children's matrices.
+    updateTransforms();
     // Update the distanceToCamera if that's changed
     if (Naquadah::getInstance()->getCurrentScene()->getCamera()->hasChanged()) {
         Camera *camera = Naquadah::getInstance()->getCurrentScene()->getCamera();
-        Vector3 dir = position - camera->getPosition();
+        Vector3 dir = getPosition() - camera->getPosition();
         distanceToCamera = Vector3::dot(dir, dir);
     }
     if (numChildEntities > 0) {
@@ -218,15 +241,14 @@ void Entity::update(float millisElapsed) {
     }
 }
 
-void Entity::draw(float millisElapsed) {
+void Entity::queueDraw(RenderQueue *queue, unsigned char planeMask) {
     if (model != nullptr) {
-        Naquadah::getInstance()->getCurrentScene()->useShader(shader);
-        Naquadah::getRenderer()->updateShaderMatrix("modelMatrix", modelMatrix);
-        model->draw();
+        const Matrix4 &modelMatrix = getModelMatrix();
+        queue->addModel(shader, model, nullptr, modelMatrix, modelMatrix.getPositionVector(), translucent);
     }
     if (numChildEntities > 0) {
         for (auto it = childEntities->begin(); it != childEntities->end(); it++) {
-            (*it)->draw(millisElapsed);
+            (*it)->queueDraw(queue, planeMask);
         }
     }
 }
@@ -235,15 +257,44 @@ void Entity::addChild(Entity *child) {
     if (child != nullptr) {
         childEntities->push_back(child);
         numChildEntities++;
+        // The child's transforms go after this one in its store, so they're updated by the same pass
+        TransformStore *childStore = child->ownsTransforms ? child->transforms : nullptr;
+        child->moveTransforms(transforms, childrenInheritTransform ? transformIndex : TransformStore::NO_PARENT);
+        child->ownsTransforms = false;
+        delete childStore;
         child->parent = this;
     }
 }
 
+void Entity::moveTransforms(TransformStore *store, int parentIndex) {
+    TransformStore *oldStore = transforms;
+    int index = store->add(this, parentIndex, getPosition(), getRotation(), getScale());
+    oldStore->remove(transformIndex);
+    transforms = store;
+    transformIndex = index;
+    if (numChildEntities > 0) {
+        int childParent = childrenInheritTransform ? index : TransformStore::NO_PARENT;
+        for (auto it = childEntities->begin(); it != childEntities->end(); it++) {
+            // Children shared with other Entities may have been moved to another store already
+            if ((*it)->parent == this && (*it)->transforms == oldStore) {
+                (*it)->moveTransforms(store, childParent);
+            }
+        }
+    }
+}
+
 void Entity::removeChild(Entity *child) {
     if (child != nullptr) {
-        childEntities->erase(std::remove(childEntities->begin(), childEntities->end(), child), childEntities->end());
-        numChildEntities--;
-        child->parent = nullptr;
+        auto itEnd = childEntities->end();
+        auto itNewEnd = std::remove(childEntities->begin(), itEnd, child);
+        // The child may have already been removed, so only count the ones actually erased
+        numChildEntities -= (int) (itEnd - itNewEnd);
+        childEntities->erase(itNewEnd, itEnd);
+        if (child->parent == this) {
+            child->moveTransforms(new TransformStore(), TransformStore::NO_PARENT);
+            child->ownsTransforms = true;
+            child->parent = nullptr;
+        }
     }
 }
 
@@ -266,6 +317,27 @@ std::vector<Entity*> Entity::getAllChildren(Entity *entity) {
     return children;
 }
 
+PhysicalBody *Entity::addPhysicalBody() {
+    if (physicalBody == nullptr) {
+        physicalBody = physicalBodies.create();
+        physicalBody->setEntity(this);
+    }
+    return physicalBody;
+}
+
+void Entity::setPhysicalBody(PhysicalBody &body) {
+    addPhysicalBody();
+    *physicalBody = body;
+    physicalBody->setEntity(this);
+}
+
+void Entity::removePhysicalBody() {
+    if (physicalBody != nullptr) {
+        physicalBodies.destroy(physicalBody);
+        physicalBody = nullptr;
+    }
+}
+
 void Entity::setModel(Model *model) {
     if (this->model != nullptr && this->model != model) {
         ResourcesManager::releaseResource(this->model->getName());
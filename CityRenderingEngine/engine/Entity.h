@@ -8,10 +8,22 @@
  * be a game object and have a 3D representation onscreen, an Entity can also be used to serve as a node for a more
  * complex hierarchy system, serving as base to group other entities together, putting them as children.
  *
+ * The PhysicalBody is an optional component: an Entity is created without one, and only gets it from a ComponentPool
+ * when addPhysicalBody() or setPhysicalBody() is called, so the Entities that never move, like the whole city, don't
+ * carry any physics or collision data.
+ *
  * An entity may have one or more children entities, that are organized in a hierarchy, having all children relative to
  * their parent. This way, if the parent moves, rotates or change scale, its children will also do so, proportionally.
  * An entity should update the logic of itself and of its children, but it should only render itself, because the Scene
  * will already call the render methods separatedly of all the entities.
+ *
+ * The transform of an Entity isn't stored in it, but in the TransformStore of the top of its hierarchy: the Entity only
+ * has the store and the index of its transform there, and the getters and setters of the position, rotation and scale
+ * read and write the store. When a child is added, its transform, and the ones of its own children, are moved to the
+ * parent's store, and when it's removed they're moved to a new store, owned by the child.
+ *
+ * The Scene updates the Entities marked as independent in parallel, with the JobSystem. Their update() must not touch
+ * anything outside their own hierarchy, besides reading the Scene and its Camera.
  */
 
 #pragma once
@@ -20,6 +32,9 @@
 #include "math/Vector3.h"
 #include "math/Matrix4.h"
 #include "ResourceNames.h"
+#include "TransformStore.h"
+#include "MemoryArena.h"
+#include "ComponentPool.h"
 #include "rendering/Model.h"
 #include "rendering/Shader.h"
 #include "Naquadah.h"
@@ -29,6 +44,7 @@
 class Naquadah;
 class Model;
 class Shader;
+class RenderQueue;
 
 class Entity {
 public:
@@ -38,19 +54,15 @@ public:
     Entity(Vector3 position, Vector3 rotation, Vector3 scale);
     virtual ~Entity(void);
 
+    virtual void update(float millisElapsed);
+
     /*
-     * Here we get the entity's attributes and calculate the final model matrix. If the entity has children, it will
-     * update its child's matrices as well. The three parameter Vector3 are the offset of the Transform, and should be
-     * set to make children position, rotate and scale relative to their parents and grandparents. If the Entity don't
-     * have any parent, these vectors should be passed at their neutral values. The bool parameters indicate if their
-     * correspondent offset Vector3 has changed since the last frame. If they changed, the modelMatrix will have to be
-     * updated even if this Entity's Transform didn't change.
+     * Adds the draws of this Entity and its children to queue, after it passed the Frustum test of the Scene. Nothing
+     * is drawn here, the Scene submits the whole queue once all Entities were added (see RenderQueue). planeMask has
+     * the Frustum planes that still intersect this Entity, and Entities with their own culling hierarchy, like Chunk,
+     * should pass it down to their tests (see Frustum::testBox()).
      */
-    virtual void calculateModelMatrix(Vector3 addPos, Vector3 addRot, Vector3 addSiz,
-        bool pDiff, bool rDiff, bool sDiff);
-
-    virtual void update(float millisElapsed);
-    virtual void draw(float millisElapsed);
+    virtual void queueDraw(RenderQueue *queue, unsigned char planeMask);
 
     /* Mouse events */
     virtual void onMouseMoved(Vector2 &position, Vector2 &amount); // Will fire every time the mouse moves
@@ -70,29 +82,43 @@ public:
     Model *getModel() { return model; }
     Shader *getShader() { return shader; }
     Entity *getParent() { return parent; }
-    Matrix4 getModelMatrix() { return *modelMatrix; }
-    void setPhysicalBody(PhysicalBody &body);
-    PhysicalBody *getPhysicalBody() { return physicalBody; }
+    /* The world matrix of the last update of the transforms. It's only valid until the store is compacted. */
+    const Matrix4 &getModelMatrix() { return transforms->getWorldMatrix(transformIndex); }
 
-    void setPosition(const Vector3 &position) { this->position = position; posChanged = true; }
-    void setRotation(const Vector3 &rotation) { this->rotation = rotation; rotChanged = true; }
-    void setScale(const Vector3 &scale) { this->scale = scale; scaleChanged = true; }
-    inline Vector3 getPosition() const { return position; }
-    inline Vector3 getRotation() const { return rotation; }
-    inline Vector3 getScale() const { return scale; }
+    /* Returns the PhysicalBody of this entity, or null if it doesn't have one. */
+    PhysicalBody *getPhysicalBody() { return physicalBody; }
+    /* Gives this entity a PhysicalBody, if it doesn't have one yet, and returns it. */
+    PhysicalBody *addPhysicalBody();
+    /* Copies body to the PhysicalBody of this entity, which is added if it doesn't have one. */
+    void setPhysicalBody(PhysicalBody &body);
+    /* Destroys the PhysicalBody of this entity, if it has one. */
+    void removePhysicalBody();
+    /* Returns the pool with the PhysicalBody of every Entity. */
+    static const ComponentPool<PhysicalBody> &getPhysicalBodyPool() { return physicalBodies; }
+
+    void setPosition(const Vector3 &position) { transforms->setPosition(transformIndex, position); }
+    void setRotation(const Vector3 &rotation) { transforms->setRotation(transformIndex, rotation); }
+    void setScale(const Vector3 &scale) { transforms->setScale(transformIndex, scale); }
+    inline Vector3 getPosition() const { return transforms->getPosition(transformIndex); }
+    inline Vector3 getRotation() const { return transforms->getRotation(transformIndex); }
+    inline Vector3 getScale() const { return transforms->getScale(transformIndex); }
 
     void setIsTranslucent(bool translucent) { this->translucent = translucent; }
     bool isTranslucent() { return translucent; }
     void setRenderRadius(float renderRadius) { this->renderRadius = renderRadius; }
     float getRenderRadius() { return renderRadius; }
+    bool isUpdateIndependent() const { return independentUpdate; }
+
+    /* Returns true if this Entity owns its store, and it has enough holes to be compacted. */
+    bool needsTransformCompaction() const { return ownsTransforms && transforms->needsCompaction(); }
+    /* Compacts the store of this Entity, if it owns it. No other thread may be reading its matrices. */
+    void compactTransforms() {
+        if (ownsTransforms) transforms->compact();
+    }
 
     /* Calculates and returns the world position of this entity. */
     virtual Vector3 getWorldPosition() {
-        if (parent != nullptr) {
-            return this->position + parent->getWorldPosition();
-        } else {
-            return this->position;
-        }
+        return transforms->getWorldPosition(transformIndex);
     }
 
     /*
@@ -104,7 +130,10 @@ public:
     /* Adds a new child to this entity */
     void addChild(Entity *child);
 
-    /* Removes a child from this entity's child list */
+    /*
+     * Removes a child from this entity's child list. If this entity is its parent, the child becomes an orphan, with
+     * its transforms moved to a store of its own.
+     */
     void removeChild(Entity *child);
 
     /* Makes this entity an orphan, removing it from its parent's child list, if this entity is a child. */
@@ -112,6 +141,19 @@ public:
 
     Entity &operator=(const Entity &other);
 
+    /*
+     * Entities are allocated with a small header that remembers the MemoryArena they came from, and their size, so any
+     * Entity can be deleted with delete: the ones on the heap are freed, and the ones in an arena are only counted,
+     * and released with the arena. new (arena) Entity() allocates it in arena, or on the heap if arena is null.
+     */
+    static void *operator new(size_t size);
+    static void *operator new(size_t size, MemoryArena *arena);
+    static void operator delete(void *pointer, size_t size);
+    static void operator delete(void *pointer, MemoryArena *arena);
+
+    /* Returns the MemoryArena this Entity was allocated in, or null if it's on the heap. It must have been new'ed. */
+    MemoryArena *getAllocationArena() const;
+
     static bool compareByCameraDistance(Entity *a, Entity *b) {
         if (a->translucent) {
             return (a->distanceToCamera < b->distanceToCamera);
@@ -122,15 +164,20 @@ public:
 
 protected:
 
-    /* The Transform vectors of the Entity. */
-    Vector3 position;
-    Vector3 rotation;
-    Vector3 scale;
+    friend class TransformStore;
 
-    /* The Transform variables, for the values of the last frame. */
-    bool posChanged;
-    bool rotChanged;
-    bool scaleChanged;
+    /* The store with the transform of this Entity, and the index of the transform in it. */
+    TransformStore *transforms;
+    int transformIndex;
+
+    /* Set if this Entity created the store, and has to update and delete it. Only Entities without parent own one. */
+    bool ownsTransforms;
+
+    /*
+     * Set if the children's transforms are relative to this Entity's. Defaults to true. Entities that only group
+     * others that already have world transforms, like Chunk, clear it.
+     */
+    bool childrenInheritTransform;
 
     /* This is the distance to the camera, if a straight line could be drawn directly between the camera and this. */
     float distanceToCamera;
@@ -145,8 +192,11 @@ protected:
     /* Indicates if this Entity has a transparent or translucent model. Defaults to false. */
     bool translucent;
 
-    /* The final transform matrix applied to this Entity. This is calculated and should not be modified directly. */
-    Matrix4 *modelMatrix;
+    /*
+     * Set if the update() of this Entity only reads and writes itself and its own children, so the Scene can update it
+     * on a worker thread, at the same time as other independent Entities. Defaults to false.
+     */
+    bool independentUpdate;
 
     /*
      * List of child entities for this entity. The attributes of child entities, like position, size and rotation will
@@ -171,6 +221,20 @@ protected:
     /* The entity's shader. This is required to render the entity on the screen. */
     Shader *shader;
 
-    /* The physical body of this entity */
+    /* The physical body of this entity, in physicalBodies. Null until one is added. */
     PhysicalBody *physicalBody;
+
+    /* The PhysicalBody components of all the Entities. */
+    static ComponentPool<PhysicalBody> physicalBodies;
+
+    /* Updates the world matrices of the store, if this Entity owns it, which includes all of its children. */
+    void updateTransforms() {
+        if (ownsTransforms) transforms->update();
+    }
+
+    /*
+     * Moves the transform of this Entity, and the ones of its children, to the end of store, with parentIndex as its
+     * parent. Their old transforms are removed from the store they were in, which isn't deleted here.
+     */
+    void moveTransforms(TransformStore *store, int parentIndex);
 };
\ No newline at end of file
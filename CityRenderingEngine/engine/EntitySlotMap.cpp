@@ -0,0 +1,62 @@
+#include "EntitySlotMap.h"
+
+/* The generations go from 1 to this, so a handle is never INVALID_ENTITY_HANDLE. */
+static const unsigned int MAX_GENERATION = (1u << (32 - EntitySlotMap::INDEX_BITS)) - 1;
+
+EntityHandle EntitySlotMap::add(Entity *entity) {
+    unsigned int index;
+    if (!freeSlots.empty()) {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        if (slots.size() >= MAX_ENTITIES) return INVALID_ENTITY_HANDLE;
+        index = (unsigned int) slots.size();
+        Slot slot;
+        slot.generation = 1;
+        slots.push_back(slot);
+    }
+    slots[index].denseIndex = (unsigned int) entities.size();
+    entities.push_back(entity);
+    entitySlots.push_back(index);
+    return (slots[index].generation << INDEX_BITS) | index;
+}
+
+bool EntitySlotMap::remove(EntityHandle handle) {
+    if (!contains(handle)) return false;
+    unsigned int index = handle & INDEX_MASK;
+    unsigned int denseIndex = slots[index].denseIndex;
+    // Move the last Entity into the hole, and point its slot to the new position
+    unsigned int lastIndex = (unsigned int) entities.size() - 1;
+    if (denseIndex != lastIndex) {
+        entities[denseIndex] = entities[lastIndex];
+        entitySlots[denseIndex] = entitySlots[lastIndex];
+        slots[entitySlots[denseIndex]].denseIndex = denseIndex;
+    }
+    entities.pop_back();
+    entitySlots.pop_back();
+    // The old handles of this slot are invalid from now on
+    slots[index].generation = slots[index].generation >= MAX_GENERATION ? 1 : slots[index].generation + 1;
+    freeSlots.push_back(index);
+#ifdef _DEBUG
+    for (auto it = names.begin(); it != names.end(); it++) {
+        if (it->second == handle) {
+            names.erase(it);
+            break;
+        }
+    }
+#endif
+    return true;
+}
+
+void EntitySlotMap::clear() {
+    for (auto it = entitySlots.begin(); it != entitySlots.end(); it++) {
+        Slot &slot = slots[*it];
+        slot.generation = slot.generation >= MAX_GENERATION ? 1 : slot.generation + 1;
+        freeSlots.push_back(*it);
+    }
+    entities.clear();
+    entitySlots.clear();
+#ifdef _DEBUG
+    names.clear();
+#endif
+}
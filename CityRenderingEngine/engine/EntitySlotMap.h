@@ -0,0 +1,102 @@
+/*
+ * Description: The root Entities of a Scene, kept in a slot map. Adding an Entity returns an EntityHandle, used to
+ * look it up or remove it later in constant time, without any string being built or compared. The Entities are kept
+ * in a dense array, so iterating through them in the update and render loops is a plain loop over pointers.
+ *
+ * A handle is 32 bits: the lower INDEX_BITS are the index of a slot, which holds the position of the Entity in the
+ * dense array, and the upper bits are the generation of the slot. The generation is incremented every time an Entity
+ * is removed, so the old handles of a slot stop working once the slot is reused, instead of pointing to another
+ * Entity. Removing an Entity moves the last one into its place in the dense array, so the order of the Entities
+ * changes when one is removed, but it's always the same for the same sequence of adds and removes.
+ *
+ * In debug builds, the Entities can also be given a name, to be found by it when debugging. Release builds don't keep
+ * the names at all.
+ */
+
+#pragma once
+
+#include <vector>
+#ifdef _DEBUG
+#include <map>
+#include <string>
+#endif
+
+class Entity;
+
+/* A handle to an Entity added to an EntitySlotMap. */
+typedef unsigned int EntityHandle;
+
+/* The handle that never refers to any Entity. */
+const EntityHandle INVALID_ENTITY_HANDLE = 0;
+
+class EntitySlotMap {
+public:
+
+    /* The number of bits of a handle used for the index of the slot. The rest are its generation. */
+    static const int INDEX_BITS = 20;
+    static const unsigned int INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static const unsigned int MAX_ENTITIES = INDEX_MASK;
+
+    EntitySlotMap(void) {}
+    ~EntitySlotMap(void) {}
+
+    /* Adds an Entity and returns its handle. Returns INVALID_ENTITY_HANDLE if the map already has MAX_ENTITIES. */
+    EntityHandle add(Entity *entity);
+
+    /* Removes the Entity of handle. Returns false if the handle doesn't refer to an Entity in this map. */
+    bool remove(EntityHandle handle);
+
+    /* Returns the Entity of handle, or null if the handle doesn't refer to an Entity in this map. */
+    Entity *get(EntityHandle handle) const {
+        unsigned int index = handle & INDEX_MASK;
+        if (index >= slots.size() || slots[index].generation != (handle >> INDEX_BITS)) return nullptr;
+        // A free slot keeps its last position, which may now belong to another slot
+        unsigned int denseIndex = slots[index].denseIndex;
+        if (denseIndex >= entities.size() || entitySlots[denseIndex] != index) return nullptr;
+        return entities[denseIndex];
+    }
+
+    /* Returns true if handle refers to an Entity in this map. */
+    bool contains(EntityHandle handle) const { return get(handle) != nullptr; }
+
+    /* Removes all the Entities. The handles given so far are all invalidated. */
+    void clear();
+
+    /* The Entities in the map, with no gaps between them. */
+    std::vector<Entity*>::const_iterator begin() const { return entities.begin(); }
+    std::vector<Entity*>::const_iterator end() const { return entities.end(); }
+    int size() const { return (int) entities.size(); }
+    Entity *operator[](int i) const { return entities[i]; }
+
+#ifdef _DEBUG
+    /* Gives a name to the Entity of handle, so it can be found with find(). Only for debugging. */
+    void setName(EntityHandle handle, const std::string &name) { names[name] = handle; }
+
+    /* Returns the Entity given the name provided, or null if there's none. Only for debugging. */
+    Entity *find(const std::string &name) const {
+        auto it = names.find(name);
+        return it != names.end() ? get(it->second) : nullptr;
+    }
+#endif
+
+protected:
+
+    /* Where the Entity of a slot is in the dense array, and the generation of the handles that can use the slot. */
+    struct Slot {
+        unsigned int denseIndex;
+        unsigned int generation;
+    };
+
+    /* The Entities, and the slot of each of them, in the same order. */
+    std::vector<Entity*> entities;
+    std::vector<unsigned int> entitySlots;
+
+    /* The slots, and the indexes of the ones without an Entity, reused before any new slot is created. */
+    std::vector<Slot> slots;
+    std::vector<unsigned int> freeSlots;
+
+#ifdef _DEBUG
+    /* The names given to the Entities, only kept for debugging. */
+    std::map<std::string, EntityHandle> names;
+#endif
+};
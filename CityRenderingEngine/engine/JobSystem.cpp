@@ -0,0 +1,158 @@
+#include "JobSystem.h"
+
+JobSystem *JobSystem::instance = nullptr;
+
+/* The function run by each worker thread of the JobSystem. */
+int jobWorkerLoop(void *data) {
+    ((JobSystem*) data)->runWorker();
+    return 0;
+}
+
+JobSystem::JobSystem(void) {
+    executing = true;
+    int defaultWorkers = max(SDL_GetCPUCount() - 1, 0);
+    int numWorkers = ConfigurationManager::getInstance()->readInt("jobWorkers", defaultWorkers);
+    numWorkers = clamp(numWorkers, 0, MAX_WORKERS);
+    // The queues must all exist before the first worker starts
+    queues = new std::vector<JobQueue>(numWorkers + 1);
+    SDL_AtomicSet(&numActiveWorkers, numWorkers);
+    SDL_AtomicSet(&numWaitingJobs, 0);
+    SDL_AtomicSet(&nextWorkerIndex, 0);
+    wakeMutex = SDL_CreateMutex();
+    wakeCondition = SDL_CreateCond();
+    threads = new std::vector<SDL_Thread*>();
+    for (int i = 0; i < numWorkers; i++) {
+        std::stringstream threadName;
+        threadName << "JobWorker" << i;
+        threads->push_back(SDL_CreateThread(&jobWorkerLoop, threadName.str().c_str(), (void*) this));
+    }
+}
+
+JobSystem::~JobSystem(void) {
+    if (threads != nullptr) {
+        delete threads;
+        threads = nullptr;
+    }
+    if (queues != nullptr) {
+        delete queues;
+        queues = nullptr;
+    }
+    if (wakeCondition != nullptr) {
+        SDL_DestroyCond(wakeCondition);
+        wakeCondition = nullptr;
+    }
+    if (wakeMutex != nullptr) {
+        SDL_DestroyMutex(wakeMutex);
+        wakeMutex = nullptr;
+    }
+}
+
+void JobSystem::terminate() {
+    if (instance != nullptr) {
+        SDL_LockMutex(instance->wakeMutex);
+        instance->executing = false;
+        SDL_CondBroadcast(instance->wakeCondition);
+        SDL_UnlockMutex(instance->wakeMutex);
+        int result;
+        for (auto it = instance->threads->begin(); it != instance->threads->end(); it++) {
+            SDL_WaitThread(*it, &result);
+        }
+        delete instance;
+        instance = nullptr;
+    }
+}
+
+void JobSystem::parallelFor(int count, int grainSize, JobFunction function, void *data) {
+    if (count <= 0) return;
+    grainSize = max(grainSize, 1);
+    int numActive = SDL_AtomicGet(&numActiveWorkers);
+    if (numActive == 0 || count <= grainSize) {
+        // Nothing to split, or no one else to run it
+        function(0, count, data);
+        return;
+    }
+    SDL_atomic_t remaining;
+    int numJobs = (count + grainSize - 1) / grainSize;
+    SDL_AtomicSet(&remaining, numJobs);
+    // Spread the jobs over the active workers and the caller queue, the idle threads steal the rest
+    int callerQueue = getCallerQueue();
+    for (int i = 0; i < numJobs; i++) {
+        Job job;
+        job.function = function;
+        job.data = data;
+        job.begin = i * grainSize;
+        job.end = min(job.begin + grainSize, count);
+        job.remaining = &remaining;
+        int queueIndex = i % (numActive + 1);
+        JobQueue &queue = (*queues)[queueIndex == numActive ? callerQueue : queueIndex];
+        SDL_AtomicLock(&queue.lock);
+        queue.jobs.push_back(job);
+        SDL_AtomicUnlock(&queue.lock);
+    }
+    // Counted under the mutex, so a worker can't miss the wake up between checking the count and waiting
+    SDL_LockMutex(wakeMutex);
+    SDL_AtomicAdd(&numWaitingJobs, numJobs);
+    SDL_CondBroadcast(wakeCondition);
+    SDL_UnlockMutex(wakeMutex);
+
+    while (SDL_AtomicGet(&remaining) > 0) {
+        Job job;
+        if (takeJob(callerQueue, job)) {
+            runJob(job);
+        } else {
+            // The last jobs are still running on the workers
+            SDL_Delay(0);
+        }
+    }
+}
+
+void JobSystem::runWorker() {
+    int workerIndex = SDL_AtomicAdd(&nextWorkerIndex, 1);
+    while (executing) {
+        if (workerIndex < SDL_AtomicGet(&numActiveWorkers)) {
+            Job job;
+            if (takeJob(workerIndex, job)) {
+                runJob(job);
+                continue;
+            }
+        }
+        SDL_LockMutex(wakeMutex);
+        while (executing &&
+            (SDL_AtomicGet(&numWaitingJobs) <= 0 || workerIndex >= SDL_AtomicGet(&numActiveWorkers))) {
+            SDL_CondWait(wakeCondition, wakeMutex);
+        }
+        SDL_UnlockMutex(wakeMutex);
+    }
+}
+
+bool JobSystem::takeJob(int queueIndex, Job &job) {
+    if (SDL_AtomicGet(&numWaitingJobs) <= 0) return false;
+    // The own queue is taken from the back, as its last jobs are the most likely to still be in the cache
+    JobQueue &ownQueue = (*queues)[queueIndex];
+    SDL_AtomicLock(&ownQueue.lock);
+    bool found = !ownQueue.jobs.empty();
+    if (found) {
+        job = ownQueue.jobs.back();
+        ownQueue.jobs.pop_back();
+    }
+    SDL_AtomicUnlock(&ownQueue.lock);
+    // The other queues are stolen from the front, where the owner isn't working
+    int numQueues = (int) queues->size();
+    for (int i = 1; !found && i < numQueues; i++) {
+        JobQueue &queue = (*queues)[(queueIndex + i) % numQueues];
+        SDL_AtomicLock(&queue.lock);
+        found = !queue.jobs.empty();
+        if (found) {
+            job = queue.jobs.front();
+            queue.jobs.pop_front();
+        }
+        SDL_AtomicUnlock(&queue.lock);
+    }
+    if (found) SDL_AtomicAdd(&numWaitingJobs, -1);
+    return found;
+}
+
+void JobSystem::runJob(const Job &job) {
+    job.function(job.begin, job.end, job.data);
+    SDL_AtomicAdd(job.remaining, -1);
+}
@@ -0,0 +1,134 @@
+/*
+ * Description: A Singleton pool of worker threads that runs short jobs in parallel, used to split the work of a single
+ * frame, like updating every Chunk of the Scene, across all cores. The work is submitted with parallelFor, which
+ * splits a range of indexes into jobs of grainSize indexes and only returns once all of them are done. The calling
+ * thread runs jobs too while it waits, so nothing is lost by calling it from the logic thread.
+ *
+ * Each worker has a queue of its own, and the threads calling parallelFor share one more. The jobs are spread over the
+ * queues, and each thread runs the jobs of its own queue from the back, stealing from the front of the other queues
+ * when its own is empty. The workers sleep on a condition while there's no job at all.
+ *
+ * The jobs of a parallelFor must be independent from each other: the split of the range doesn't depend on the number
+ * of threads, but the order in which the jobs run does, so the result is only deterministic if each job only writes to
+ * the data of its own indexes.
+ *
+ * The number of workers is read from the configuration "jobWorkers", and defaults to the number of CPU cores minus one.
+ * Setting it to 0 runs every job on the calling thread. The number of workers used can also be lowered at runtime, to
+ * compare the speed of the same work on 1 to N threads.
+ */
+
+#pragma once
+
+#include <SDL.h>
+#include <deque>
+#include <vector>
+#include "input/ConfigurationManager.h"
+#include "math/Common.h"
+
+/* The function run by a job, on the indexes from begin (inclusive) to end (exclusive). */
+typedef void (*JobFunction)(int begin, int end, void *data);
+
+/* A range of indexes of a parallelFor, and the counter of the jobs of that parallelFor still to finish. */
+struct Job {
+    JobFunction function;
+    void *data;
+    int begin;
+    int end;
+    SDL_atomic_t *remaining;
+};
+
+/* The jobs waiting to run on a thread, protected by a spin lock, as it's only held to push or pop a single job. */
+struct JobQueue {
+    std::deque<Job> jobs;
+    SDL_SpinLock lock;
+
+    JobQueue(void) : lock(0) {}
+};
+
+class JobSystem {
+public:
+
+    /* The maximum number of worker threads. */
+    static const int MAX_WORKERS = 63;
+
+    ~JobSystem(void);
+
+    /* Returns the Singleton instance of JobSystem. If the instance doesn't exist yet, it will be created. */
+    static JobSystem *getInstance() {
+        if (instance == nullptr) {
+            instance = new JobSystem();
+        }
+        return instance;
+    }
+
+    /* Stops all worker threads and deletes the instance of the JobSystem. This should be called when the game exits. */
+    static void terminate();
+
+    /*
+     * Runs function over the indexes from 0 to count - 1, split into jobs of grainSize indexes, and waits for all of
+     * them to finish. The calling thread runs jobs while it waits. It can be called from any thread, even from a job.
+     */
+    void parallelFor(int count, int grainSize, JobFunction function, void *data);
+
+    /* Returns true if this JobSystem is still executing, or false otherwise. */
+    bool isExecuting() { return executing; }
+
+    /* Returns the number of worker threads. */
+    int getNumWorkers() { return (int) queues->size() - 1; }
+
+    /* Returns the number of threads that run the jobs of a parallelFor: the workers in use, plus the calling thread. */
+    int getNumThreads() { return SDL_AtomicGet(&numActiveWorkers) + 1; }
+
+    /* Sets the number of threads that run the jobs of a parallelFor, from 1 (the calling thread alone) to all workers. */
+    void setNumThreads(int numThreads) {
+        SDL_AtomicSet(&numActiveWorkers, clamp(numThreads - 1, 0, getNumWorkers()));
+    }
+
+    /*
+     * Runs the jobs of a worker until the JobSystem is terminated. The workers take their index, and so their queue, in
+     * the order they call this.
+     */
+    void runWorker();
+
+protected:
+
+    JobSystem(void);
+
+    /*
+     * Takes the next job of the queue at queueIndex, or steals one from another queue if it's empty. Returns false if
+     * there's no job waiting on any queue.
+     */
+    bool takeJob(int queueIndex, Job &job);
+
+    /* Runs a job and counts it as finished. */
+    void runJob(const Job &job);
+
+    /* Returns the index of the queue for the jobs of the calling thread, if it's not a worker. */
+    int getCallerQueue() { return getNumWorkers(); }
+
+    /* A bool indicating that the JobSystem is not yet terminated. Defaults to true. */
+    bool executing;
+
+    /* The worker threads. */
+    std::vector<SDL_Thread*> *threads;
+
+    /* The queue of each worker, followed by the queue shared by the threads that call parallelFor. */
+    std::vector<JobQueue> *queues;
+
+    /* The number of workers that take jobs, the others sleep. Defaults to all of them. */
+    SDL_atomic_t numActiveWorkers;
+
+    /* The number of jobs waiting on all queues. */
+    SDL_atomic_t numWaitingJobs;
+
+    /* The index of the next worker to start, so each worker knows which queue is its own. */
+    SDL_atomic_t nextWorkerIndex;
+
+    /* The idle workers wait on this condition until jobs are pushed or the JobSystem is terminated. */
+    SDL_mutex *wakeMutex;
+    SDL_cond *wakeCondition;
+
+    /* The Singleton instance. */
+    static JobSystem *instance;
+
+};
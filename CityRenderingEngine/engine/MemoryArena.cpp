@@ -0,0 +1,56 @@
+#include "MemoryArena.h"
+
+SDL_atomic_t MemoryArena::totalKBReserved;
+SDL_atomic_t MemoryArena::totalLiveObjects;
+
+MemoryArena::MemoryArena(void) {
+    current = nullptr;
+    end = nullptr;
+}
+
+MemoryArena::~MemoryArena(void) {
+    for (auto it = blocks.begin(); it != blocks.end(); it++) {
+        free(*it);
+    }
+    blocks.clear();
+    SDL_AtomicAdd(&totalKBReserved, -(int) (stats.bytesReserved / 1024));
+    SDL_AtomicAdd(&totalLiveObjects, -stats.numLiveObjects);
+}
+
+void *MemoryArena::allocate(size_t size) {
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    if (current == nullptr || (size_t) (end - current) < size) {
+        if (!addBlock(size)) return nullptr;
+    }
+    void *pointer = current;
+    current += size;
+    stats.numAllocations++;
+    stats.numLiveObjects++;
+    stats.bytesLive += size;
+    stats.peakLiveObjects = max(stats.peakLiveObjects, stats.numLiveObjects);
+    stats.peakBytesLive = max(stats.peakBytesLive, stats.bytesLive);
+    SDL_AtomicAdd(&totalLiveObjects, 1);
+    return pointer;
+}
+
+void MemoryArena::deallocate(void *pointer, size_t size) {
+    if (pointer == nullptr) return;
+    size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    stats.numLiveObjects--;
+    stats.bytesLive -= min(stats.bytesLive, size);
+    SDL_AtomicAdd(&totalLiveObjects, -1);
+}
+
+bool MemoryArena::addBlock(size_t size) {
+    // Whole KBs, so the total of all arenas can be kept in KB
+    size_t blockSize = size > BLOCK_SIZE ? (size + 1023) & ~((size_t) 1023) : BLOCK_SIZE;
+    // malloc only guarantees 8 bytes on 32 bits, so the start of the block is aligned by hand
+    char *block = (char*) malloc(blockSize + ALIGNMENT);
+    if (block == nullptr) return false;
+    blocks.push_back(block);
+    current = (char*) (((size_t) block + ALIGNMENT - 1) & ~(ALIGNMENT - 1));
+    end = current + blockSize;
+    stats.bytesReserved += blockSize;
+    SDL_AtomicAdd(&totalKBReserved, (int) (blockSize / 1024));
+    return true;
+}
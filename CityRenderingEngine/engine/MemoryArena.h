@@ -0,0 +1,80 @@
+/*
+ * Description: A monotonic allocator for objects that all die together, like the contents of a Chunk. The memory is
+ * taken from the system in blocks of BLOCK_SIZE bytes, and each allocation just moves a pointer forward in the current
+ * block. Deallocating doesn't give any memory back, it's only counted, and all the blocks are released at once when
+ * the arena is deleted. Allocations bigger than a block get a block of their own.
+ *
+ * Every arena keeps the statistics of its memory and objects (see ArenaStats), and the totals of all the arenas are
+ * kept as well, so objects that are never deallocated show up as leaks. An arena is not thread safe: it must only be
+ * used by one thread at a time, like a Chunk is only generated, loaded or unloaded by one ChunkLoader worker.
+ */
+
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+#include <cstdlib>
+#include "math/Common.h"
+
+/* Statistics of a MemoryArena, or of all of them. */
+struct ArenaStats {
+    /* The memory taken from the system, in blocks, not counting the bytes used to align them. */
+    size_t bytesReserved;
+    /* The memory of the objects allocated and not deallocated yet, and the highest it's been. */
+    size_t bytesLive;
+    size_t peakBytesLive;
+    /* The number of objects allocated and not deallocated yet, and the highest it's been. */
+    int numLiveObjects;
+    int peakLiveObjects;
+    /* The total number of allocations. */
+    int numAllocations;
+
+    ArenaStats(void) : bytesReserved(0), bytesLive(0), peakBytesLive(0), numLiveObjects(0), peakLiveObjects(0),
+        numAllocations(0) {}
+};
+
+class MemoryArena {
+public:
+
+    /* The size of each block of memory taken from the system. */
+    static const size_t BLOCK_SIZE = 64 * 1024;
+
+    /* The alignment of every allocation. */
+    static const size_t ALIGNMENT = 16;
+
+    MemoryArena(void);
+    ~MemoryArena(void);
+
+    /* Returns size bytes aligned to ALIGNMENT, or null if the system is out of memory. */
+    void *allocate(size_t size);
+
+    /* Counts the deallocation of an object of size bytes. Its memory is only released with the arena. */
+    void deallocate(void *pointer, size_t size);
+
+    /* Returns the statistics of this arena. */
+    const ArenaStats &getStats() const { return stats; }
+
+    /* Returns the total memory reserved and the number of objects alive in all the arenas. */
+    static size_t getTotalBytesReserved() { return (size_t) SDL_AtomicGet(&totalKBReserved) * 1024; }
+    static int getTotalLiveObjects() { return SDL_AtomicGet(&totalLiveObjects); }
+
+protected:
+
+    /* Gets a new block with at least size bytes from the system, and makes it the current block. */
+    bool addBlock(size_t size);
+
+    /* The blocks taken from the system, and the free space left at the end of the last one. */
+    std::vector<char*> blocks;
+    char *current;
+    char *end;
+
+    ArenaStats stats;
+
+    /* The totals of all the arenas. The reserved memory is counted in KB, so it doesn't overflow. */
+    static SDL_atomic_t totalKBReserved;
+    static SDL_atomic_t totalLiveObjects;
+
+    /* An arena owns its blocks, so it can't be copied. */
+    MemoryArena(const MemoryArena &copy);
+    MemoryArena &operator=(const MemoryArena &other);
+};
@@ -1,4 +1,5 @@
 #include "Naquadah.h"
+#include "rendering/UploadQueue.h"
 
 Naquadah *Naquadah::instance = nullptr;
 int Naquadah::TARGET_FPS = 60;
@@ -43,6 +44,7 @@ void Naquadah::initialize(unsigned int initModules) {
     if (initModules > 0 || initEverything) {
         // Init Graphics
         instance->renderer = new Renderer();
+        UploadQueue::initialize();
     }
     // Init only core SDL features
     // Init keyboard and mouse managers
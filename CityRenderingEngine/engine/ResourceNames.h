@@ -35,4 +35,7 @@ static const int MATERIAL_BASIC = 2000;
 static const int SHADER_LIGHT_BASIC = 5000;
 static const int SHADER_INTERFACE = 5001;
 static const int SHADER_SKY_BOX = 5002;
-static const int SHADER_LIGHT_ROAD = 5003;
\ No newline at end of file
+static const int SHADER_LIGHT_ROAD = 5003;
+
+// Variants of the light shader (from 5120 to 5135), see LightShader
+static const int SHADER_LIGHT_VARIANTS = 5120;
\ No newline at end of file
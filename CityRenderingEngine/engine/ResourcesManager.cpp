@@ -6,7 +6,7 @@ SDL_mutex *ResourcesManager::mutex = nullptr;
 
 void ResourcesManager::initialize() {
     ResourcesManager::resources = new std::map<int, Resource*>();
-    //mutex = SDL_CreateMutex();
+    mutex = SDL_CreateMutex();
 }
 
 void ResourcesManager::terminate() {
@@ -20,6 +20,7 @@ void ResourcesManager::terminate() {
     resources = nullptr;
     unlockMutex();
     SDL_DestroyMutex(mutex);
+    mutex = nullptr;
 }
 
 bool ResourcesManager::addResource(Resource *resource, bool load) {
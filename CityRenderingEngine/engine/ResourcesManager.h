@@ -77,16 +77,22 @@ public:
      * 1,000,000, while the numbers before that are reserved for fixed naming instead of this generated method.
      */
     static int generateNextName() {
-        return nameSequence++;
+        lockMutex();
+        int name = nameSequence++;
+        unlockMutex();
+        return name;
     }
 
-    /* Locks and unlocks the mutex, to prevent errors while accessing and editting the entities map */
+    /*
+     * Locks and unlocks the mutex, to prevent errors while accessing and editting the entities map. The mutex is
+     * recursive, so it's safe to lock it again from a thread that already holds it.
+     */
     static void lockMutex() {
-        //SDL_mutexP(mutex);
+        if (mutex != nullptr) SDL_mutexP(mutex);
     }
 
     static void unlockMutex() {
-        //SDL_mutexV(mutex);
+        if (mutex != nullptr) SDL_mutexV(mutex);
     }
 
 protected:
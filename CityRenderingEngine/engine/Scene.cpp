@@ -1,7 +1,9 @@
 #include "Scene.h"
 
 Scene::Scene() {
-    entities = new std::map<std::string, Entity*>();
+    entities = new EntitySlotMap();
+    parallelEntities = new std::vector<Entity*>();
+    parallelMillisElapsed = 0;
     //opaqueEntities = new std::vector<Entity*>();
     //opaqueEntities->reserve(25000);
     //transparentEntities = new std::vector<Entity*>();
@@ -18,11 +20,19 @@ Scene::Scene() {
     renderMutex = SDL_CreateMutex();
     userInterface = nullptr;
     frustum = new Frustum(*projectionMatrix * *cameraMatrix);
+    occlusionBuffer = new OcclusionBuffer();
+    frameUniforms = new FrameUniforms();
+    renderQueue = new RenderQueue();
+    fogColour = Vector4(0, 0, 0, 0);
+    fogStart = 3000.0f;
+    fogEnd = 4000.0f;
 }
 
 Scene::Scene(const Scene &copy) {
     this->cameraMatrix = new Matrix4(*(copy.cameraMatrix));
-    this->entities = new std::map<std::string, Entity*>(*(copy.entities));
+    this->entities = new EntitySlotMap(*(copy.entities));
+    this->parallelEntities = new std::vector<Entity*>();
+    this->parallelMillisElapsed = 0;
     this->opaqueEntities = new std::vector<Entity*>(*(copy.opaqueEntities));
     this->transparentEntities = new std::vector<Entity*>(*(copy.transparentEntities));
     this->camera = new Camera(*(copy.camera));
@@ -33,10 +43,18 @@ Scene::Scene(const Scene &copy) {
     this->updateMutex = copy.updateMutex;
     this->skybox = new Skybox(*(copy.skybox));
     this->frustum = new Frustum(*(copy.frustum));
+    this->occlusionBuffer = new OcclusionBuffer();
+    this->frameUniforms = new FrameUniforms();
+    this->renderQueue = new RenderQueue();
+    this->fogColour = copy.fogColour;
+    this->fogStart = copy.fogStart;
+    this->fogEnd = copy.fogEnd;
 }
 
 Scene::Scene(UserInterface *userInterface) {
-    entities = new std::map<std::string, Entity*>();
+    entities = new EntitySlotMap();
+    parallelEntities = new std::vector<Entity*>();
+    parallelMillisElapsed = 0;
     projectionMatrix = new Matrix4(Matrix4::Perspective(1.0f, -100.0f, 1280.0f/720.0f, 45.0f));
     cameraMatrix = new Matrix4(Matrix4::Translation(Vector3(0, 0, -10.0f)));
     camera = new Camera();
@@ -49,6 +67,12 @@ Scene::Scene(UserInterface *userInterface) {
     updateMutex = SDL_CreateMutex();
     renderMutex = SDL_CreateMutex();
     frustum = new Frustum(*projectionMatrix * *cameraMatrix);
+    occlusionBuffer = new OcclusionBuffer();
+    frameUniforms = new FrameUniforms();
+    renderQueue = new RenderQueue();
+    fogColour = Vector4(0, 0, 0, 0);
+    fogStart = 3000.0f;
+    fogEnd = 4000.0f;
 }
 
 Scene::~Scene(void) {
@@ -61,6 +85,10 @@ Scene::~Scene(void) {
         delete entities;
         entities = nullptr;
     }
+    if (parallelEntities != nullptr) {
+        delete parallelEntities;
+        parallelEntities = nullptr;
+    }
     if (opaqueEntities != nullptr) {
         opaqueEntities->clear();
         delete opaqueEntities;
@@ -83,6 +111,19 @@ Scene::~Scene(void) {
         delete frustum;
         frustum = nullptr;
     }
+    if (occlusionBuffer != nullptr) {
+        delete occlusionBuffer;
+        occlusionBuffer = nullptr;
+    }
+    if (frameUniforms != nullptr) {
+        frameUniforms->unload();
+        delete frameUniforms;
+        frameUniforms = nullptr;
+    }
+    if (renderQueue != nullptr) {
+        delete renderQueue;
+        renderQueue = nullptr;
+    }
     if (skybox != nullptr) {
         delete skybox;
         skybox = nullptr;
@@ -220,17 +261,37 @@ void Scene::onKeyUp(SDL_Keysym key) {
     }*/
 }
 
-bool Scene::isEntityInScene(std::string name) {
-    return entities->find(name) != entities->end();
+bool Scene::isEntityInScene(EntityHandle handle) {
+    lockUpdateMutex();
+    bool inScene = entities->contains(handle);
+    unlockUpdateMutex();
+    return inScene;
+}
+
+Entity *Scene::findEntity(const std::string &name) {
+#ifdef _DEBUG
+    lockUpdateMutex();
+    Entity *entity = entities->find(name);
+    unlockUpdateMutex();
+    return entity;
+#else
+    (void) name; // Release builds don't keep the names
+    return nullptr;
+#endif
 }
 
-void Scene::addEntity(Entity *entity, std::string name) {
+EntityHandle Scene::addEntity(Entity *entity, const std::string &name) {
     lockUpdateMutex();
     lockRenderMutex();
-    if (entity && name != "") {
+    EntityHandle handle = INVALID_ENTITY_HANDLE;
+    if (entity) {
         if (entity->getParent() == nullptr) {
-            // Only add to this map if it's a root entity 
-            entities->insert(std::pair<std::string, Entity*>(name, entity));
+            // Only add to this map if it's a root entity
+            handle = entities->add(entity);
+            (void) name; // Only kept in debug builds
+#ifdef _DEBUG
+            if (name != "") entities->setName(handle, name);
+#endif
         }
         // Add it to opaque or transparent lists and reorder them
         // Note that the children entities will also be added to the lists
@@ -248,19 +309,16 @@ void Scene::addEntity(Entity *entity, std::string name) {
     }
     unlockUpdateMutex();
     unlockRenderMutex();
+    return handle;
 }
 
-bool Scene::removeEntity(std::string name) {
+bool Scene::removeEntity(EntityHandle handle) {
     lockUpdateMutex();
     lockRenderMutex();
-    if (isEntityInScene(name)) {
-        unlockUpdateMutex();
-        unlockRenderMutex();
-        return entities->erase(name) > 0;
-    }
+    bool removed = entities->remove(handle);
     unlockRenderMutex();
     unlockUpdateMutex();
-    return false;
+    return removed;
 }
 
 void Scene::update(float millisElapsed) {
@@ -304,13 +362,21 @@ void Scene::update(float millisElapsed) {
         }
     }
 
-    unsigned numEntities = (unsigned) entities->size();
     // Doing this makes it unsafe for entities to add and remove other entities from the Scene, but speeds things up.
     auto it = entities->begin();
     auto itEnd = entities->end();
+    parallelEntities->clear();
     for (; it != itEnd; it++) {
-        it->second->update(millisElapsed);
+        if ((*it)->isUpdateIndependent()) {
+            parallelEntities->push_back(*it);
+        } else {
+            (*it)->update(millisElapsed);
+        }
     }
+    // Each independent entity, like a Chunk and all its children, is a job of its own
+    parallelMillisElapsed = millisElapsed;
+    JobSystem::getInstance()->parallelFor((int) parallelEntities->size(), 1, &Scene::updateParallelEntities, this);
+    compactTransforms();
 
     // Recalculate camera
     if (camera && camera->hasChanged()) {
@@ -322,16 +388,57 @@ void Scene::update(float millisElapsed) {
     Profiler::getTimer(2)->finishMeasurement();
 }
 
+void Scene::compactTransforms() {
+    bool needsCompaction = false;
+    for (auto it = entities->begin(); it != entities->end() && !needsCompaction; it++) {
+        needsCompaction = (*it)->needsTransformCompaction();
+    }
+    if (!needsCompaction) return;
+    // The render thread holds pointers to the matrices until the frame is drawn, so this waits for it to finish
+    lockRenderMutex();
+    for (auto it = entities->begin(); it != entities->end(); it++) {
+        if ((*it)->needsTransformCompaction()) {
+            (*it)->compactTransforms();
+        }
+    }
+    unlockRenderMutex();
+}
+
+void Scene::updateParallelEntities(int begin, int end, void *data) {
+    Scene *scene = (Scene*) data;
+    for (int i = begin; i < end; i++) {
+        (*scene->parallelEntities)[i]->update(scene->parallelMillisElapsed);
+    }
+}
+
 void Scene::render(Renderer *renderer, float millisElapsed) {
     lockRenderMutex();
     // Apply camera's changes since last frame and update the view frustum
     *cameraMatrix = camera->getCameraMatrix();
     frustum->updateMatrix(*projectionMatrix * *cameraMatrix);
 
-    bool updatedCameraMatrix = false;
-    if (renderer->getCurrentShader() != nullptr && renderer->getCurrentShader()->isLoaded()) {
-        renderer->updateShaderMatrix("viewMatrix", cameraMatrix);
+    // Rasterize the occluders of this frame, before anything is tested against them
+    Profiler::getTimer(5)->startMeasurement();
+    occlusionBuffer->begin(*projectionMatrix * *cameraMatrix);
+    renderOccluders();
+    Profiler::getTimer(5)->finishMeasurement();
+    Profiler::getTimer(5)->resetCycle();
+
+    // Upload the data shared by all Shaders for this frame
+    FrameData frameData;
+    frameData.viewMatrix = *cameraMatrix;
+    frameData.projMatrix = *projectionMatrix;
+    frameData.viewProjMatrix = *projectionMatrix * *cameraMatrix;
+    Vector3 cameraPos = camera->getPosition();
+    frameData.cameraPosition = Vector4(cameraPos.x, cameraPos.y, cameraPos.z, 1.0f);
+    if (lightSource != nullptr) {
+        lightSource->updateFrameData(frameData);
+    } else {
+        frameData.lightColour = Vector4(0, 0, 0, 0);
     }
+    frameData.fogColour = fogColour;
+    frameData.fogDistance = Vector4(fogStart, fogEnd, 0, 0);
+    frameUniforms->update(frameData);
 
     // Draw skybox, if present
     if (skybox != nullptr) {
@@ -341,18 +448,20 @@ void Scene::render(Renderer *renderer, float millisElapsed) {
         skybox->render(this);
     }
 
-    // Draw Entities
+    // Collect the draws of the visible Entities, and draw them sorted by Shader, texture and depth
+    renderQueue->begin(cameraPos);
     auto it = entities->begin();
     auto itEnd = entities->end();
     for (; it != itEnd; it++) {
-        if (&it) {
-            // We first get the right shader to use with this entity
-            Entity *entity = it->second;
-            if (frustum->isEntityInside(entity)) {
-                entity->draw(millisElapsed);
-            }
+        Entity *entity = *it;
+        unsigned char planeMask = Frustum::ALL_PLANES;
+        if (frustum->testSphere(entity->getWorldPosition(), entity->getRenderRadius(), planeMask) !=
+            FRUSTUM_OUTSIDE) {
+            frustum->addObjectDrawn();
+            entity->queueDraw(renderQueue, planeMask);
         }
     }
+    renderQueue->submit(this);
 
     // Draw Interface
     if (userInterface != nullptr) {
@@ -360,9 +469,9 @@ void Scene::render(Renderer *renderer, float millisElapsed) {
             userInterface->getInterfaceShader()->load();
         }
         renderer->useShader(userInterface->getInterfaceShader());
-        renderer->updateShaderMatrix("viewMatrix", &(Matrix4::Translation(Vector3(0, 0, 1.0f))));
+        renderer->updateShaderMatrix(UNIFORM_VIEW_MATRIX, &(Matrix4::Translation(Vector3(0, 0, 1.0f))));
         Vector2 windowSize = renderer->getWindowSize();
-        renderer->updateShaderMatrix("projMatrix", &(Matrix4::Orthographic(-1, 1, windowSize.x, 0, windowSize.y, 0)));
+        renderer->updateShaderMatrix(UNIFORM_PROJ_MATRIX, &(Matrix4::Orthographic(-1, 1, windowSize.x, 0, windowSize.y, 0)));
         userInterface->draw(millisElapsed);
     }
     unlockRenderMutex();
@@ -434,12 +543,8 @@ void Scene::useShader(Shader *shader) {
         if (shader->isValid()) { // Check this again just on case there's a problem loading the Shader
             Renderer *renderer = Naquadah::getRenderer();
             if (shader != renderer->getCurrentShader()) {
+                // The camera and light come from the FrameData uniform block, only the parameters need updating
                 renderer->useShader(shader);
-                renderer->updateShaderMatrix("projMatrix", projectionMatrix);
-                renderer->updateShaderMatrix("viewMatrix", cameraMatrix);
-                if (lightSource != nullptr) {
-                    lightSource->updateShaderParameters(shader);
-                }
                 shader->updateShaderParameters(false);
             }
         }
@@ -12,6 +12,8 @@
 #include <algorithm>
 #include "Entity.h"
 #include "Naquadah.h"
+#include "JobSystem.h"
+#include "EntitySlotMap.h"
 #include "math/Common.h"
 #include "math/Matrix4.h"
 #include "rendering/Light.h"
@@ -20,6 +22,9 @@
 #include "rendering/Skybox.h"
 #include "rendering/Frustum.h"
 #include "rendering/Renderer.h"
+#include "rendering/OcclusionBuffer.h"
+#include "rendering/FrameUniforms.h"
+#include "rendering/RenderQueue.h"
 
 class UserInterface;
 class Renderer;
@@ -65,21 +70,33 @@ public:
      * ==========================================
      */
 
-    /* Updates the Scene logic. */
+    /*
+     * Updates the Scene logic. The entities are updated in the order of the slot map, except for the independent ones
+     * (see Entity::isUpdateIndependent()), which are updated afterwards, in parallel, by the JobSystem.
+     */
     virtual void update(float millisElapsed);
 
     /* Renders all the Scene objects and the interface. Renderer is the active renderer on the engine. */
     virtual void render(Renderer *renderer, float millisElapsed);
 
+    /*
+     * Rasterizes the biggest occluders of the Scene into the OcclusionBuffer. Called by render() after the camera is
+     * updated and before any Entity is drawn. Does nothing by default, so nothing is ever occluded.
+     */
+    virtual void renderOccluders() {}
+
     /* ==========================================
      * =============== Other stuff ==============
      * ==========================================
      */
 
-    // Adds a new entity to this level
-    virtual void addEntity(Entity *entity, std::string name);
-    // Removes a entity from this level
-    bool removeEntity(std::string name);
+    /*
+     * Adds a root entity to this level, and returns the handle to look it up or remove it later. Children can't be
+     * added, and return INVALID_ENTITY_HANDLE. The name is only kept in debug builds, to find it with findEntity().
+     */
+    virtual EntityHandle addEntity(Entity *entity, const std::string &name = "");
+    /* Removes the entity of handle from this level. Returns false if it wasn't in the level. */
+    bool removeEntity(EntityHandle handle);
 
     // General getters and setters
     void setCameraMatrix(Matrix4 &cameraMatrix) { (*this->cameraMatrix) = cameraMatrix; }
@@ -96,22 +113,31 @@ public:
     void setCamera(Camera &camera) { *(this->camera) = camera; camera.setChanged(true); }
     Camera *getCamera() const { return camera; }
     Frustum *getFrustum() const { return frustum; }
+    OcclusionBuffer *getOcclusionBuffer() const { return occlusionBuffer; }
+    RenderQueue *getRenderQueue() const { return renderQueue; }
     void setSkybox(Skybox *skybox) { this->skybox = skybox; }
+
+    /* Sets the fog colour, and the distances where the fog starts and where it's complete. */
+    void setFog(const Vector4 &fogColour, float fogStart, float fogEnd) {
+        this->fogColour = fogColour;
+        this->fogStart = fogStart;
+        this->fogEnd = fogEnd;
+    }
+    /* The fog is off when it ends before it starts, like after setFog(colour, 0, 0). */
+    bool isFogEnabled() const { return fogEnd > fogStart; }
     Skybox *getSkybox() const { return skybox; }
 
 
-    /* Checks if the entity with the provided name has been added to this level */
-    bool isEntityInScene(std::string name);
+    /* Checks if the entity of handle is in this level. */
+    bool isEntityInScene(EntityHandle handle);
 
-    Entity *getEntity(std::string name) {
-        try {
-            return entities->at(name);
-        } catch (int &) {
-            return NULL;
-        }
-    }
+    /* Returns the entity of handle, or null if it isn't in this level. */
+    Entity *getEntity(EntityHandle handle) { return entities->get(handle); }
 
-    std::map<std::string, Entity*> *getEntities() { return entities; }
+    /* Returns the entity added with name. Only for debugging: release builds don't keep the names, and return null. */
+    Entity *findEntity(const std::string &name);
+
+    EntitySlotMap *getEntities() { return entities; }
 
     /*
      * Uses the Shader specified. If the Shader is already being used, it won't do anything. If the Shader is switched,
@@ -134,7 +160,10 @@ public:
 protected:
 
     /* A list with all the root (parent) entities contained in this level. No child entity should be added here. */
-    std::map<std::string, Entity*> *entities;
+    EntitySlotMap *entities;
+    /* The independent entities being updated in parallel by update(), and the time elapsed to update them by. */
+    std::vector<Entity*> *parallelEntities;
+    float parallelMillisElapsed;
     /* A list with all the opaque entities, including children, ordered from the closest to the farthest. */
     std::vector<Entity*> *opaqueEntities;
     /* A list with all the transparent entities, including children, ordered from the farthest fo the closest. */
@@ -143,6 +172,20 @@ protected:
     /* The Frustum used by this Scene to perform Frustum Culling. */
     Frustum *frustum;
 
+    /* The depth buffer used to skip Entities hidden behind the occluders rasterized by renderOccluders(). */
+    OcclusionBuffer *occlusionBuffer;
+
+    /* The uniform buffer with the camera, light and fog, updated once per frame and shared by all Shaders. */
+    FrameUniforms *frameUniforms;
+
+    /* The draws of the visible Entities, collected every frame and drawn sorted by state. */
+    RenderQueue *renderQueue;
+
+    /* The fog settings. Default to a black fog from 3000 to 4000 units away. */
+    Vector4 fogColour;
+    float fogStart;
+    float fogEnd;
+
     /* The LightSource for this Scene. Defaults to null. */
     Light *lightSource;
 
@@ -159,4 +202,13 @@ protected:
 
     SDL_mutex *updateMutex;
     SDL_mutex *renderMutex;
+
+    /*
+     * Compacts the TransformStores of the entities with too many removed transforms, holding the render mutex, so it
+     * never happens while the render thread is drawing with their matrices.
+     */
+    void compactTransforms();
+
+    /* The job of update() that updates the parallelEntities from begin to end of the Scene in data. */
+    static void updateParallelEntities(int begin, int end, void *data);
 };
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "TransformStore.h"
+#include "Entity.h"
+
+TransformStore::TransformStore(void) {
+    firstDirty = NONE_DIRTY;
+    numRemoved = 0;
+}
+
+int TransformStore::add(Entity *owner, int parent, const Vector3 &position, const Vector3 &rotation,
+    const Vector3 &scale) {
+    int index = getSize();
+    positions.push_back(position);
+    rotations.push_back(rotation);
+    scales.push_back(scale);
+    parents.push_back(parent);
+    worldPositions.push_back(Vector3());
+    worldRotations.push_back(Vector3());
+    worldScales.push_back(Vector3(1, 1, 1));
+    worldMatrices.push_back(Matrix4());
+    flags.push_back(ALIVE);
+    owners.push_back(owner);
+    // If the parent is dirty, the next update() will update this one as well, as its child
+    calculateWorld(index, true);
+    return index;
+}
+
+void TransformStore::remove(int index) {
+    flags[index] = 0;
+    owners[index] = nullptr;
+    numRemoved++;
+}
+
+void TransformStore::update() {
+    int size = getSize();
+    for (int i = firstDirty; i < size; i++) {
+        unsigned char flag = flags[i];
+        if ((flag & ALIVE) == 0) continue;
+        unsigned char dirty = flag & (POSITION_DIRTY | BASIS_DIRTY);
+        // Only the parents after firstDirty were updated in this pass, the CHANGED flags of the others are old
+        int parent = parents[i];
+        if (parent >= firstDirty) {
+            dirty |= (flags[parent] >> 2) & (POSITION_DIRTY | BASIS_DIRTY);
+        }
+        if (dirty != 0) {
+            calculateWorld(i, (dirty & BASIS_DIRTY) != 0);
+        }
+        flags[i] = ALIVE | (dirty << 2);
+    }
+    firstDirty = NONE_DIRTY;
+}
+
+void TransformStore::calculateWorld(int index, bool basisChanged) {
+    int parent = parents[index];
+    if (parent == NO_PARENT) {
+        worldPositions[index] = positions[index];
+        worldRotations[index] = rotations[index];
+        worldScales[index] = scales[index];
+    } else {
+        worldPositions[index] = positions[index] + worldPositions[parent];
+        worldRotations[index] = rotations[index] + worldRotations[parent];
+        worldScales[index] = scales[index] * worldScales[parent];
+    }
+    if (basisChanged) {
+        worldMatrices[index] = Matrix4::Transform(worldPositions[index], worldRotations[index], worldScales[index]);
+    } else {
+        // Only the position changed, the rotation and scale in the matrix are still right
+        worldMatrices[index].setPositionVector(worldPositions[index]);
+    }
+}
+
+Vector3 TransformStore::getWorldPosition(int index) const {
+    Vector3 worldPosition = positions[index];
+    for (int parent = parents[index]; parent != NO_PARENT; parent = parents[parent]) {
+        worldPosition += positions[parent];
+    }
+    return worldPosition;
+}
+
+void TransformStore::compact() {
+    int size = getSize();
+    // The transforms are only moved towards the start, so the parents stay before their children
+    std::vector<int> remap(size, NO_PARENT);
+    int next = 0;
+    for (int i = 0; i < size; i++) {
+        if ((flags[i] & ALIVE) == 0) continue;
+        remap[i] = next;
+        int parent = parents[i];
+        parents[next] = parent == NO_PARENT ? NO_PARENT : remap[parent];
+        if (next != i) {
+            positions[next] = positions[i];
+            rotations[next] = rotations[i];
+            scales[next] = scales[i];
+            worldPositions[next] = worldPositions[i];
+            worldRotations[next] = worldRotations[i];
+            worldScales[next] = worldScales[i];
+            worldMatrices[next] = worldMatrices[i];
+            flags[next] = flags[i];
+            owners[next] = owners[i];
+        }
+        owners[next]->transformIndex = next;
+        next++;
+    }
+    positions.resize(next);
+    rotations.resize(next);
+    scales.resize(next);
+    parents.resize(next);
+    worldPositions.resize(next);
+    worldRotations.resize(next);
+    worldScales.resize(next);
+    worldMatrices.resize(next);
+    flags.resize(next);
+    owners.resize(next);
+    numRemoved = 0;
+}
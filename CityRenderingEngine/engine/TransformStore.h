@@ -0,0 +1,134 @@
+/*
+ * Description: The transforms of a hierarchy of Entities, kept in contiguous arrays (one per attribute) instead of
+ * inside each Entity. Each Entity is a handle into a TransformStore: the store and the index of its transform. The
+ * Entity at the top of the hierarchy, like a Chunk, creates and owns the store, and its children, grandchildren, etc
+ * are added to it, so a whole Chunk is updated by a single linear pass over its store, without any recursion.
+ *
+ * The parent of a transform always comes before it in the arrays, so the pass can update them in order, knowing that
+ * the parent is already updated. Setting a transform only marks it as dirty, and the pass starts from the first dirty
+ * transform, updating the dirty ones and the children of the ones updated. Only the translation is set on the matrix
+ * if the position is all that changed.
+ *
+ * The hierarchy works the way it always did in the engine: the world position and rotation of a transform are its own
+ * plus the ones of its parent, and the world scale is its own times the scale of its parent.
+ *
+ * Removed transforms only leave a hole, and the arrays are compacted once there are too many holes. Compacting moves
+ * the world matrices, which the render thread reads while it draws, so it's not part of update(): the Scene compacts
+ * the stores between two frames, holding its render mutex (see Scene::update()).
+ */
+
+#pragma once
+
+#include <vector>
+#include "math/Vector3.h"
+#include "math/Matrix4.h"
+
+class Entity;
+
+class TransformStore {
+public:
+
+    /* The parent index of the transforms that don't have a parent. */
+    static const int NO_PARENT = -1;
+
+    TransformStore(void);
+    ~TransformStore(void) {}
+
+    /*
+     * Adds a transform, owned by owner, as a child of parent (which must be in this store), or NO_PARENT. Its world
+     * matrix is calculated right away. Returns the index of the new transform.
+     */
+    int add(Entity *owner, int parent, const Vector3 &position, const Vector3 &rotation, const Vector3 &scale);
+
+    /* Removes a transform. Its children must have been removed or moved to another store first. */
+    void remove(int index);
+
+    /* Updates the world matrix of the dirty transforms and of their children, in one pass. */
+    void update();
+
+    /* Returns true if enough transforms were removed for compact() to be worth it. */
+    bool needsCompaction() const { return numRemoved >= MIN_REMOVED_TO_COMPACT && numRemoved * 2 >= getSize(); }
+
+    /*
+     * Removes the holes left by the removed transforms, keeping the order, and updates the indexes of the owners. No
+     * other thread may be reading the matrices, as they're moved.
+     */
+    void compact();
+
+    /* Getters and setters of the local transform. The setters mark the transform as dirty. */
+    const Vector3 &getPosition(int index) const { return positions[index]; }
+    const Vector3 &getRotation(int index) const { return rotations[index]; }
+    const Vector3 &getScale(int index) const { return scales[index]; }
+    void setPosition(int index, const Vector3 &position) {
+        positions[index] = position;
+        markDirty(index, POSITION_DIRTY);
+    }
+    void setRotation(int index, const Vector3 &rotation) {
+        rotations[index] = rotation;
+        markDirty(index, BASIS_DIRTY);
+    }
+    void setScale(int index, const Vector3 &scale) {
+        scales[index] = scale;
+        markDirty(index, BASIS_DIRTY);
+    }
+
+    /* Returns the world matrix calculated by the last update(). The reference is valid until the next compact(). */
+    const Matrix4 &getWorldMatrix(int index) const { return worldMatrices[index]; }
+
+    /* Returns the world position of a transform, adding the positions of its parents, even if it wasn't updated. */
+    Vector3 getWorldPosition(int index) const;
+
+    /* Returns the number of transforms in the arrays, including the removed ones not compacted yet. */
+    int getSize() const { return (int) positions.size(); }
+
+protected:
+
+    /* Flags of each transform. The CHANGED flags are the DIRTY ones moved 2 bits, set when it's updated. */
+    enum TransformFlags {
+        ALIVE = 1,
+        POSITION_DIRTY = 2,
+        BASIS_DIRTY = 4,
+        POSITION_CHANGED = 8,
+        BASIS_CHANGED = 16
+    };
+
+    /* Value of firstDirty when no transform is dirty. */
+    static const int NONE_DIRTY = 0x7FFFFFFF;
+
+    /* The arrays are compacted when at least this many transforms were removed, and they're half of the arrays. */
+    static const int MIN_REMOVED_TO_COMPACT = 64;
+
+    void markDirty(int index, unsigned char flag) {
+        flags[index] |= flag;
+        if (index < firstDirty) firstDirty = index;
+    }
+
+    /* Calculates the world transform of index from its parent's, which must be up to date. */
+    void calculateWorld(int index, bool basisChanged);
+
+    /* The local transform. */
+    std::vector<Vector3> positions;
+    std::vector<Vector3> rotations;
+    std::vector<Vector3> scales;
+
+    /* The index of the parent of each transform, always lower than the transform's, or NO_PARENT. */
+    std::vector<int> parents;
+
+    /* The world transform, combined with the parents', and the world matrix built from it. */
+    std::vector<Vector3> worldPositions;
+    std::vector<Vector3> worldRotations;
+    std::vector<Vector3> worldScales;
+    std::vector<Matrix4> worldMatrices;
+
+    /* TransformFlags of each transform. */
+    std::vector<unsigned char> flags;
+
+    /* The Entity of each transform, or null if it was removed. Only used to update the handles when compacting. */
+    std::vector<Entity*> owners;
+
+    /* The index of the first dirty transform, or NONE_DIRTY. */
+    int firstDirty;
+
+    /* The number of transforms removed since the arrays were compacted. */
+    int numRemoved;
+};
@@ -0,0 +1,119 @@
+/*
+ * Description: A growable byte buffer used to write and read binary files. Values are written one after the other with
+ * write(), with no padding or type information, and must be read back in the same order and with the same types with
+ * read(). Values are stored with the byte order of the machine, which is little endian on every platform the engine
+ * currently runs on.
+ *
+ * Reading past the end of the buffer won't crash: the read value will be zeroed and the buffer will be marked as
+ * failed, so a loader can read a whole structure and check hasFailed() only once at the end, discarding truncated or
+ * corrupted files.
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include "FileIO.h"
+
+class BinaryBuffer {
+public:
+
+    BinaryBuffer(void) {
+        this->data = new std::vector<char>();
+        this->readPosition = 0;
+        this->failed = false;
+    }
+
+    ~BinaryBuffer(void) {
+        if (data != nullptr) {
+            delete data;
+            data = nullptr;
+        }
+    }
+
+    /* Appends size bytes from source to the end of the buffer. */
+    void writeBytes(const void *source, size_t size) {
+        const char *bytes = (const char*) source;
+        data->insert(data->end(), bytes, bytes + size);
+    }
+
+    /* Appends a value to the end of the buffer. T must be a plain type, like an int, a float or a Vector2. */
+    template <typename T>
+    void write(const T &value) {
+        writeBytes(&value, sizeof(T));
+    }
+
+    /* Copies the next size bytes of the buffer to destination. Returns false if there aren't enough bytes left. */
+    bool readBytes(void *destination, size_t size) {
+        if (failed || readPosition + size > data->size()) {
+            failed = true;
+            memset(destination, 0, size);
+            return false;
+        }
+        memcpy(destination, &(*data)[readPosition], size);
+        readPosition += size;
+        return true;
+    }
+
+    /* Reads the next value of the buffer. If there aren't enough bytes left, returns a zeroed value. */
+    template <typename T>
+    T read() {
+        T value;
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+
+    /* Skips size bytes without reading them. */
+    void skip(size_t size) {
+        if (failed || readPosition + size > data->size()) {
+            failed = true;
+            return;
+        }
+        readPosition += size;
+    }
+
+    /* Moves the read position to the beginning of the buffer and clears the failed flag. */
+    void rewind() {
+        readPosition = 0;
+        failed = false;
+    }
+
+    /* Removes all data from the buffer. */
+    void clear() {
+        data->clear();
+        rewind();
+    }
+
+    /* Writes the whole buffer to fileName, replacing it. Returns true if the file was written successfully. */
+    bool saveToFile(const std::string &fileName) {
+        return FileIO::writeBinaryFile(fileName, data->empty() ? nullptr : &(*data)[0], data->size());
+    }
+
+    /* Replaces the contents of the buffer with the contents of fileName. Returns false if it couldn't be read. */
+    bool loadFromFile(const std::string &fileName) {
+        rewind();
+        return FileIO::readBinaryFile(fileName, *data);
+    }
+
+    /* Returns true if a read went past the end of the buffer. */
+    bool hasFailed() { return failed; }
+
+    /* Returns true if all bytes of the buffer were already read. */
+    bool isAtEnd() { return readPosition >= data->size(); }
+
+    size_t getSize() { return data->size(); }
+    size_t getReadPosition() { return readPosition; }
+    std::vector<char> *getData() { return data; }
+
+protected:
+
+    /* The bytes of the buffer. */
+    std::vector<char> *data;
+
+    /* Index of the next byte to be read. */
+    size_t readPosition;
+
+    /* Indicates that a read has gone past the end of the buffer. */
+    bool failed;
+};
@@ -1,5 +1,15 @@
 #include "FileIO.h"
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
 std::vector<std::string> FileIO::readTextFile(std::string fileName) {
     std::vector<std::string> lines = std::vector<std::string>();
     std::ifstream file;
@@ -30,4 +40,159 @@ bool FileIO::fileExists(const std::string &filePath) {
     std::ifstream file;
     file.open(filePath);
     return file.is_open();
-}
\ No newline at end of file
+}
+
+bool FileIO::getFileStatus(const std::string &filePath, long long &size, long long &modificationTime) {
+    struct stat fileStat;
+    if (stat(filePath.c_str(), &fileStat) != 0) return false;
+    size = (long long) fileStat.st_size;
+    modificationTime = (long long) fileStat.st_mtime;
+    return true;
+}
+
+bool FileIO::readBinaryFile(const std::string &fileName, std::vector<char> &data) {
+    data.clear();
+    std::ifstream file;
+    file.open(fileName, std::ios::in | std::ios::binary);
+    if (!file.is_open()) return false;
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    if (size < 0) return false;
+    file.seekg(0, std::ios::beg);
+    data.resize((size_t) size);
+    if (size > 0) {
+        file.read(&data[0], size);
+    }
+    bool success = !file.fail();
+    file.close();
+    if (!success) data.clear();
+    return success;
+}
+
+bool FileIO::writeBinaryFile(const std::string &fileName, const char *data, size_t size) {
+    std::string tempFileName = fileName + ".tmp";
+    std::ofstream file;
+    file.open(tempFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    if (size > 0) {
+        file.write(data, size);
+    }
+    bool success = !file.fail();
+    file.close();
+    if (success) {
+        // rename() won't replace an existing file on every platform, so remove the old one first
+        std::remove(fileName.c_str());
+        success = std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+    }
+    if (!success) {
+        std::remove(tempFileName.c_str());
+    }
+    return success;
+}
+
+MappedFile::MappedFile(void) {
+    this->opened = false;
+    this->data = nullptr;
+    this->size = 0;
+    this->mappedData = nullptr;
+    this->fileHandle = nullptr;
+    this->mappingHandle = nullptr;
+}
+
+MappedFile::~MappedFile(void) {
+    close();
+}
+
+bool MappedFile::open(const std::string &fileName) {
+    close();
+    if (!map(fileName)) {
+        // Empty files can't be mapped, and the mapping may fail for other reasons, so just read the file instead
+        if (!FileIO::readBinaryFile(fileName, fallbackData)) return false;
+        this->data = fallbackData.empty() ? nullptr : &fallbackData[0];
+        this->size = fallbackData.size();
+    }
+    this->opened = true;
+    return true;
+}
+
+void MappedFile::close() {
+    unmap();
+    std::vector<char>().swap(fallbackData);
+    data = nullptr;
+    size = 0;
+    opened = false;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::map(const std::string &fileName) {
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        CloseHandle(file);
+        return false;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    mappedData = (const char*) view;
+    data = mappedData;
+    size = (size_t) fileSize.QuadPart;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (mappedData != nullptr) {
+        UnmapViewOfFile(mappedData);
+        mappedData = nullptr;
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle((HANDLE) mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != nullptr) {
+        CloseHandle((HANDLE) fileHandle);
+        fileHandle = nullptr;
+    }
+}
+
+#else
+
+bool MappedFile::map(const std::string &fileName) {
+    int file = ::open(fileName.c_str(), O_RDONLY);
+    if (file < 0) return false;
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+        ::close(file);
+        return false;
+    }
+    void *view = mmap(nullptr, (size_t) fileStat.st_size, PROT_READ, MAP_SHARED, file, 0);
+    // The mapping keeps its own reference to the file
+    ::close(file);
+    if (view == MAP_FAILED) return false;
+    mappedData = (const char*) view;
+    data = mappedData;
+    size = (size_t) fileStat.st_size;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (mappedData != nullptr) {
+        munmap((void*) mappedData, size);
+        mappedData = nullptr;
+    }
+}
+
+#endif
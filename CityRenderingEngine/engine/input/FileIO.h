@@ -9,6 +9,7 @@
 #pragma once
 
 #include <cstdlib>
+#include <cstdio>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -34,8 +35,72 @@ public:
     /* Returns true if a file already exists, or false otherwise. */
     static bool fileExists(const std::string &filePath);
 
+    /*
+     * Gets the size and the last modification time of a file, in seconds since the epoch. Returns false if the file
+     * doesn't exist. Used to check if a file derived from another is still up to date.
+     */
+    static bool getFileStatus(const std::string &filePath, long long &size, long long &modificationTime);
+
+    /*
+     * Reads the whole contents of a binary file into data, replacing anything it had before. Returns false if the file
+     * cannot be opened or read.
+     */
+    static bool readBinaryFile(const std::string &fileName, std::vector<char> &data);
+
+    /*
+     * Writes size bytes from data to a binary file, replacing it if it already exists. The file is first written with
+     * a temporary name and then renamed, so a crash in the middle of the write never leaves a truncated file behind.
+     * Returns true if the file was written successfully.
+     */
+    static bool writeBinaryFile(const std::string &fileName, const char *data, size_t size);
+
 private:
 
     FileIO(void) {}
     ~FileIO(void) {}
+};
+
+/*
+ * A read only view of a whole file, mapped into memory by the OS instead of copied into a buffer, so parsers can read
+ * it directly. If the file can't be mapped (an empty file, for example), its contents are read into memory instead, so
+ * the users of this class don't need to handle both cases. The data is NOT null terminated.
+ */
+class MappedFile {
+public:
+
+    MappedFile(void);
+    ~MappedFile(void);
+
+    /* Maps the file, closing the current one first. Returns false if the file can't be opened. */
+    bool open(const std::string &fileName);
+
+    /* Unmaps the file. The pointer returned by getData() is no longer valid after this. */
+    void close();
+
+    bool isOpen() { return opened; }
+    const char *getData() { return data; }
+    size_t getSize() { return size; }
+
+private:
+
+    /* Not copyable, the mapping is released by the destructor. */
+    MappedFile(const MappedFile &copy);
+    MappedFile &operator=(const MappedFile &copy);
+
+    /* Maps the file with the OS. Returns false if it can't be mapped. */
+    bool map(const std::string &fileName);
+    void unmap();
+
+    bool opened;
+    const char *data;
+    size_t size;
+
+    /* The mapped view of the file, null if the file wasn't mapped. */
+    const char *mappedData;
+    /* The OS handles of the file and of its mapping (only used on Windows), null if not mapped. */
+    void *fileHandle;
+    void *mappingHandle;
+
+    /* Holds the contents of the file when it couldn't be mapped. */
+    std::vector<char> fallbackData;
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+/*
+ * Description: An axis aligned bounding box, defined by its minimum and maximum corners. It's used by the culling
+ * hierarchy to test whole groups of entities against the view Frustum at once. A new box is empty, and grows to fit
+ * every point or box added to it.
+ */
+
+#pragma once
+
+#include "Common.h"
+#include "Vector3.h"
+
+class BoundingBox {
+public:
+
+    BoundingBox(void) {
+        minPos = Vector3((float) MAX_INT, (float) MAX_INT, (float) MAX_INT);
+        maxPos = Vector3((float) -MAX_INT, (float) -MAX_INT, (float) -MAX_INT);
+    }
+
+    BoundingBox(const Vector3 &minPos, const Vector3 &maxPos) {
+        this->minPos = minPos;
+        this->maxPos = maxPos;
+    }
+
+    /* The corners of the box. If any coordinate of minPos is greater than the one of maxPos, the box is empty. */
+    Vector3 minPos;
+    Vector3 maxPos;
+
+    bool isEmpty() const { return minPos.x > maxPos.x || minPos.y > maxPos.y || minPos.z > maxPos.z; }
+
+    Vector3 getCentre() const { return (minPos + maxPos) * 0.5f; }
+    Vector3 getSize() const { return maxPos - minPos; }
+
+    /* Grows the box to contain point. */
+    void addPoint(const Vector3 &point) {
+        minPos.x = min(minPos.x, point.x);
+        minPos.y = min(minPos.y, point.y);
+        minPos.z = min(minPos.z, point.z);
+        maxPos.x = max(maxPos.x, point.x);
+        maxPos.y = max(maxPos.y, point.y);
+        maxPos.z = max(maxPos.z, point.z);
+    }
+
+    /* Grows the box to contain another box. Empty boxes are ignored. */
+    void addBox(const BoundingBox &box) {
+        if (box.isEmpty()) return;
+        addPoint(box.minPos);
+        addPoint(box.maxPos);
+    }
+
+    /* Returns true if the XZ projection of this box completely contains the XZ projection of box. */
+    bool containsXZ(const BoundingBox &box) const {
+        return box.minPos.x >= minPos.x && box.maxPos.x <= maxPos.x &&
+            box.minPos.z >= minPos.z && box.maxPos.z <= maxPos.z;
+    }
+};
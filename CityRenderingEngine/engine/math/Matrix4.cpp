@@ -27,6 +27,11 @@ Matrix4::Matrix4(const Matrix4 &copy) {
     memcpy(this->values, copy.values, 16 * sizeof(float));
 }
 
+Matrix4 &Matrix4::operator=(const Matrix4 &other) {
+    memcpy(this->values, other.values, 16 * sizeof(float));
+    return *this;
+}
+
 Matrix4::Matrix4(float elements[16]) {
     memcpy(this->values, elements, 16 * sizeof(float));
 }
@@ -206,6 +211,35 @@ Matrix4 Matrix4::Translation(const Vector3 &translation) {
     return m;
 }
 
+Matrix4 Matrix4::Transform(const Vector3 &position, const Vector3 &degrees, const Vector3 &scale) {
+    float cosX = cos((float) toRadians(degrees.x));
+    float sinX = sin((float) toRadians(degrees.x));
+    float cosY = cos((float) toRadians(degrees.y));
+    float sinY = sin((float) toRadians(degrees.y));
+    float cosZ = cos((float) toRadians(degrees.z));
+    float sinZ = sin((float) toRadians(degrees.z));
+    Matrix4 m;
+
+    // Each column of the rotation is multiplied by its scale
+    m.values[0] = cosY * cosZ * scale.x;
+    m.values[1] = (cosX * sinZ + sinX * sinY * cosZ) * scale.x;
+    m.values[2] = (sinX * sinZ - cosX * sinY * cosZ) * scale.x;
+
+    m.values[4] = -cosY * sinZ * scale.y;
+    m.values[5] = (cosX * cosZ - sinX * sinY * sinZ) * scale.y;
+    m.values[6] = (sinX * cosZ + cosX * sinY * sinZ) * scale.y;
+
+    m.values[8] = sinY * scale.z;
+    m.values[9] = -sinX * cosY * scale.z;
+    m.values[10] = cosX * cosY * scale.z;
+
+    m.values[12] = position.x;
+    m.values[13] = position.y;
+    m.values[14] = position.z;
+
+    return m;
+}
+
 Matrix4 Matrix4::inverse(const Matrix4 &input) {
     // Inversion by Cramer's rule.  Code taken from an Intel publication
     double result[4][4];
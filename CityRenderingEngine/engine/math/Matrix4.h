@@ -31,6 +31,8 @@ public:
     Matrix4(float elements[16]);
     ~Matrix4(void);
 
+    Matrix4 &operator=(const Matrix4 &other);
+
     /* The array that contains the values of the matrix. */
     float values[16];
 
@@ -104,6 +106,12 @@ public:
     /* Creates a translation matrix, with 'translation' vector at floats 12 13, and 14. Analogous to glTranslatef. */
     static Matrix4 Translation(const Vector3 &translation);
 
+    /*
+     * Creates the transform of an Entity: Translation(position) * the rotations around X, Y and Z by degrees, in this
+     * order * Scale(scale). The same result as multiplying all of them, but built straight from the sines and cosines.
+     */
+    static Matrix4 Transform(const Vector3 &position, const Vector3 &degrees, const Vector3 &scale);
+
     /* Returns a inversed copy of the matrix. */
     static Matrix4 inverse(const Matrix4 &input);
 
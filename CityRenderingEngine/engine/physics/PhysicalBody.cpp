@@ -2,14 +2,14 @@
 
 PhysicalBody::PhysicalBody(void) {
 	mass = 1.0f;
-	position = new Vector3(0, 0, 0);
-	lastPosition = new Vector3(0, 0, 0);
-	rotation = new Vector3(0, 0, 0);
-	scale = new Vector3(1, 1, 1);
-	force = new Vector3(0, 0, 0);
+	position = Vector3(0, 0, 0);
+	lastPosition = Vector3(0, 0, 0);
+	rotation = Vector3(0, 0, 0);
+	scale = Vector3(1, 1, 1);
+	force = Vector3(0, 0, 0);
 	elasticity = 1.0f;
 	dragFactor = 0.0f;
-	collisionBodies = new std::vector<CollisionBody*>();
+	collisionBodies = NULL;
 	moveable = true;
 	collisionGroup = 0;
 	entity = NULL;
@@ -18,14 +18,17 @@ PhysicalBody::PhysicalBody(void) {
 
 PhysicalBody::PhysicalBody(const PhysicalBody &copy) {
 	mass = copy.mass;
-	position = new Vector3(*(copy.position));
-	lastPosition = new Vector3(*(copy.lastPosition));
-	rotation = new Vector3(*(copy.rotation));
-	scale = new Vector3(*(copy.scale));
-	force = new Vector3(*(copy.force));
+	position = copy.position;
+	lastPosition = copy.lastPosition;
+	rotation = copy.rotation;
+	scale = copy.scale;
+	force = copy.force;
 	elasticity = copy.elasticity;
 	dragFactor = copy.dragFactor;
-	collisionBodies = new std::vector<CollisionBody*>(*(copy.collisionBodies));
+	collisionBodies = NULL;
+	if (copy.collisionBodies != NULL) {
+		collisionBodies = new std::vector<CollisionBody*>(*(copy.collisionBodies));
+	}
 	moveable = copy.moveable;
 	collisionGroup = copy.collisionGroup;
 	entity = copy.entity;
@@ -34,14 +37,14 @@ PhysicalBody::PhysicalBody(const PhysicalBody &copy) {
 
 PhysicalBody::PhysicalBody(Entity *entity, float mass, Vector3 &position) {
 	this->mass = mass;
-	this->position = new Vector3(position);
-	this->lastPosition = new Vector3(position);
-	this->rotation = new Vector3(0, 0, 0);
-	this->scale = new Vector3(1, 1, 1);
-	this->force = new Vector3(0, 0, 0);
+	this->position = position;
+	this->lastPosition = position;
+	this->rotation = Vector3(0, 0, 0);
+	this->scale = Vector3(1, 1, 1);
+	this->force = Vector3(0, 0, 0);
 	this->elasticity = 1.0f;
 	this->dragFactor = 0.0f;
-	this->collisionBodies = new std::vector<CollisionBody*>();
+	this->collisionBodies = NULL;
 	this->moveable = true;
 	this->collisionGroup = 0;
 	this->entity = entity;
@@ -49,35 +52,34 @@ PhysicalBody::PhysicalBody(Entity *entity, float mass, Vector3 &position) {
 }
 
 PhysicalBody::~PhysicalBody(void) {
-	delete position;
-	position = NULL;
-	delete lastPosition;
-	lastPosition = NULL;
-	delete rotation;
-	rotation = NULL;
-	delete scale;
-	scale = NULL;
-	delete force;
-	force = NULL;
-	for (unsigned i = 0; i < collisionBodies->size(); i++) {
-		delete (*collisionBodies)[i];
+	if (collisionBodies != NULL) {
+		for (unsigned i = 0; i < collisionBodies->size(); i++) {
+			delete (*collisionBodies)[i];
+		}
+		collisionBodies->clear();
+		delete collisionBodies;
+		collisionBodies = NULL;
 	}
-	collisionBodies->clear();
-	delete collisionBodies;
-	collisionBodies = NULL;
 	entity = NULL;
 }
 
 PhysicalBody &PhysicalBody::operator=(const PhysicalBody &other) {
 	mass = other.mass;
-	*position = *(other.position);
-	*lastPosition = *(other.lastPosition);
-	*rotation = *(other.rotation);
-	*scale = *(other.scale);
-	*force = *(other.force);
+	position = other.position;
+	lastPosition = other.lastPosition;
+	rotation = other.rotation;
+	scale = other.scale;
+	force = other.force;
 	elasticity = other.elasticity;
 	dragFactor = other.dragFactor;
-	*collisionBodies = *(other.collisionBodies);
+	if (other.collisionBodies != NULL) {
+		if (collisionBodies == NULL) {
+			collisionBodies = new std::vector<CollisionBody*>();
+		}
+		*collisionBodies = *(other.collisionBodies);
+	} else if (collisionBodies != NULL) {
+		collisionBodies->clear();
+	}
 	moveable = other.moveable;
 	collisionGroup = other.collisionGroup;
 	entity = other.entity;
@@ -91,7 +93,7 @@ void PhysicalBody::update(float millisElapsed) {
 
 void PhysicalBody::integrateNextFrame(float millisElapsed) {
 	float deltaT = (float) (millisElapsed / 1000.0f);
-	setPosition(*position + (*position - *lastPosition) + (getTotalAcceleration(deltaT * 1000.0f) * (deltaT * deltaT)));
+	setPosition(position + (position - lastPosition) + (getTotalAcceleration(deltaT * 1000.0f) * (deltaT * deltaT)));
 }
 
 bool PhysicalBody::isAtRest(float millisElapsed) {
@@ -105,19 +107,19 @@ bool PhysicalBody::isAtRest(float millisElapsed) {
 }
 
 void PhysicalBody::setVelocity(Vector3 &velocity, float millisElapsed) {
-	*(this->lastPosition) = *(this->position) + Vector3(velocity.inverse() * millisElapsed / 1000.0f);
+	this->lastPosition = this->position + Vector3(velocity.inverse() * millisElapsed / 1000.0f);
 }
 
 Vector3 PhysicalBody::getVelocity(float millisElapsed) {
-	return Vector3((*position - *lastPosition) / (millisElapsed / 1000.0f));
+	return Vector3((position - lastPosition) / (millisElapsed / 1000.0f));
 }
 
 void PhysicalBody::setAcceleration(Vector3 &acceleration) {
-	*force = acceleration * mass; // F = ma
+	force = acceleration * mass; // F = ma
 }
 
 Vector3 PhysicalBody::getAcceleration() {
-	return Vector3(*force / mass); // a = F/m
+	return Vector3(force / mass); // a = F/m
 }
 
 Vector3 PhysicalBody::getTotalAcceleration(float millisElapsed) {
@@ -133,7 +135,7 @@ Vector3 PhysicalBody::getTotalAcceleration(float millisElapsed) {
 	}
 	dragForce.invert(); // Invert it so it slows the body down instead of accelerating it
 	// Calculates and returns total force acting on this body
-	Vector3 outForce = Vector3(*force);
+	Vector3 outForce = Vector3(force);
 	if (outForce.getLength() < 0.01f) {
 		outForce = Vector3(0, 0, 0);
 	}
@@ -141,6 +143,7 @@ Vector3 PhysicalBody::getTotalAcceleration(float millisElapsed) {
 }
 
 void PhysicalBody::checkCollision(PhysicalBody *body1, PhysicalBody *body2, float deltaT) {
+	if (!body1->isCollideable() || !body2->isCollideable()) return;
 	for (unsigned i = 0; i < body1->collisionBodies->size(); i++) {
 		CollisionBody *colBody1 = (*(body1->collisionBodies))[i];
 		for (unsigned j = 0; j < body2->collisionBodies->size(); j++) {
@@ -177,8 +180,8 @@ void PhysicalBody::checkCollision(PhysicalBody *body1, PhysicalBody *body2, floa
 					vel1 = body1Vel + (result.normal * (impulse / swappedBody1->mass));
 					vel2 = body2Vel - (result.normal * (impulse / swappedBody2->mass));
 					// Correct the inconsistency moving the bodies away from each other, then apply final velocity
-					swappedBody1->setPosition((*(swappedBody1->position) + ((vel1 + (result.normal * (1.0f + (result.penetration / 2.0f)))) * (float) deltaT)));
-					swappedBody2->setPosition((*(swappedBody2->position) + ((vel2 - (result.normal * (1.0f + (result.penetration / 2.0f)))) * (float) deltaT)));
+					swappedBody1->setPosition((swappedBody1->position + ((vel1 + (result.normal * (1.0f + (result.penetration / 2.0f)))) * (float) deltaT)));
+					swappedBody2->setPosition((swappedBody2->position + ((vel2 - (result.normal * (1.0f + (result.penetration / 2.0f)))) * (float) deltaT)));
 					swappedBody1->setVelocity(vel1, deltaT * 1000.0f);
 					swappedBody2->setVelocity(vel2, deltaT * 1000.0f);
 				} else {
@@ -188,7 +191,7 @@ void PhysicalBody::checkCollision(PhysicalBody *body1, PhysicalBody *body2, floa
 					impulse = Vector3::dot(body1Vel, result.normal) * (-1.0f * (1 + elasticity)) / (normalDot * (1.0f / swappedBody1->mass));
 					vel1 = (result.normal * (impulse / swappedBody1->mass));
 					// Correct the inconsistency moving the sphere away from the other static body
-					swappedBody1->setPosition((*(swappedBody1->position) + ((vel1 + (result.normal * (1.0f - (result.penetration / 2.0f)))) * (float) deltaT)));
+					swappedBody1->setPosition((swappedBody1->position + ((vel1 + (result.normal * (1.0f - (result.penetration / 2.0f)))) * (float) deltaT)));
 					swappedBody1->setVelocity(body1Vel + vel1, deltaT * 1000.0f);
 				}
 			}
@@ -197,6 +200,10 @@ void PhysicalBody::checkCollision(PhysicalBody *body1, PhysicalBody *body2, floa
 }
 
 void PhysicalBody::addCollisionBody(CollisionBody *colBody) {
+	// The list is only created for the bodies that actually collide
+	if (collisionBodies == NULL) {
+		collisionBodies = new std::vector<CollisionBody*>();
+	}
 	collisionBodies->emplace_back(colBody);
 	//Matrix4 rotMatrix = Matrix4::Rotation(rotation->x, Vector3(1, 0, 0)) * Matrix4::Rotation(rotation->y, Vector3(0, 1, 0)) * Matrix4::Rotation(rotation->z, Vector3(0, 0, 1));
 	//Matrix4 transform = Matrix4::Translation(getAbsolutePosition()) * rotMatrix;
@@ -207,8 +214,12 @@ void PhysicalBody::removeCollisionBody(CollisionBody *colBody) {
 	//collisionBodies->erase(std::remove(collisionBodies->begin(), collisionBodies->end(), colBody), collisionBodies->end());
 }
 
+bool PhysicalBody::isCollideable() {
+	return collisionBodies != NULL && !collisionBodies->empty();
+}
+
 Vector3 PhysicalBody::getAbsolutePosition() {
-	Vector3 absPos = Vector3(*position);
+	Vector3 absPos = Vector3(position);
 	if (entity != NULL && entity->getParent() != NULL) {
 		//absPos += entity->getParent()->getPhysicalBody()->getAbsolutePosition();
 	}
@@ -216,7 +227,7 @@ Vector3 PhysicalBody::getAbsolutePosition() {
 }
 
 Vector3 PhysicalBody::getAbsoluteScale() {
-	Vector3 absScale = Vector3(*scale);
+	Vector3 absScale = Vector3(scale);
 	if (entity != NULL && entity->getParent() != NULL) {
 		//absScale += entity->getParent()->getPhysicalBody()->getAbsoluteScale();
 	}
@@ -224,9 +235,9 @@ Vector3 PhysicalBody::getAbsoluteScale() {
 }
 
 void PhysicalBody::setPosition(Vector3 &position) {
-	*(this->lastPosition) = *(this->position);
-	*(this->position) = position;
-	if (collisionBodies->size() > 0) {
+	this->lastPosition = this->position;
+	this->position = position;
+	if (isCollideable()) {
 		// If we have collision bodies, calculate their absolute position
 		// This is done here to speed up collision detection later
 		//Matrix4 rotMatrix = Matrix4::Rotation(rotation->x, Vector3(1, 0, 0)) * Matrix4::Rotation(rotation->y, Vector3(0, 1, 0)) * Matrix4::Rotation(rotation->z, Vector3(0, 0, 1));
@@ -56,24 +56,24 @@ public:
 
 	/* General getters and setters */
 	void setPosition(Vector3 &position);
-	Vector3 *getPosition() { return position; }
+	Vector3 *getPosition() { return &position; }
 	/* Returns the position of this body relative to the world, not to its parent */
 	Vector3 getAbsolutePosition();
-	void setLastPosition(Vector3 &lastPosition) { *(this->lastPosition) = lastPosition; }
-	Vector3 *getLastPosition() { return lastPosition; }
-	void setRotation(Vector3 &rotation) { *(this->rotation) = rotation; }
-	Vector3 *getRotation() { return rotation; }
-	void setScale(Vector3 &scale) { *(this->scale) = scale; }
-	Vector3 *getScale() { return scale; }
+	void setLastPosition(Vector3 &lastPosition) { this->lastPosition = lastPosition; }
+	Vector3 *getLastPosition() { return &lastPosition; }
+	void setRotation(Vector3 &rotation) { this->rotation = rotation; }
+	Vector3 *getRotation() { return &rotation; }
+	void setScale(Vector3 &scale) { this->scale = scale; }
+	Vector3 *getScale() { return &scale; }
 	/* Returns the scale of this body relative to the world, not to its parent */
 	Vector3 getAbsoluteScale();
-	void setForce(Vector3 &force) { *(this->force) = force; }
-	void addForce(Vector3 &force) { *(this->force) += force; }
-	Vector3 *getForce() { return force; }
+	void setForce(Vector3 &force) { this->force = force; }
+	void addForce(Vector3 &force) { this->force += force; }
+	Vector3 *getForce() { return &force; }
 	void setMass(float mass) { this->mass = mass; }
 	float getMass() { return mass; }
 	/* Returns true of the body has moved since the last frame, false otherwise */
-	bool hasMoved() { return *lastPosition != *position; }
+	bool hasMoved() { return lastPosition != position; }
 	void setElasticity(float elasticity) { this->elasticity = elasticity; }
 	float getElasticity() { return elasticity; }
 	void setDragFactor(float dragFactor) { this->dragFactor = dragFactor; }
@@ -87,6 +87,7 @@ public:
 	Vector3 getTotalAcceleration(float millisElapsed); // Acceleration of the external forces AND gravity and drag
 	void setCanMove(bool canMove) { this->moveable = canMove; }
 	bool canMove() { return moveable; }
+	/* Returns the collision bodies of this body, or null if it never had any */
 	std::vector<CollisionBody*> *getCollisionBodies() { return collisionBodies; }
 	void addCollisionBody(CollisionBody *colBody);
 	void removeCollisionBody(CollisionBody *colBody);
@@ -113,15 +114,15 @@ public:
 protected:
 	
 	// World position of the body. Defaults to (0, 0, 0)
-	Vector3 *position;
+	Vector3 position;
 	// World position of the body in the previous frame. Defaults to (0, 0, 0)
-	Vector3 *lastPosition;
+	Vector3 lastPosition;
 	// World rotation of the body. Defaults to (0, 0, 0)
-	Vector3 *rotation;
+	Vector3 rotation;
 	// Scale factor of the body. This does not influence mass directly. Defaults to (1, 1, 1)
-	Vector3 *scale;
+	Vector3 scale;
 	// Sum of external forces applied to the body. Defaults to (0, 0, 0)
-	Vector3 *force;
+	Vector3 force;
 
 	// The mass of the body, defaults to 1.0
 	float mass;
@@ -133,7 +134,7 @@ protected:
 	bool moveable;
 	/* The collision group of this body. The body will NOT collide with other bodies of the same group */
 	int collisionGroup;
-	/* The vector of all collision bodies acting on this physical body*/
+	/* The vector of all collision bodies acting on this physical body. Only created when the first one is added */
 	std::vector<CollisionBody*> *collisionBodies;
 	/* The entity that represents this physical body */
 	Entity *entity;
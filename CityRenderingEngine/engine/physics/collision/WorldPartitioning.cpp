@@ -93,6 +93,8 @@ void WorldPartitioning::initializeArray() {
 }
 
 void WorldPartitioning::addPhysicalBody(PhysicalBody *body) {
+	// Bodies without collision bodies never collide, so they aren't in any partition
+	if (!body->isCollideable()) return;
 	bool hasPlane = false;
 	Vector3 minBodyPos = Vector3(0, 0, 0);
 	Vector3 maxBodyPos = Vector3(0, 0, 0);
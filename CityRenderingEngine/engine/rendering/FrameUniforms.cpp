@@ -0,0 +1,30 @@
+#include "FrameUniforms.h"
+
+const char *FrameUniforms::BLOCK_NAME = "FrameData";
+
+void FrameUniforms::update(const FrameData &data) {
+    if (buffer == 0) {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, buffer);
+    } else {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    }
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void FrameUniforms::unload() {
+    if (buffer != 0) {
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+}
+
+void FrameUniforms::bindBlock(GLuint program) {
+    GLuint blockIndex = glGetUniformBlockIndex(program, BLOCK_NAME);
+    if (blockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, blockIndex, BINDING_POINT);
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ * Description: A uniform buffer with the data that's the same for every Shader during a frame: the camera matrices
+ * and position, the light source and the fog. The Scene fills it once per frame, and every Shader that declares the
+ * FrameData block reads it from the same binding point, so switching Shaders doesn't need to upload anything.
+ * Only the data that changes per object, like the model matrix, is still set with individual uniforms.
+ *
+ * FrameData follows the std140 layout, so it must match the FrameData block declared in the shaders exactly, and any
+ * change here must be made to all of them as well.
+ */
+
+#pragma once
+
+#include <GL/glew.h>
+#include "../math/Matrix4.h"
+#include "../math/Vector4.h"
+
+/* The contents of the uniform buffer. Every member is a multiple of a vec4, so there's no std140 padding. */
+struct FrameData {
+    Matrix4 viewMatrix;
+    Matrix4 projMatrix;
+    Matrix4 viewProjMatrix;
+    /* The camera position, in world space. w is unused. */
+    Vector4 cameraPosition;
+    /* The light source: position and radius, direction and intensity, colour and type. */
+    Vector4 lightPosition;
+    Vector4 lightDirection;
+    Vector4 lightColour;
+    /* The fog colour, and the distances where the fog starts and where it's complete, on x and y. */
+    Vector4 fogColour;
+    Vector4 fogDistance;
+};
+
+static_assert(sizeof(FrameData) == 3 * 64 + 6 * 16, "FrameData must match the std140 layout of the shader block");
+
+class FrameUniforms {
+public:
+
+    /* The uniform buffer binding point used by the FrameData block. */
+    static const GLuint BINDING_POINT = 0;
+
+    /* The name of the uniform block in the shaders. */
+    static const char *BLOCK_NAME;
+
+    FrameUniforms(void) { buffer = 0; }
+    ~FrameUniforms(void) {}
+
+    /* Uploads data to the buffer, creating it on the first call. MUST ONLY be called from the render thread. */
+    void update(const FrameData &data);
+
+    /* Deletes the buffer. This function MUST ONLY be called from the render thread. */
+    void unload();
+
+    /* Binds the FrameData block of program, if it has one, to BINDING_POINT. Called when a Shader is linked. */
+    static void bindBlock(GLuint program);
+
+protected:
+
+    GLuint buffer;
+};
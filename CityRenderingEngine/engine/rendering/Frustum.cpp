@@ -1,6 +1,7 @@
 #include "Frustum.h"
 
 Frustum::Frustum(const Matrix4 &mvp) {
+    nodesVisited = objectsDrawn = lastFrameNodesVisited = lastFrameObjectsDrawn = 0;
     updateMatrix(mvp);
 }
 
@@ -10,6 +11,12 @@ void Frustum::updateMatrix(const Matrix4 &mvp) {
     Vector3 zaxis = Vector3(mvp.values[2], mvp.values[6], mvp.values[10]);
     Vector3 waxis = Vector3(mvp.values[3], mvp.values[7], mvp.values[11]);
 
+    // The matrix is updated once per frame, so this is where the counters of the last frame are closed
+    lastFrameNodesVisited = nodesVisited;
+    lastFrameObjectsDrawn = objectsDrawn;
+    nodesVisited = 0;
+    objectsDrawn = 0;
+
     // Right plane
     planes[0] = Plane(waxis - xaxis, (mvp.values[15] - mvp.values[12]), true);
     // Left plane
@@ -31,4 +38,45 @@ bool Frustum::isEntityInside(Entity *entity) {
         }
     }
     return true;
+}
+
+FrustumTest Frustum::testSphere(const Vector3 &centre, float radius, unsigned char &planeMask) {
+    nodesVisited++;
+    FrustumTest result = FRUSTUM_INSIDE;
+    for (int p = 0; p < 6; p++) {
+        unsigned char planeBit = 1 << p;
+        if ((planeMask & planeBit) == 0) continue; // A parent is already completely inside this plane
+        float distance = Vector3::dot(centre, planes[p].getNormal()) + planes[p].getDistance();
+        if (distance < -radius) {
+            return FRUSTUM_OUTSIDE;
+        } else if (distance >= radius) {
+            planeMask &= ~planeBit;
+        } else {
+            result = FRUSTUM_INTERSECTS;
+        }
+    }
+    return result;
+}
+
+FrustumTest Frustum::testBox(const BoundingBox &box, unsigned char &planeMask) {
+    nodesVisited++;
+    FrustumTest result = FRUSTUM_INSIDE;
+    for (int p = 0; p < 6; p++) {
+        unsigned char planeBit = 1 << p;
+        if ((planeMask & planeBit) == 0) continue;
+        Vector3 normal = planes[p].getNormal();
+        // The corners farthest along and against the normal of the plane
+        Vector3 positive = Vector3(normal.x >= 0 ? box.maxPos.x : box.minPos.x,
+            normal.y >= 0 ? box.maxPos.y : box.minPos.y, normal.z >= 0 ? box.maxPos.z : box.minPos.z);
+        Vector3 negative = Vector3(normal.x >= 0 ? box.minPos.x : box.maxPos.x,
+            normal.y >= 0 ? box.minPos.y : box.maxPos.y, normal.z >= 0 ? box.minPos.z : box.maxPos.z);
+        if (Vector3::dot(positive, normal) + planes[p].getDistance() < 0) {
+            return FRUSTUM_OUTSIDE;
+        } else if (Vector3::dot(negative, normal) + planes[p].getDistance() >= 0) {
+            planeMask &= ~planeBit;
+        } else {
+            result = FRUSTUM_INTERSECTS;
+        }
+    }
+    return result;
 }
\ No newline at end of file
@@ -5,20 +5,36 @@
  * Description: This is a Frustum class, used to store the six planes that define a view frustum. This frustum will be
  * used by the Scene to check which entities are inside the camera's view and which aren't, so it can cull all entities
  * that are outside the camera's view, so they don't need to be rendered.
+ *
+ * Besides the simple test of a single Entity, it supports hierarchical culling. Each test takes a plane mask, with one
+ * bit for each plane that still needs to be tested. When a volume is completely inside a plane, that plane's bit is
+ * cleared, so the volumes inside it (like the CityBlocks of a Chunk) don't test that plane again. A volume that's
+ * completely inside all planes has an empty mask, and everything inside it is accepted without any test.
  */
 
 #pragma once
 
 #include "../math/Matrix4.h"
+#include "../math/BoundingBox.h"
 #include "../Entity.h"
 #include "Plane.h"
 
 class Entity;
 
+/* Result of testing a volume against the Frustum. */
+enum FrustumTest {
+    FRUSTUM_OUTSIDE, FRUSTUM_INTERSECTS, FRUSTUM_INSIDE
+};
+
 class Frustum {
 public:
 
-    Frustum(void) {}
+    /* Plane mask with all six planes set, used to start a hierarchical test. */
+    static const unsigned char ALL_PLANES = 0x3F;
+
+    Frustum(void) {
+        nodesVisited = objectsDrawn = lastFrameNodesVisited = lastFrameObjectsDrawn = 0;
+    }
     Frustum(const Matrix4 &mvp);
     ~Frustum(void) {}
 
@@ -28,8 +44,30 @@ public:
     /* Returns true if the entity is inside the Frustum, ie. on the positive side of all the six planes. */
     bool isEntityInside(Entity *entity);
 
+    /*
+     * Tests a sphere against the planes set on planeMask. The bits of the planes that completely contain the sphere
+     * are cleared from planeMask, which should then be passed to the tests of the volumes inside this sphere.
+     */
+    FrustumTest testSphere(const Vector3 &centre, float radius, unsigned char &planeMask);
+
+    /* Same as testSphere(), but for an axis aligned box. */
+    FrustumTest testBox(const BoundingBox &box, unsigned char &planeMask);
+
+    /* Counts an object that passed the culling and was drawn. Tested volumes are counted by the tests themselves. */
+    void addObjectDrawn() { objectsDrawn++; }
+
+    /* Returns the culling counters of the last complete frame. */
+    int getLastFrameNodesVisited() { return lastFrameNodesVisited; }
+    int getLastFrameObjectsDrawn() { return lastFrameObjectsDrawn; }
+
 protected:
 
     /* The six planes that make up the Frustum: right, left, bottom, top, far and near. */
     Plane planes[6];
+
+    /* The culling counters of the current frame, and of the last complete frame. They're reset by updateMatrix(). */
+    int nodesVisited;
+    int objectsDrawn;
+    int lastFrameNodesVisited;
+    int lastFrameObjectsDrawn;
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "InstanceBatch.h"
+
+const ShaderParameterHandle InstanceBatch::INSTANCED_PARAMETER = ShaderParameter::getHandle("instanced");
+
+InstanceBatch::InstanceBatch(Model *model) {
+    this->model = model;
+    if (this->model != nullptr) {
+        this->model->addUser();
+    }
+    this->instances = new std::vector<InstanceData>();
+    this->instanceBuffer = 0;
+    this->changed = false;
+}
+
+InstanceBatch::~InstanceBatch(void) {
+    if (model != nullptr) {
+        ResourcesManager::releaseResource(model->getName());
+        model = nullptr;
+    }
+    if (instances != nullptr) {
+        delete instances;
+        instances = nullptr;
+    }
+}
+
+void InstanceBatch::clear() {
+    if (!instances->empty()) {
+        instances->clear();
+        changed = true;
+    }
+}
+
+void InstanceBatch::addInstance(const Matrix4 &modelMatrix, const Vector4 &params) {
+    InstanceData instance;
+    instance.modelMatrix = modelMatrix;
+    instance.params = params;
+    instances->push_back(instance);
+    changed = true;
+}
+
+void InstanceBatch::draw(Shader *shader, bool withMaterial) {
+    if (model == nullptr || shader == nullptr || instances->empty()) return;
+    if (changed || instanceBuffer == 0) {
+        if (instanceBuffer == 0) {
+            glGenBuffers(1, &instanceBuffer);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, instances->size() * sizeof(InstanceData), &(*instances)[0], GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        changed = false;
+    }
+    setInstanced(shader, 1);
+    model->drawInstanced(instanceBuffer, (int) instances->size(), withMaterial);
+    setInstanced(shader, 0);
+}
+
+void InstanceBatch::unload() {
+    if (instanceBuffer != 0) {
+        glDeleteBuffers(1, &instanceBuffer);
+        instanceBuffer = 0;
+        changed = true;
+    }
+}
+
+void InstanceBatch::setInstanced(Shader *shader, int instanced) {
+    ShaderParameter *parameter = shader->getShaderParameter(INSTANCED_PARAMETER);
+    if (parameter == nullptr) {
+        // The value is owned by the parameter, and deleted with it
+        shader->addShaderParameter("instanced", PARAMETER_INT, new int(0));
+        parameter = shader->getShaderParameter(INSTANCED_PARAMETER);
+    }
+    *((int*) parameter->getValue()) = instanced;
+    parameter->setValueChanged(true);
+    shader->updateShaderParameters(false);
+}
@@ -0,0 +1,72 @@
+/*
+ * Description: An InstanceBatch draws many copies of the same Model with a single instanced draw call. Each instance
+ * has its own model matrix and four extra parameters, which are stored together in an OpenGL buffer and read by the
+ * vertex shader through the "instanceMatrix" and "instanceParams" attributes, when its "instanced" uniform is set.
+ *
+ * The instances are only kept on the CPU until the next draw, when they're uploaded to the buffer if anything changed.
+ * The buffer is kept between frames, so a batch whose instances don't change costs a single draw call per frame.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "Model.h"
+#include "Shader.h"
+#include "../math/Matrix4.h"
+#include "../math/Vector4.h"
+
+class Model;
+class Shader;
+
+/* The data of a single instance, as it's laid out in the instance buffer. */
+struct InstanceData {
+    Matrix4 modelMatrix;
+    Vector4 params;
+};
+
+class InstanceBatch {
+public:
+
+    /* Creates an empty batch of the Model. The batch keeps a user on the Model until it's deleted. */
+    InstanceBatch(Model *model);
+    ~InstanceBatch(void);
+
+    /* Removes all instances. The buffer will be updated on the next draw. */
+    void clear();
+
+    /* Adds a new instance of the Model, with its world model matrix and its extra parameters. */
+    void addInstance(const Matrix4 &modelMatrix, const Vector4 &params);
+
+    /*
+     * Uploads the instances if they changed since the last draw, and draws all of them using shader, which must be
+     * the current Shader. If withMaterial is false, the texture of the Model isn't bound (see Model::draw()). This
+     * function MUST ONLY be called from the render thread.
+     */
+    void draw(Shader *shader, bool withMaterial = true);
+
+    /* Deletes the instance buffer. This function MUST ONLY be called from the render thread. */
+    void unload();
+
+    int getNumInstances() { return (int) instances->size(); }
+    Model *getModel() { return model; }
+
+protected:
+
+    /* Sets the "instanced" uniform of shader, telling it to read the instance attributes or not. */
+    static void setInstanced(Shader *shader, int instanced);
+
+    static const ShaderParameterHandle INSTANCED_PARAMETER;
+
+    /* The Model drawn by this batch. */
+    Model *model;
+
+    /* The instances to be drawn. */
+    std::vector<InstanceData> *instances;
+
+    /* OpenGL identifier of the buffer with the instance data, or 0 if it wasn't created yet. */
+    GLuint instanceBuffer;
+
+    /* Indicates if the instances changed since they were last uploaded. */
+    bool changed;
+};
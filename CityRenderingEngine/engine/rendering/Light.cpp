@@ -45,24 +45,9 @@ Light::Light(Colour colour, Vector3 direction, float intensity) {
     this->type = LIGHT_DIRECTIONAL;
 }
 
-void Light::updateShaderParameters(Shader *shader) {
-    if (shader != nullptr) {
-        ShaderParameter *parameterPos = shader->getShaderParameter("lightSource.position");
-        if (parameterPos == nullptr) {
-            shader->addShaderParameter(new ShaderParameter("lightSource.position", PARAMETER_VECTOR_3, &position));
-            shader->addShaderParameter(new ShaderParameter("lightSource.direction", PARAMETER_VECTOR_3, &direction));
-            shader->addShaderParameter(new ShaderParameter("lightSource.colour", 
-                PARAMETER_VECTOR_3, new Vector3(colour.getColourVec3())));
-            shader->addShaderParameter(new ShaderParameter("lightSource.intensity", PARAMETER_FLOAT, &intensity));
-            shader->addShaderParameter(new ShaderParameter("lightSource.radius", PARAMETER_FLOAT, &radius));
-            shader->addShaderParameter(new ShaderParameter("lightSource.type", PARAMETER_INT, &type));
-        } else {
-            parameterPos->setValue(&position, false);
-            shader->getShaderParameter("lightSource.direction")->setValue(&direction, false);
-            shader->getShaderParameter("lightSource.colour")->setValue(new Vector3(colour.getColourVec3()), true);
-            shader->getShaderParameter("lightSource.radius")->setValue(&radius, false);
-            shader->getShaderParameter("lightSource.intensity")->setValue(&intensity, false);
-            shader->getShaderParameter("lightSource.type")->setValue(&type, false);
-        }
-    }
+void Light::updateFrameData(FrameData &data) {
+    data.lightPosition = Vector4(position.x, position.y, position.z, radius);
+    data.lightDirection = Vector4(direction.x, direction.y, direction.z, intensity);
+    Vector3 colourVec = colour.getColourVec3();
+    data.lightColour = Vector4(colourVec.x, colourVec.y, colourVec.z, (float) type);
 }
\ No newline at end of file
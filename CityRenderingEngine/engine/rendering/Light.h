@@ -10,6 +10,7 @@
 #include "../math/Vector3.h"
 #include "Colour.h"
 #include "Shader.h"
+#include "FrameUniforms.h"
 
 /* The type of the Light Source. Every light must be of one of these types. */
 enum LightType {
@@ -46,10 +47,7 @@ public:
     Light(Colour colour, Vector3 direction, float intensity);
     ~Light(void) {}
 
-    /*
-     * This function updates the Shader Parameters related to the scene lighting in the shader. If the parameters
-     * already exists, they will be only updated, but if they don't they will be created.
-     */
-    void updateShaderParameters(Shader *shader);
+    /* Writes this light source to the light members of the per-frame uniform data, read by all Shaders. */
+    void updateFrameData(FrameData &data);
 
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "LightShader.h"
+#include "../ResourceNames.h"
+#include "../ResourcesManager.h"
+#include "../Scene.h"
+
+Shader *LightShader::variants[NUM_VARIANTS] = { nullptr };
+
+Shader *LightShader::get(LightType type, LightSurface surface, bool fog) {
+    unsigned int variantKey = getVariantKey(type, surface, fog);
+    // The slots are read without the lock, so they're written atomically, once the variant is fully set up
+    Shader *shader = (Shader*) SDL_AtomicGetPtr((void**) &variants[variantKey]);
+    if (shader != nullptr) return shader;
+    ResourcesManager::lockMutex();
+    if (variants[variantKey] == nullptr) {
+        shader = Shader::getOrCreate(SHADER_LIGHT_VARIANTS + variantKey, "resources/shaders/vertNormal.glsl",
+            "resources/shaders/fragLight.glsl", getDefines(variantKey), false);
+        // Every variant is drawn with a number of floors, even if it's only to tell the vertex shader where it is
+        if (shader->getShaderParameter("numFloors") == nullptr) {
+            shader->addShaderParameter("numFloors", PARAMETER_INT, new int(0));
+        }
+        // The pointers are kept in variants, so the ResourcesManager must never release them
+        shader->addUser();
+        SDL_AtomicSetPtr((void**) &variants[variantKey], shader);
+    }
+    shader = variants[variantKey];
+    ResourcesManager::unlockMutex();
+    return shader;
+}
+
+Shader *LightShader::get(Scene *scene, LightSurface surface) {
+    Light *lightSource = scene->getLightSource();
+    LightType type = lightSource != nullptr ? lightSource->type : LIGHT_DIRECTIONAL;
+    return get(type, surface, scene->isFogEnabled());
+}
+
+unsigned int LightShader::getVariantKey(LightType type, LightSurface surface, bool fog) {
+    if (type != LIGHT_POINT && type != LIGHT_SPOT) {
+        type = LIGHT_DIRECTIONAL;
+    } else {
+        fog = false;
+    }
+    return (unsigned int) type | ((unsigned int) surface << 2) | (fog ? 8 : 0);
+}
+
+std::string LightShader::getDefines(unsigned int variantKey) {
+    std::string defines;
+    switch (variantKey & 3) {
+    case LIGHT_POINT:
+        defines += "#define LIGHT_POINT\n";
+        break;
+    case LIGHT_SPOT:
+        defines += "#define LIGHT_SPOT\n";
+        break;
+    default:
+        defines += "#define LIGHT_DIRECTIONAL\n";
+        break;
+    }
+    if (((variantKey >> 2) & 1) == LIGHT_SURFACE_GROUND) {
+        defines += "#define SURFACE_GROUND\n";
+    } else {
+        defines += "#define SURFACE_BUILDING\n";
+    }
+    if (variantKey & 8) {
+        defines += "#define FOG\n";
+    }
+    return defines;
+}
+
+void LightShader::reloadAll() {
+    for (int i = 0; i < NUM_VARIANTS; i++) {
+        if (variants[i] != nullptr && variants[i]->isLoaded()) {
+            variants[i]->reload();
+        }
+    }
+}
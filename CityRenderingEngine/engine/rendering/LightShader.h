@@ -0,0 +1,66 @@
+/*
+ * Description: The variants of the light shader (vertNormal.glsl and fragLight.glsl). The generic shader,
+ * SHADER_LIGHT_BASIC, picks the type of light and the kind of surface at runtime, for every fragment. Each variant is
+ * compiled with #defines for a single light type, a single surface and fog on or off, so it only has the code it
+ * actually uses:
+ *
+ * LIGHT_POINT, LIGHT_SPOT or LIGHT_DIRECTIONAL: the type of the Scene's light source.
+ * SURFACE_BUILDING: the uv_maps are remapped to the floors and roof of a building texture, using numFloors.
+ * SURFACE_GROUND: anything that isn't a building, like the ground and the small houses. The uv_maps are used as is.
+ * FOG: the fog is applied. Only the directional light has fog, so the other lights ignore this flag.
+ *
+ * The variants are created the first time they're asked for, and compiled when they're first used, like any other
+ * Shader. Their names are fixed (SHADER_LIGHT_VARIANTS plus the variant key), so their program binaries are reused
+ * between runs.
+ * This is an instance-less class.
+ */
+
+#pragma once
+
+#include <string>
+#include "Shader.h"
+#include "Light.h"
+
+class Scene;
+
+/* The kind of surface drawn with a light shader variant. */
+enum LightSurface {
+    LIGHT_SURFACE_BUILDING = 0,
+    LIGHT_SURFACE_GROUND = 1
+};
+
+class LightShader {
+public:
+
+    /* The number of possible variant keys: 2 bits for the light type, 1 for the surface and 1 for the fog. */
+    static const int NUM_VARIANTS = 16;
+
+    /*
+     * Returns the variant for the light type, surface and fog provided, creating it if needed. The variant isn't
+     * loaded here, but when it's first used by the Scene.
+     */
+    static Shader *get(LightType type, LightSurface surface, bool fog);
+
+    /*
+     * Returns the variant for surface that matches the light source and the fog of scene. Without a light source, the
+     * directional light variant is returned.
+     */
+    static Shader *get(Scene *scene, LightSurface surface);
+
+    /* Returns the key of a variant, from 0 to NUM_VARIANTS - 1. Variants that would be the same get the same key. */
+    static unsigned int getVariantKey(LightType type, LightSurface surface, bool fog);
+
+    /* Returns the #define lines of the variant with the key provided. */
+    static std::string getDefines(unsigned int variantKey);
+
+    /* Reloads all the variants already loaded, to account for changes in the glsl files. */
+    static void reloadAll();
+
+protected:
+
+    /* The variants created so far, indexed by their keys. They're kept until the end of the program. */
+    static Shader *variants[NUM_VARIANTS];
+
+    LightShader(void) {}
+    ~LightShader(void) {}
+};
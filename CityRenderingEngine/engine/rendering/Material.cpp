@@ -1,4 +1,5 @@
 #include "Material.h"
+#include "ObjParser.h"
 
 Material::Material(void) : Resource() {
     diffuse = Colour::WHITE;
@@ -79,115 +80,91 @@ void Material::setTexture(Texture *texture) {
 }
 
 std::vector<Material*> Material::loadMaterialsFromFile(const std::string &filename) {
-    std::vector<std::string> lines = FileIO::readTextFile(filename);
     std::vector<Material*> materials = std::vector<Material*>();
-    if (lines.size() > 0) {
-        Material *currentMaterial = nullptr;
-        // Start reading through the lines
-        for (unsigned i = 0; i < lines.size(); i++) {
-            std::string line = lines[i];
-            if (line.size() < 2) continue; // Make sure it's not an empty line
-
-            // Trim the whitespaces at the beginning of the line, if present
-            line.erase(line.begin(), std::find_if(line.begin(), line.end(), std::not1(std::ptr_fun<int, int>(std::isspace))));
-            char firstChar = line[0];
-            char secondChar = line[1];
+    MappedFile file;
+    if (!file.open(filename)) return materials;
+    const char *position = file.getData();
+    const char *end = position + file.getSize();
+    Material *currentMaterial = nullptr;
+    // Start reading through the lines
+    TextToken line;
+    while (ObjParser::readLine(position, end, line)) {
+        if (line.size() < 2) continue; // Make sure it's not an empty line
+        const char *it = line.begin;
+        TextToken keyword;
+        ObjParser::readWord(it, line.end, keyword);
 
-            switch (firstChar) {
-            case 'n':
-                // Creates a new material and sets it as the current material, pushing the current one to the vector
-                char nameC[256];
-                sscanf(line.c_str(),"%*s %s", &nameC);
-                if (currentMaterial != nullptr) {
-                    currentMaterial->loaded = true;
-                    ResourcesManager::addResource(currentMaterial, true);
-                    materials.emplace_back(currentMaterial);
-                }
-                currentMaterial = new Material();
-                currentMaterial->materialName = std::string(nameC);
-                break;
-            case 'N':
-                // Sets the Ni or Ns of the current material
-                if (currentMaterial != nullptr) {
-                    if (secondChar == 'i') {
-                        sscanf_s(line.c_str(), "Ni %f", &(currentMaterial->ni));
-                    } else if (secondChar == 's') {
-                        sscanf_s(line.c_str(), "Ns %f", &(currentMaterial->ns));
-                    }
-                }
-                break;
-            case 'd':
-                // Sets the alpha value of the current material
-                if (currentMaterial != nullptr) {
-                    sscanf_s(line.c_str(), "d %f", &(currentMaterial->alpha));
-                }
-                break;
-            case 'K':
-                // Sets the light colours of the current material
-                if (currentMaterial != nullptr) {
-                    if (secondChar == 'd') {
-                        float r, g, b;
-                        sscanf_s(line.c_str(), "Kd %f %f %f", &r, &g, &b);
-                        currentMaterial->diffuse = Colour(r, g, b, 1.0f);
-                    } else if (secondChar == 'a') {
-                        float r, g, b;
-                        sscanf_s(line.c_str(), "Ka %f %f %f", &r, &g, &b);
-                        currentMaterial->ambient = Colour(r, g, b, 1.0f);
-                    } else {
-                        float r, g, b;
-                        sscanf_s(line.c_str(), "Ks %f %f %f", &r, &g, &b);
-                        currentMaterial->specular = Colour(r, g, b, 1.0f);
-                    }
-                }
-                break;
-            case 'i':
-                // Sets the illumination value of the current material
-                if (currentMaterial != nullptr) {
-                    sscanf_s(line.c_str(), "illum %d", &(currentMaterial->illum));
-                }
-                break;
-            case 'm':
-                // Maps a texture to the current material
-                if (currentMaterial != nullptr) {
-                    char texFilename[150];
-                    sscanf(line.c_str(), "map_Kd %s", &texFilename);
-                    // TODO: think of a way to store the int name and associate it with the 6 textures in runtime
-                    currentMaterial->setTexture(Texture::getOrCreate(ResourcesManager::generateNextName(),
-                        std::string(texFilename), false));
-                }
-                break;
+        if (keyword.equals("newmtl")) {
+            // Creates a new material and sets it as the current material, pushing the current one to the vector
+            TextToken name;
+            ObjParser::readWord(it, line.end, name);
+            if (currentMaterial != nullptr) {
+                currentMaterial->loaded = true;
+                ResourcesManager::addResource(currentMaterial, true);
+                materials.emplace_back(currentMaterial);
             }
-        }
-        if (currentMaterial != nullptr) {
-            // Adds the last material to the vector
-            currentMaterial->loaded = true;
-            currentMaterial->valid = true;
-            materials.emplace_back(currentMaterial);
+            currentMaterial = new Material();
+            currentMaterial->materialName = name.toString();
+        } else if (currentMaterial == nullptr) {
+            continue;
+        } else if (keyword.equals("Ni")) {
+            ObjParser::readFloat(it, line.end, currentMaterial->ni);
+        } else if (keyword.equals("Ns")) {
+            ObjParser::readFloat(it, line.end, currentMaterial->ns);
+        } else if (keyword.equals("d")) {
+            // Sets the alpha value of the current material
+            ObjParser::readFloat(it, line.end, currentMaterial->alpha);
+        } else if (keyword.equals("Kd") || keyword.equals("Ka") || keyword.equals("Ks")) {
+            // Sets the light colours of the current material
+            float r = 0, g = 0, b = 0;
+            ObjParser::readFloat(it, line.end, r);
+            ObjParser::readFloat(it, line.end, g);
+            ObjParser::readFloat(it, line.end, b);
+            if (keyword.equals("Kd")) {
+                currentMaterial->diffuse = Colour(r, g, b, 1.0f);
+            } else if (keyword.equals("Ka")) {
+                currentMaterial->ambient = Colour(r, g, b, 1.0f);
+            } else {
+                currentMaterial->specular = Colour(r, g, b, 1.0f);
+            }
+        } else if (keyword.equals("illum")) {
+            // Sets the illumination value of the current material
+            ObjParser::readInt(it, line.end, currentMaterial->illum);
+        } else if (keyword.equals("map_Kd")) {
+            // Maps a texture to the current material
+            TextToken texFilename;
+            ObjParser::readWord(it, line.end, texFilename);
+            // TODO: think of a way to store the int name and associate it with the 6 textures in runtime
+            currentMaterial->setTexture(Texture::getOrCreate(ResourcesManager::generateNextName(),
+                texFilename.toString(), false));
         }
     }
+    if (currentMaterial != nullptr) {
+        // Adds the last material to the vector
+        currentMaterial->loaded = true;
+        currentMaterial->valid = true;
+        materials.emplace_back(currentMaterial);
+    }
     return materials;
 }
 
 bool Material::fileHasMaterial(const std::string &filename, const std::string &materialName) {
-    std::vector<std::string> lines = FileIO::readTextFile(filename);
-    if (lines.size() == 0) {
+    MappedFile file;
+    if (!file.open(filename)) {
         return false; // Material file couldn't be opened
     }
-    bool hasMaterial = false;
-    for (unsigned i = 0; i < lines.size(); i++) {
-        std::string line = lines[i];
-        if (line.size() < 2) continue; // Make sure it's not an empty line
-
-        // Trim the whitespaces at the beginning of the line, if present
-        line.erase(line.begin(), std::find_if(line.begin(), line.end(), std::not1(std::ptr_fun<int, int>(std::isspace))));
-        char firstChar = line[0];
-
-        if (firstChar == 'n') {
-            char name[256];
-            sscanf(line.c_str(),"%*s %s", &name);
-            hasMaterial = std::string(name).compare(materialName) == 0;
-            if (hasMaterial) return true; // If material is found, no need to finish reading the file
+    const char *position = file.getData();
+    const char *end = position + file.getSize();
+    TextToken line;
+    while (ObjParser::readLine(position, end, line)) {
+        const char *it = line.begin;
+        TextToken keyword;
+        ObjParser::readWord(it, line.end, keyword);
+        if (keyword.equals("newmtl")) {
+            TextToken name;
+            ObjParser::readWord(it, line.end, name);
+            if (name.equals(materialName.c_str())) return true; // If material is found, no need to finish reading the file
         }
     }
-    return hasMaterial;
+    return false;
 }
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "MeshCache.h"
+#include "../input/BinaryBuffer.h"
+
+/* Writes a string as its length followed by its characters. */
+static void writeString(BinaryBuffer &buffer, const std::string &value) {
+    buffer.write((unsigned short) value.size());
+    buffer.writeBytes(value.c_str(), value.size());
+}
+
+/* Reads a string written by writeString() from position, moving it forward. Returns false if it doesn't fit. */
+static bool readString(const char *&position, const char *end, std::string &value) {
+    unsigned short length;
+    if (end - position < (long long) sizeof(length)) return false;
+    memcpy(&length, position, sizeof(length));
+    position += sizeof(length);
+    if (end - position < (long long) length) return false;
+    value.assign(position, length);
+    position += length;
+    return true;
+}
+
+bool MeshCache::save(const std::string &sourceFileName, const MeshData &mesh,
+    const std::vector<std::string> &materialLibraries, const std::vector<std::string> &materialNames) {
+    MeshCacheHeader header;
+    // The padding of the struct is written too, so make sure it's not random memory
+    memset(&header, 0, sizeof(MeshCacheHeader));
+    if (!FileIO::getFileStatus(sourceFileName, header.sourceSize, header.sourceTime)) return false;
+    if (mesh.normals.size() != mesh.vertices.size()) return false;
+    bool hasUvMaps = mesh.uv_maps.size() == mesh.vertices.size();
+    header.magic = FILE_MAGIC;
+    header.version = FILE_VERSION;
+    header.attributes = MESH_CACHE_NORMALS | (hasUvMaps ? MESH_CACHE_UV_MAPS : 0);
+    header.numVertices = (unsigned int) mesh.vertices.size();
+    header.numIndexes = (unsigned int) mesh.indexes.size();
+    header.numMaterialLibraries = (unsigned int) materialLibraries.size();
+    header.numMaterialNames = (unsigned int) materialNames.size();
+    Vector3 centre;
+    mesh.calculateBoundingSphere(centre, header.boundsRadius);
+    header.boundsCentre[0] = centre.x;
+    header.boundsCentre[1] = centre.y;
+    header.boundsCentre[2] = centre.z;
+
+    BinaryBuffer buffer;
+    buffer.write(header);
+    for (auto it = materialLibraries.begin(); it != materialLibraries.end(); it++) {
+        writeString(buffer, *it);
+    }
+    for (auto it = materialNames.begin(); it != materialNames.end(); it++) {
+        writeString(buffer, *it);
+    }
+    // Keeps the vertex data aligned, so it can be read in place from the mapped file
+    while (buffer.getSize() % 4 != 0) {
+        buffer.write((char) 0);
+    }
+    buffer.getData()->reserve(buffer.getSize() + header.numVertices * getStride(header.attributes) +
+        header.numIndexes * sizeof(unsigned int));
+    for (unsigned int i = 0; i < header.numVertices; i++) {
+        buffer.write(mesh.vertices[i]);
+        if (hasUvMaps) buffer.write(mesh.uv_maps[i]);
+        buffer.write(mesh.normals[i]);
+    }
+    if (header.numIndexes > 0) {
+        buffer.writeBytes(&mesh.indexes[0], header.numIndexes * sizeof(unsigned int));
+    }
+    return buffer.saveToFile(getCacheFileName(sourceFileName));
+}
+
+bool MeshCache::load(const std::string &sourceFileName, MeshCacheData &cache) {
+    long long sourceSize, sourceTime;
+    if (!FileIO::getFileStatus(sourceFileName, sourceSize, sourceTime)) return false;
+    if (!cache.file.open(getCacheFileName(sourceFileName))) return false;
+    if (!readMappedFile(cache, sourceSize, sourceTime)) {
+        // Unmaps it right away, so the cache can be written again
+        cache.file.close();
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::readMappedFile(MeshCacheData &cache, long long sourceSize, long long sourceTime) {
+    const char *position = cache.file.getData();
+    const char *end = position + cache.file.getSize();
+    if (cache.file.getSize() < sizeof(MeshCacheHeader)) return false;
+    memcpy(&cache.header, position, sizeof(MeshCacheHeader));
+    position += sizeof(MeshCacheHeader);
+    const MeshCacheHeader &header = cache.header;
+    if (header.magic != FILE_MAGIC || header.version != FILE_VERSION) return false;
+    if (header.sourceSize != sourceSize || header.sourceTime != sourceTime) {
+        return false; // The source file was changed after the cache was written
+    }
+
+    if (header.numMaterialLibraries + header.numMaterialNames > (unsigned int) (end - position) / 2) return false;
+    cache.materialLibraries.resize(header.numMaterialLibraries);
+    for (unsigned int i = 0; i < header.numMaterialLibraries; i++) {
+        if (!readString(position, end, cache.materialLibraries[i])) return false;
+    }
+    cache.materialNames.resize(header.numMaterialNames);
+    for (unsigned int i = 0; i < header.numMaterialNames; i++) {
+        if (!readString(position, end, cache.materialNames[i])) return false;
+    }
+    size_t offset = position - cache.file.getData();
+    offset = (offset + 3) & ~((size_t) 3);
+
+    size_t vertexSize = (size_t) header.numVertices * getStride(header.attributes);
+    size_t indexSize = (size_t) header.numIndexes * sizeof(unsigned int);
+    if (offset + vertexSize + indexSize != cache.file.getSize()) return false;
+    cache.vertexData = cache.file.getData() + offset;
+    cache.indexData = header.numIndexes > 0 ? (const unsigned int*) (cache.vertexData + vertexSize) : nullptr;
+    return true;
+}
@@ -0,0 +1,98 @@
+/*
+ * Description: Binary cache of the meshes imported from .obj files. The first time a Model is loaded, its parsed and
+ * optimised mesh is saved next to the source file, with the ".mesh" extension added to its name. The next loads map
+ * the cache file instead, and upload its vertex and index data to the GPU straight from the mapping, so there's no
+ * parsing, normal generation or optimisation left to do.
+ *
+ * The cache is keyed by the size and the modification time of the source file: if either changes, the cache is
+ * ignored and written again. The file starts with a MeshCacheHeader, followed by the .mtl files and the materials
+ * used by the .obj, as strings (an unsigned short length followed by its characters), padded to 4 bytes. Then come
+ * the interleaved vertices (position, then uv_map and normal, if the mesh has them) and the 32 bit indexes.
+ * This is an instance-less class.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "MeshData.h"
+#include "../input/FileIO.h"
+
+/* Flags of the vertex attributes stored in a mesh cache. */
+enum MeshCacheAttribute {
+    MESH_CACHE_UV_MAPS = 1, MESH_CACHE_NORMALS = 2
+};
+
+/* The start of every mesh cache file. It's written and read as a whole, so it must stay a plain struct. */
+struct MeshCacheHeader {
+    unsigned int magic;
+    unsigned int version;
+    /* The size and modification time of the source file when the cache was written. */
+    long long sourceSize;
+    long long sourceTime;
+    /* MeshCacheAttribute flags of the vertices. */
+    unsigned int attributes;
+    unsigned int numVertices;
+    unsigned int numIndexes;
+    unsigned int numMaterialLibraries;
+    unsigned int numMaterialNames;
+    /* The sphere around all the vertices of the mesh. */
+    float boundsCentre[3];
+    float boundsRadius;
+};
+
+struct MeshCacheData;
+
+class MeshCache {
+public:
+
+    /* The first four bytes of every mesh cache file, "NMSH". */
+    static const unsigned int FILE_MAGIC = 0x48534D4E;
+    /* Version of the mesh cache format. Must be incremented whenever the format changes. */
+    static const unsigned int FILE_VERSION = 1;
+
+    /* Returns the name of the cache file of a source file. */
+    static std::string getCacheFileName(const std::string &sourceFileName) { return sourceFileName + ".mesh"; }
+
+    /*
+     * Writes the cache of sourceFileName, replacing the current one. mesh should already be optimised, and must have
+     * normals. Returns false if the cache couldn't be written, which only means it'll be parsed again next time.
+     */
+    static bool save(const std::string &sourceFileName, const MeshData &mesh,
+        const std::vector<std::string> &materialLibraries, const std::vector<std::string> &materialNames);
+
+    /*
+     * Maps the cache of sourceFileName into cache. Returns false if there's no cache, or if it's outdated, corrupted
+     * or from another version, in which case the source file must be parsed instead.
+     */
+    static bool load(const std::string &sourceFileName, MeshCacheData &cache);
+
+    /* Returns the number of bytes of each vertex with the attributes provided. */
+    static int getStride(unsigned int attributes) {
+        int stride = sizeof(Vector3);
+        if (attributes & MESH_CACHE_UV_MAPS) stride += sizeof(Vector2);
+        if (attributes & MESH_CACHE_NORMALS) stride += sizeof(Vector3);
+        return stride;
+    }
+
+protected:
+
+    /* Reads the header and the strings of a mapped cache, and points to its vertex and index data. */
+    static bool readMappedFile(MeshCacheData &cache, long long sourceSize, long long sourceTime);
+
+    MeshCache(void) {}
+    ~MeshCache(void) {}
+};
+
+/* A mesh cache file mapped into memory, with pointers to its data. The pointers are valid while the file is open. */
+struct MeshCacheData {
+    MappedFile file;
+    MeshCacheHeader header;
+    std::vector<std::string> materialLibraries;
+    std::vector<std::string> materialNames;
+    const char *vertexData;
+    const unsigned int *indexData;
+
+    /* Returns the number of bytes between two vertices of vertexData. */
+    int getStride() const { return MeshCache::getStride(header.attributes); }
+};
@@ -0,0 +1,289 @@
+#include "MeshData.h"
+
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+/* The full set of attributes of a vertex, compared bit by bit when the duplicated vertices are merged. */
+struct VertexKey {
+    float values[9];
+
+    bool operator==(const VertexKey &other) const {
+        return memcmp(values, other.values, sizeof(values)) == 0;
+    }
+};
+
+struct VertexKeyHash {
+    size_t operator()(const VertexKey &key) const {
+        // FNV-1a over the bytes of the attributes
+        const unsigned char *bytes = (const unsigned char*) key.values;
+        size_t hash = 2166136261u;
+        for (size_t i = 0; i < sizeof(key.values); i++) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+};
+
+void MeshData::optimise() {
+    removeDuplicateVertices();
+    optimiseVertexCache();
+}
+
+int MeshData::removeDuplicateVertices() {
+    size_t numVertices = vertices.size();
+    if (numVertices == 0) return 0;
+    bool hasUvMaps = uv_maps.size() == numVertices;
+    bool hasNormals = normals.size() == numVertices;
+    bool hasFloors = floors.size() == numVertices;
+    // Maps the old vertices to the new ones, so the index buffer can be built, or remapped if it already exists
+    std::vector<unsigned int> remap(numVertices);
+    std::unordered_map<VertexKey, unsigned int, VertexKeyHash> uniqueVertices;
+    uniqueVertices.reserve(numVertices);
+    unsigned int numUnique = 0;
+    for (size_t i = 0; i < numVertices; i++) {
+        VertexKey key;
+        memset(&key, 0, sizeof(VertexKey));
+        key.values[0] = vertices[i].x;
+        key.values[1] = vertices[i].y;
+        key.values[2] = vertices[i].z;
+        if (hasUvMaps) {
+            key.values[3] = uv_maps[i].x;
+            key.values[4] = uv_maps[i].y;
+        }
+        if (hasNormals) {
+            key.values[5] = normals[i].x;
+            key.values[6] = normals[i].y;
+            key.values[7] = normals[i].z;
+        }
+        if (hasFloors) {
+            key.values[8] = floors[i];
+        }
+        auto found = uniqueVertices.find(key);
+        if (found != uniqueVertices.end()) {
+            remap[i] = found->second;
+            continue;
+        }
+        uniqueVertices[key] = numUnique;
+        remap[i] = numUnique;
+        // The unique vertices are compacted in place, they're never ahead of the vertex being read
+        vertices[numUnique] = vertices[i];
+        if (hasUvMaps) uv_maps[numUnique] = uv_maps[i];
+        if (hasNormals) normals[numUnique] = normals[i];
+        if (hasFloors) floors[numUnique] = floors[i];
+        numUnique++;
+    }
+    if (indexes.empty()) {
+        indexes.swap(remap);
+    } else {
+        for (auto it = indexes.begin(); it != indexes.end(); it++) {
+            *it = remap[*it];
+        }
+    }
+    vertices.resize(numUnique);
+    if (hasUvMaps) uv_maps.resize(numUnique);
+    if (hasNormals) normals.resize(numUnique);
+    if (hasFloors) floors.resize(numUnique);
+    return (int) (numVertices - numUnique);
+}
+
+/* Score of a vertex in the Forsyth algorithm, from its position on the cache (-1 if not in it) and unused triangles. */
+static float calculateVertexScore(int cachePosition, int remainingTriangles) {
+    if (remainingTriangles == 0) return -1.0f;
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            // The vertices of the last triangle get a fixed score, so the next triangle doesn't just reuse an edge
+            score = 0.75f;
+        } else {
+            float scaler = 1.0f / (MeshData::VERTEX_CACHE_SIZE - 3);
+            score = pow(1.0f - (cachePosition - 3) * scaler, 1.5f);
+        }
+    }
+    // Vertices with few triangles left are preferred, so they're finished and don't linger as isolated triangles
+    score += 2.0f * pow((float) remainingTriangles, -0.5f);
+    return score;
+}
+
+void MeshData::optimiseVertexCache() {
+    if (indexes.size() < 3 || vertices.empty()) return;
+    size_t numVertices = vertices.size();
+    size_t numTriangles = indexes.size() / 3;
+
+    // The triangles that use each vertex, stored as a single array with an offset per vertex
+    std::vector<int> triangleCount(numVertices, 0);
+    for (size_t i = 0; i < numTriangles * 3; i++) {
+        triangleCount[indexes[i]]++;
+    }
+    std::vector<int> triangleOffset(numVertices + 1, 0);
+    for (size_t v = 0; v < numVertices; v++) {
+        triangleOffset[v + 1] = triangleOffset[v] + triangleCount[v];
+    }
+    std::vector<int> vertexTriangles(triangleOffset[numVertices]);
+    std::vector<int> remainingTriangles(numVertices, 0);
+    for (size_t t = 0; t < numTriangles; t++) {
+        for (int c = 0; c < 3; c++) {
+            unsigned int v = indexes[t * 3 + c];
+            vertexTriangles[triangleOffset[v] + remainingTriangles[v]] = (int) t;
+            remainingTriangles[v]++;
+        }
+    }
+
+    std::vector<int> cachePosition(numVertices, -1);
+    std::vector<float> vertexScore(numVertices);
+    for (size_t v = 0; v < numVertices; v++) {
+        vertexScore[v] = calculateVertexScore(-1, remainingTriangles[v]);
+    }
+    std::vector<float> triangleScore(numTriangles);
+    std::vector<bool> triangleAdded(numTriangles, false);
+    for (size_t t = 0; t < numTriangles; t++) {
+        triangleScore[t] = vertexScore[indexes[t * 3]] + vertexScore[indexes[t * 3 + 1]] +
+            vertexScore[indexes[t * 3 + 2]];
+    }
+
+    // The simulated LRU cache, with room for the 3 vertices pushed by the triangle being added
+    int cache[VERTEX_CACHE_SIZE + 3];
+    int cacheSize = 0;
+    std::vector<unsigned int> newIndexes;
+    newIndexes.reserve(numTriangles * 3);
+    int bestTriangle = -1;
+    size_t nextUnadded = 0;
+
+    for (size_t added = 0; added < numTriangles; added++) {
+        if (bestTriangle < 0) {
+            // No triangle touches the cache, so the next one not added yet starts a new strip
+            while (triangleAdded[nextUnadded]) nextUnadded++;
+            bestTriangle = (int) nextUnadded;
+        }
+        triangleAdded[bestTriangle] = true;
+
+        // Puts the vertices of the triangle in front of the cache, removing them from where they were
+        int newCache[VERTEX_CACHE_SIZE + 3];
+        int newCacheSize = 0;
+        for (int c = 0; c < 3; c++) {
+            unsigned int v = indexes[bestTriangle * 3 + c];
+            newIndexes.push_back(v);
+            newCache[newCacheSize++] = (int) v;
+            // Removes the triangle from the list of the vertex, so only the unused ones are counted
+            int *first = &vertexTriangles[triangleOffset[v]];
+            int *last = first + remainingTriangles[v];
+            for (int *it = first; it != last; it++) {
+                if (*it == bestTriangle) {
+                    *it = *(last - 1);
+                    break;
+                }
+            }
+            remainingTriangles[v]--;
+        }
+        for (int i = 0; i < cacheSize; i++) {
+            int v = cache[i];
+            if (v != newCache[0] && v != newCache[1] && v != newCache[2]) {
+                newCache[newCacheSize++] = v;
+            }
+        }
+        // The vertices pushed out of the cache are updated too, their score goes back to only the valence
+        for (int i = 0; i < newCacheSize; i++) {
+            int v = newCache[i];
+            int position = i < VERTEX_CACHE_SIZE ? i : -1;
+            cachePosition[v] = position;
+            float score = calculateVertexScore(position, remainingTriangles[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            for (int j = 0; j < remainingTriangles[v]; j++) {
+                triangleScore[vertexTriangles[triangleOffset[v] + j]] += delta;
+            }
+        }
+        cacheSize = newCacheSize < VERTEX_CACHE_SIZE ? newCacheSize : VERTEX_CACHE_SIZE;
+        memcpy(cache, newCache, cacheSize * sizeof(int));
+
+        // Only the triangles that touch the cache are candidates, which keeps the whole algorithm linear
+        bestTriangle = -1;
+        float bestScore = -1.0f;
+        for (int i = 0; i < cacheSize; i++) {
+            int v = cache[i];
+            for (int j = 0; j < remainingTriangles[v]; j++) {
+                int t = vertexTriangles[triangleOffset[v] + j];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+    }
+    // Keeps any index that doesn't make up a whole triangle, even if it can't be drawn
+    newIndexes.insert(newIndexes.end(), indexes.begin() + numTriangles * 3, indexes.end());
+
+    // Reorders the vertices in the order they're first used, so the vertex fetch also reads the memory in sequence
+    std::vector<unsigned int> remap(numVertices, 0xFFFFFFFF);
+    unsigned int nextVertex = 0;
+    for (auto it = newIndexes.begin(); it != newIndexes.end(); it++) {
+        if (remap[*it] == 0xFFFFFFFF) {
+            remap[*it] = nextVertex++;
+        }
+        *it = remap[*it];
+    }
+    // Vertices not used by any triangle are kept at the end
+    for (size_t v = 0; v < numVertices; v++) {
+        if (remap[v] == 0xFFFFFFFF) {
+            remap[v] = nextVertex++;
+        }
+    }
+    std::vector<Vector3> newVertices(numVertices);
+    for (size_t v = 0; v < numVertices; v++) newVertices[remap[v]] = vertices[v];
+    vertices.swap(newVertices);
+    if (uv_maps.size() == numVertices) {
+        std::vector<Vector2> newUvMaps(numVertices);
+        for (size_t v = 0; v < numVertices; v++) newUvMaps[remap[v]] = uv_maps[v];
+        uv_maps.swap(newUvMaps);
+    }
+    if (normals.size() == numVertices) {
+        std::vector<Vector3> newNormals(numVertices);
+        for (size_t v = 0; v < numVertices; v++) newNormals[remap[v]] = normals[v];
+        normals.swap(newNormals);
+    }
+    if (floors.size() == numVertices) {
+        std::vector<float> newFloors(numVertices);
+        for (size_t v = 0; v < numVertices; v++) newFloors[remap[v]] = floors[v];
+        floors.swap(newFloors);
+    }
+    indexes.swap(newIndexes);
+}
+
+float MeshData::calculateACMR() const {
+    size_t numTriangles = indexes.empty() ? vertices.size() / 3 : indexes.size() / 3;
+    if (numTriangles == 0) return 0.0f;
+    // Without indexes, the GPU can't know that two vertices are the same, so every vertex is transformed
+    if (indexes.empty()) return 3.0f;
+    // FIFO cache, like the one most GPUs use for the post-transform vertices
+    std::vector<int> cacheTime(vertices.size(), -VERTEX_CACHE_SIZE - 1);
+    int misses = 0;
+    for (size_t i = 0; i < numTriangles * 3; i++) {
+        unsigned int v = indexes[i];
+        if (misses - cacheTime[v] > VERTEX_CACHE_SIZE) {
+            cacheTime[v] = misses;
+            misses++;
+        }
+    }
+    return (float) misses / numTriangles;
+}
+
+void MeshData::calculateBoundingSphere(Vector3 &centre, float &radius) const {
+    centre = Vector3(0, 0, 0);
+    radius = 0;
+    if (vertices.empty()) return;
+    Vector3 minimum = vertices[0];
+    Vector3 maximum = vertices[0];
+    for (auto it = vertices.begin(); it != vertices.end(); it++) {
+        if (it->x < minimum.x) minimum.x = it->x;
+        if (it->y < minimum.y) minimum.y = it->y;
+        if (it->z < minimum.z) minimum.z = it->z;
+        if (it->x > maximum.x) maximum.x = it->x;
+        if (it->y > maximum.y) maximum.y = it->y;
+        if (it->z > maximum.z) maximum.z = it->z;
+    }
+    centre = (minimum + maximum) * 0.5f;
+    for (auto it = vertices.begin(); it != vertices.end(); it++) {
+        float distance = ((*it) - centre).getLength();
+        if (distance > radius) radius = distance;
+    }
+}
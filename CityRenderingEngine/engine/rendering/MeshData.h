@@ -0,0 +1,129 @@
+/*
+ * Description: The CPU side of a mesh: the vertex, uv_map, normal and index data that will be uploaded to the GPU. It
+ * doesn't touch OpenGL at all, so it can be safely built on any thread, like the ChunkLoader workers. The data is only
+ * uploaded later, on the render thread, when it's given to a Model (see Model::getOrCreate() and UploadQueue).
+ *
+ * Meshes are usually built as a plain list of triangles, with every corner as a separate vertex. optimise() turns that
+ * into an indexed mesh, where each unique vertex is stored once, and reorders the triangles so the GPU can reuse the
+ * vertices it just transformed from its post-transform cache, instead of running the vertex shader on them again.
+ */
+
+#pragma once
+
+#include <vector>
+#include "../math/Vector2.h"
+#include "../math/Vector3.h"
+
+/* Numbers used to compare a mesh before and after being optimised. */
+struct MeshStatistics {
+    int numVertices;
+    int numIndexes;
+    size_t byteSize;
+    /* Average cache miss ratio: vertices transformed per triangle. 3 is the worst case, and 0.5 the best possible. */
+    float acmr;
+};
+
+class MeshData {
+public:
+
+    /* Size of the post-transform vertex cache assumed by optimiseVertexCache() and calculateACMR(). */
+    static const int VERTEX_CACHE_SIZE = 32;
+
+    MeshData(void) {}
+    ~MeshData(void) {}
+
+    /* The vertex data. uv_maps and normals must be empty or have the same size as vertices. */
+    std::vector<Vector3> vertices;
+    std::vector<Vector2> uv_maps;
+    std::vector<Vector3> normals;
+
+    /* Optional number of floors of each vertex, read by the Building shader. Empty or the same size as vertices. */
+    std::vector<float> floors;
+
+    /* Optional indexes. If empty, every 3 vertices make up a triangle. */
+    std::vector<unsigned int> indexes;
+
+    /*
+     * Calculates flat normals for each triangle of the mesh, replacing the current normals. The mesh must not be
+     * indexed yet, so this must be called before optimise().
+     */
+    void generateNormals() {
+        normals.resize(vertices.size());
+        for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+            Vector3 normal = Vector3::cross(vertices[i + 1] - vertices[i], vertices[i + 2] - vertices[i]);
+            normal.normalise();
+            normals[i] = normal;
+            normals[i + 1] = normal;
+            normals[i + 2] = normal;
+        }
+    }
+
+    /* Returns the number of bytes that this mesh will take on the GPU. */
+    size_t getByteSize() const {
+        return vertices.size() * sizeof(Vector3) + uv_maps.size() * sizeof(Vector2) +
+            normals.size() * sizeof(Vector3) + floors.size() * sizeof(float) + indexes.size() * sizeof(unsigned int);
+    }
+
+    bool isEmpty() const { return vertices.empty(); }
+
+    /*
+     * Appends the data of another mesh to the end of this one, with its vertices moved by translation. Both meshes
+     * should have the same set of optional attributes, or they won't match the vertices anymore.
+     */
+    void append(const MeshData &other, const Vector3 &translation) {
+        unsigned int firstVertex = (unsigned int) vertices.size();
+        vertices.reserve(vertices.size() + other.vertices.size());
+        for (auto it = other.vertices.begin(); it != other.vertices.end(); it++) {
+            vertices.push_back((*it) + translation);
+        }
+        uv_maps.insert(uv_maps.end(), other.uv_maps.begin(), other.uv_maps.end());
+        normals.insert(normals.end(), other.normals.begin(), other.normals.end());
+        floors.insert(floors.end(), other.floors.begin(), other.floors.end());
+        for (auto it = other.indexes.begin(); it != other.indexes.end(); it++) {
+            indexes.push_back((*it) + firstVertex);
+        }
+    }
+
+    /*
+     * Indexes the mesh, merging all vertices that have exactly the same position, uv_map, normal and floors, and then
+     * runs optimiseVertexCache(). Works on meshes that are already indexed as well.
+     */
+    void optimise();
+
+    /*
+     * Merges the identical vertices, building the index buffer if the mesh doesn't have one. Returns the number of
+     * vertices removed.
+     */
+    int removeDuplicateVertices();
+
+    /*
+     * Reorders the triangles of an indexed mesh for the post-transform vertex cache, with Tom Forsyth's "Linear-Speed
+     * Vertex Cache Optimisation", and then reorders the vertices in the order they're first used, so they're also
+     * fetched from memory sequentially. Does nothing if the mesh isn't indexed.
+     */
+    void optimiseVertexCache();
+
+    /* Simulates the draw of the mesh on a vertex cache of VERTEX_CACHE_SIZE, and returns its ACMR. */
+    float calculateACMR() const;
+
+    /* Calculates a sphere around all vertices, centred on their bounding box. Both are zero if the mesh is empty. */
+    void calculateBoundingSphere(Vector3 &centre, float &radius) const;
+
+    MeshStatistics getStatistics() const {
+        MeshStatistics statistics;
+        statistics.numVertices = (int) vertices.size();
+        statistics.numIndexes = (int) indexes.size();
+        statistics.byteSize = getByteSize();
+        statistics.acmr = calculateACMR();
+        return statistics;
+    }
+
+    /* Removes all data from this mesh. */
+    void clear() {
+        vertices.clear();
+        uv_maps.clear();
+        normals.clear();
+        floors.clear();
+        indexes.clear();
+    }
+};
@@ -1,4 +1,8 @@
 ﻿#include "Model.h"
+#include "UploadQueue.h"
+#include "InstanceBatch.h"
+#include "ObjParser.h"
+#include "MeshCache.h"
 
 const int Model::meshTriangleName = 100;
 
@@ -6,12 +10,16 @@ Model::Model(void) : Resource() {
     vertexes = nullptr;
     uv_maps = nullptr;
     normals = nullptr;
+    floors = nullptr;
     indexes = nullptr;
     material = nullptr;
     shader = nullptr;
     fileName = "";
     numVertices = 0;
     numIndexes = 0;
+    boundsRadius = 0;
+    cachedVertexSize = 0;
+    uploadPending = false;
     for (int i = 0; i < MAX_BUFFER; i++) {
         bufferObjects[i] = 0;
     }
@@ -21,12 +29,16 @@ Model::Model(std::string fileName, int name) : Resource(name) {
     vertexes = nullptr;
     uv_maps = nullptr;
     normals = nullptr;
+    floors = nullptr;
     indexes = nullptr;
     material = nullptr;
     shader = nullptr;
     this->fileName = fileName;
     numVertices = 0;
     numIndexes = 0;
+    boundsRadius = 0;
+    cachedVertexSize = 0;
+    uploadPending = false;
     for (int i = 0; i < MAX_BUFFER; i++) {
         bufferObjects[i] = 0;
     }
@@ -36,18 +48,24 @@ Model::Model(const Model &copy) : Resource(copy) {
     vertexes = copy.vertexes;
     uv_maps = copy.uv_maps;
     normals = copy.normals;
+    floors = copy.floors;
     indexes = copy.indexes;
     numVertices = copy.numVertices;
     numIndexes = copy.numIndexes;
+    boundsCentre = copy.boundsCentre;
+    boundsRadius = copy.boundsRadius;
+    cachedVertexSize = copy.cachedVertexSize;
     material = copy.material;
     shader = copy.shader;
     fileName = copy.fileName;
+    uploadPending = false;
     for (int i = 0; i < MAX_BUFFER; i++) {
         this->bufferObjects[i] = copy.bufferObjects[i];
     }
 }
 
 Model::~Model(void) {
+    UploadQueue::cancel(this);
     material = nullptr;
     shader = nullptr;
     loaded = false;
@@ -55,25 +73,82 @@ Model::~Model(void) {
     numVertices = -1;
 }
 
-void Model::draw() {
-    if (!loaded) load(); // If it's not yet loaded, try to load it
+void Model::draw(bool withMaterial) {
+    if (!loaded) {
+        if (uploadPending) return; // The UploadQueue will load it, don't stall this frame doing it here
+        load(); // If it's not yet loaded, try to load it
+    }
     if (loaded && valid) { // Check it again in case there's a proble loading the Model
-        glBindVertexArray(vao);
-        if (material != nullptr && material->getTexture() != nullptr) {
-            if (!material->getTexture()->isLoaded())
-                material->getTexture()->load();
-            if (material->getTexture()->isValid()) {
-                GLuint program = Naquadah::getRenderer()->getCurrentShader()->getShaderProgram();
-                material->getTexture()->bindTexture(program, TEXTURE0);
-            }
+        // The VAO is left bound, so the next draw of the same Model doesn't bind it again
+        Renderer *renderer = Naquadah::getRenderer();
+        renderer->bindVertexArray(vao);
+        if (withMaterial) {
+            bindMaterial();
         }
+        renderer->addDrawCall();
         if (bufferObjects[INDEX_BUFFER]) {
             glDrawElements(GL_TRIANGLES, numIndexes, GL_UNSIGNED_INT, 0);
         } else {
             glDrawArrays(GL_TRIANGLES, 0, numVertices);
         }
         Renderer::logOpenGLError("MODEL_DRAW");
-        glBindVertexArray(0);
+    }
+}
+
+void Model::drawInstanced(GLuint instanceBuffer, int numInstances, bool withMaterial) {
+    if (!loaded) {
+        if (uploadPending) return;
+        load();
+    }
+    if (loaded && valid && instanceBuffer != 0 && numInstances > 0) {
+        Renderer *renderer = Naquadah::getRenderer();
+        renderer->bindVertexArray(vao);
+        if (withMaterial) {
+            bindMaterial();
+        }
+        // The instance attributes are only enabled during this draw, so the Model can still be drawn normally
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        for (int i = 0; i < 4; i++) {
+            GLuint location = INSTANCE_MATRIX_ATTRIBUTE + i;
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+                (void*) (offsetof(InstanceData, modelMatrix) + i * 4 * sizeof(float)));
+            glVertexAttribDivisor(location, 1);
+            glEnableVertexAttribArray(location);
+        }
+        glVertexAttribPointer(INSTANCE_PARAMS_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData),
+            (void*) offsetof(InstanceData, params));
+        glVertexAttribDivisor(INSTANCE_PARAMS_ATTRIBUTE, 1);
+        glEnableVertexAttribArray(INSTANCE_PARAMS_ATTRIBUTE);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        renderer->addDrawCall();
+        if (bufferObjects[INDEX_BUFFER]) {
+            glDrawElementsInstanced(GL_TRIANGLES, numIndexes, GL_UNSIGNED_INT, 0, numInstances);
+        } else {
+            glDrawArraysInstanced(GL_TRIANGLES, 0, numVertices, numInstances);
+        }
+        Renderer::logOpenGLError("MODEL_DRAW_INSTANCED");
+
+        for (int i = 0; i < 4; i++) {
+            glDisableVertexAttribArray(INSTANCE_MATRIX_ATTRIBUTE + i);
+        }
+        glDisableVertexAttribArray(INSTANCE_PARAMS_ATTRIBUTE);
+    }
+}
+
+Texture *Model::getTexture() {
+    // Not inline, as Material may still be incomplete when Model.h is included through Material.h
+    return material != nullptr ? material->getTexture() : nullptr;
+}
+
+void Model::bindMaterial() {
+    if (material != nullptr && material->getTexture() != nullptr) {
+        if (!material->getTexture()->isLoaded())
+            material->getTexture()->load();
+        if (material->getTexture()->isValid()) {
+            GLuint program = Naquadah::getRenderer()->getCurrentShader()->getShaderProgram();
+            material->getTexture()->bindTexture(program, TEXTURE0);
+        }
     }
 }
 
@@ -157,8 +232,9 @@ void Model::generateNormals() {
 void Model::bufferData() {
      // No point in buffering the data twice. Also, it shouldn't buffer the model if it doesn't have vertexes!
     if (!loaded && vertexes != nullptr) {
+        Renderer *renderer = Naquadah::getRenderer();
         glGenVertexArrays(1, &vao);
-        glBindVertexArray(vao);
+        renderer->bindVertexArray(vao);
 
         // Buffer vertexes
         glGenBuffers(1, &bufferObjects[VERTEX_BUFFER]);
@@ -185,16 +261,24 @@ void Model::bufferData() {
             glEnableVertexAttribArray(NORMAL_BUFFER);
         }
 
+        // Buffer floors (optional)
+        if (floors != nullptr) {
+            glGenBuffers(1, &bufferObjects[FLOORS_BUFFER]);
+            glBindBuffer(GL_ARRAY_BUFFER, bufferObjects[FLOORS_BUFFER]);
+            glBufferData(GL_ARRAY_BUFFER, numVertices * sizeof(float), &floors[0], GL_STATIC_DRAW);
+            glVertexAttribPointer(FLOORS_BUFFER, 1, GL_FLOAT, GL_FALSE, 0, 0);
+            glEnableVertexAttribArray(FLOORS_BUFFER);
+        }
+
         // Buffer indexes
         if (indexes != nullptr) {
             glGenBuffers(1, &bufferObjects[INDEX_BUFFER]);
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferObjects[INDEX_BUFFER]);
+            // The element buffer is part of the VAO state, it's not a vertex attribute
             glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndexes * sizeof(GLuint), &indexes[0], GL_STATIC_DRAW);
-            glVertexAttribPointer(INDEX_BUFFER, 1, GL_FLOAT, GL_FALSE, 0, 0);
-            glEnableVertexAttribArray(INDEX_BUFFER);
         }
 
-        glBindVertexArray(0);
+        renderer->bindVertexArray(0);
 
         // Only set the resource as loaded once it has actually been loaded to the GPU
         loaded = true;
@@ -209,146 +293,37 @@ void Model::load() {
             bufferData();
             return;
         }
-        std::vector<std::string> lines = FileIO::readTextFile(fileName);
-        std::vector<Material*> materials;
-
-        if (lines.size() < 2) {
+        if (loadFromCache()) return;
+        ObjData obj;
+        if (!ObjParser::parseObjFile(fileName, obj)) {
             // We probably couldn't load the file, or the file is invalid.
+            std::cout << "Could not load the Model " << fileName << std::endl;
             loaded = true;
             valid = false;
             return;
         }
 
-        // To store the vertexes, uvmaps and normals.
-        std::vector<Vector3> vecVertices;
-        std::vector<Vector2> vecUvMaps;
-        std::vector<Vector3> vecNormals;
-
-        /* To map the above vertexes, uvmaps and normals to all the faces. Basically .obj files will have the minimum
-         * number of vertex data, and the last lines will be the faces, with each face mapping 3 of the above to a
-         * face. As we're not using indexes here, we need to use there vectors below to duplicate and map the data.
-         * For example, a cube.obj will have 8 vertexes, and 12 triangle faces, with each face having 3 vertexes. So
-         * we have in total 24 vertexes that need to be mapped and copied from the original 8 vertexes (from above).
-         */
-        std::vector<Vector3> vecCorrectVertices;
-        std::vector<Vector2> vecCorrectUvMaps;
-        std::vector<Vector3> vecCorrectNormals;
-
-        // Go through all of the elements of coord, and decide what kind of element is that
-        for (unsigned i = 0; i < lines.size(); i++) {
-            std::string line = lines[i];
-            if (line.size() < 2) continue;
-            // Trim the whitespaces at the beginning of the line, if present
-            line.erase(line.begin(), std::find_if(line.begin(), line.end(), std::not1(std::ptr_fun<int, int>(std::isspace))));
-            char firstChar = line[0];
-            char secondChar = line[1];
-
-            switch (firstChar) {
-            case '#':
-                // It's a comment, don't do anything with it
-                break;
-            case 'v':
-                if (secondChar == ' ') {
-                    // It's a vertex
-                    float x, y, z;
-                    sscanf(line.c_str(), "v %f %f %f", &x, &y, &z);
-                    vecVertices.emplace_back(Vector3(x, y, z));
-                } else if (secondChar == 'n') {
-                    // It's a normal
-                    float x, y, z;
-                    sscanf(line.c_str(), "vn %f %f %f", &x, &y, &z);
-                    vecNormals.emplace_back(Vector3(x, y, z));
-                } else if (secondChar == 't') {
-                    // It's a texture coordinate
-                    float x, y;
-                    sscanf(line.c_str(), "vt %f %f", &x, &y);
-                    vecUvMaps.emplace_back(Vector2(x, y));
-                }
-                break;
-            case 'f':
-                /*
-                 * It's a face
-                 *
-                 * The viXYZ variables represent vertex indexes, the niXYZ represent
-                 * normal indexes and tiXYZ, texture mapping indexes
-                 */
-                int viX, viY, viZ, niX, niY, niZ, tiX, tiY, tiZ;
-
-                if (count(line.begin(), line.end(), ' ') == 3) {
-                    // It's a triangle face
-                    if (line.find("//") != std::string::npos) {
-                        // If it's a face with vertexes and normals
-                        sscanf(line.c_str(),"f %d//%d %d//%d %d//%d", &viX ,&niX, &viY, &niY, &viZ, &niZ);
-                        vecCorrectNormals.emplace_back(vecNormals.at(niX - 1));
-                        vecCorrectNormals.emplace_back(vecNormals.at(niY - 1));
-                        vecCorrectNormals.emplace_back(vecNormals.at(niZ - 1));
-                    } else if (line.find("/") != std::string::npos) {
-                        if (count(line.begin(), line.end(), '/') == 6) {
-                            // If it's a face with vertexes, uv_maps and normals
-                            sscanf(line.c_str(), "f %d/%d/%d %d/%d/%d %d/%d/%d", &viX, &tiX, &niX, &viY, &tiY, &niY, &viZ, &tiZ, &niZ);
-                            vecCorrectUvMaps.emplace_back(Vector2(vecUvMaps.at(tiX - 1)));
-                            vecCorrectUvMaps.emplace_back(Vector2(vecUvMaps.at(tiY - 1)));
-                            vecCorrectUvMaps.emplace_back(Vector2(vecUvMaps.at(tiZ - 1)));
-                            vecCorrectNormals.emplace_back(vecNormals.at(niX - 1));
-                            vecCorrectNormals.emplace_back(vecNormals.at(niY - 1));
-                            vecCorrectNormals.emplace_back(vecNormals.at(niZ - 1));
-                        } else {
-                            // If it's a face with vertexes and uv_maps
-                            sscanf(line.c_str(), "f %d/%d %d/%d %d/%d", &viX, &tiX, &viY, &tiY, &viZ, &tiZ);
-                            vecCorrectUvMaps.emplace_back(vecUvMaps.at(tiX - 1));
-                            vecCorrectUvMaps.emplace_back(vecUvMaps.at(tiY - 1));
-                            vecCorrectUvMaps.emplace_back(vecUvMaps.at(tiZ - 1));
-                        }
-                    } else {
-                        // If it's a face with only vertexes
-                        sscanf(line.c_str(), "f %d %d %d", &viX, &viY, &viZ);
-                    }
-                    vecCorrectVertices.emplace_back(vecVertices.at(viX - 1));
-                    vecCorrectVertices.emplace_back(vecVertices.at(viY - 1));
-                    vecCorrectVertices.emplace_back(vecVertices.at(viZ - 1));
-                }
-                break;
-            case 'u':
-                if (secondChar == 's') {
-                    // It's a call to use a new material. If this Model already has a material, this will override it.
-                    char matName[200];
-                    sscanf(line.c_str(), "%*s %s", matName);
-                    for (unsigned i = 0; i < materials.size(); i++) {
-                        if (std::string(matName).compare(materials.at(i)->getMaterialName()) == 0) {
-                            // If we find the material in the materials list, use it instead of the current one
-                            material = materials.at(i);
-                        }
-                    }
-                }
-                break;
-            case 'm':
-                if (secondChar == 't') {
-                    // It's a call to load new materials from a .mtl file
-                    char matFileName[200];
-                    sscanf(line.c_str(), "%*s %s", matFileName);
-                    // TODO: change the call below to use the model's path, not this hardcoded path
-                    std::string matFileString = "resources/meshes/" + std::string(matFileName);
-                    std::vector<Material*> newMaterials = Material::loadMaterialsFromFile(matFileString);
-                    materials.insert(materials.end(), newMaterials.begin(), newMaterials.end());
-                }
-            }
+        // Now we can put the mesh into the Model and buffer it. Its faces were expanded into one vertex per corner,
+        // MeshData::optimise() merges the corners that are the same into indexed vertexes.
+        // For example, a cube.obj has 8 vertexes and 12 triangle faces. The 36 corners are expanded, and then merged
+        // back into the 24 unique vertexes (a position and a normal).
+        MeshData &meshData = obj.mesh;
+        if (meshData.normals.empty()) {
+            // The flat normals must be generated while each triangle still has its own vertexes
+            meshData.generateNormals();
         }
-        
-        // Now we can put all this temporary data into the Model and buffer it.
-        numVertices = (int) vecCorrectVertices.size();
-        int numUvMaps = (int) vecCorrectUvMaps.size();
-        int numNormals = (int) vecCorrectNormals.size();
-
-        this->vertexes = new Vector3[numVertices];
-        this->uv_maps = new Vector2[numVertices];
-        this->normals = new Vector3[numVertices];
-        for (int i = 0; i < numVertices; i++) {
-            vertexes[i] = Vector3(vecCorrectVertices.at(i));
-            if (numUvMaps == numVertices)
-                uv_maps[i] = Vector2(vecCorrectUvMaps.at(i));
-            if (numNormals == numVertices)
-                normals[i] = Vector3(vecCorrectNormals.at(i));
+        MeshStatistics before = meshData.getStatistics();
+        meshData.optimise();
+        MeshStatistics after = meshData.getStatistics();
+        std::cout << "Model " << fileName << ": " << before.numVertices << " vertexes (" << before.byteSize / 1024 <<
+            " KB, ACMR " << before.acmr << ") -> " << after.numVertices << " vertexes, " << after.numIndexes <<
+            " indexes (" << after.byteSize / 1024 << " KB, ACMR " << after.acmr << ")" << std::endl;
+        meshData.calculateBoundingSphere(boundsCentre, boundsRadius);
+        // The next loads of this file will just map the result
+        if (!MeshCache::save(fileName, meshData, obj.materialLibraries, obj.materialNames)) {
+            std::cout << "Could not write the mesh cache of " << fileName << std::endl;
         }
+        setMeshData(meshData);
 
         if (numVertices < 1) {
             // If we don't have at least a point, this is an invalid model.
@@ -356,27 +331,103 @@ void Model::load() {
         } else {
             this->bufferData();
         }
+        loadMaterials(obj.materialLibraries, obj.materialNames);
+    }
+    loaded = true;
+}
+
+bool Model::loadFromCache() {
+    MeshCacheData cache;
+    if (!MeshCache::load(fileName, cache)) return false;
+    const MeshCacheHeader &header = cache.header;
+    numVertices = (int) header.numVertices;
+    numIndexes = (int) header.numIndexes;
+    boundsCentre = Vector3(header.boundsCentre[0], header.boundsCentre[1], header.boundsCentre[2]);
+    boundsRadius = header.boundsRadius;
+    if (numVertices < 1) {
+        loaded = true;
+        valid = false;
+        return true;
+    }
+
+    // A single buffer with all the attributes interleaved, uploaded without any copy on the CPU side
+    Renderer *renderer = Naquadah::getRenderer();
+    glGenVertexArrays(1, &vao);
+    renderer->bindVertexArray(vao);
+    glGenBuffers(1, &bufferObjects[VERTEX_BUFFER]);
+    glBindBuffer(GL_ARRAY_BUFFER, bufferObjects[VERTEX_BUFFER]);
+    GLsizei stride = (GLsizei) cache.getStride();
+    cachedVertexSize = (int) stride;
+    glBufferData(GL_ARRAY_BUFFER, numVertices * stride, cache.vertexData, GL_STATIC_DRAW);
+    size_t offset = 0;
+    glVertexAttribPointer(VERTEX_BUFFER, 3, GL_FLOAT, GL_FALSE, stride, (void*) offset);
+    glEnableVertexAttribArray(VERTEX_BUFFER);
+    offset += sizeof(Vector3);
+    if (header.attributes & MESH_CACHE_UV_MAPS) {
+        glVertexAttribPointer(UV_MAP_BUFFER, 2, GL_FLOAT, GL_FALSE, stride, (void*) offset);
+        glEnableVertexAttribArray(UV_MAP_BUFFER);
+        offset += sizeof(Vector2);
+    }
+    if (header.attributes & MESH_CACHE_NORMALS) {
+        glVertexAttribPointer(NORMAL_BUFFER, 3, GL_FLOAT, GL_FALSE, stride, (void*) offset);
+        glEnableVertexAttribArray(NORMAL_BUFFER);
+    }
+    if (cache.indexData != nullptr) {
+        glGenBuffers(1, &bufferObjects[INDEX_BUFFER]);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferObjects[INDEX_BUFFER]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, numIndexes * sizeof(GLuint), cache.indexData, GL_STATIC_DRAW);
+    }
+    renderer->bindVertexArray(0);
+    Renderer::logOpenGLError("MODEL_LOAD_CACHE");
+
+    loadMaterials(cache.materialLibraries, cache.materialNames);
+    loaded = true;
+    valid = true;
+    return true;
+}
 
-        // Now we discard all the materials that were loaded but we won't use.
+void Model::loadMaterials(const std::vector<std::string> &materialLibraries,
+    const std::vector<std::string> &materialNames) {
+    // Loads the materials of all the .mtl files, and uses the last one selected by usemtl.
+    std::vector<Material*> materials;
+    for (auto it = materialLibraries.begin(); it != materialLibraries.end(); it++) {
+        // TODO: change the call below to use the model's path, not this hardcoded path
+        std::vector<Material*> newMaterials = Material::loadMaterialsFromFile("resources/meshes/" + *it);
+        materials.insert(materials.end(), newMaterials.begin(), newMaterials.end());
+    }
+    for (auto it = materialNames.begin(); it != materialNames.end(); it++) {
         for (unsigned i = 0; i < materials.size(); i++) {
-            if (materials.at(i) != this->material) {
-                ResourcesManager::releaseResource(materials.at(i)->getName());
+            if (it->compare(materials.at(i)->getMaterialName()) == 0) {
+                // If we find the material in the materials list, use it instead of the current one
+                material = materials.at(i);
             }
         }
-        if (this->material != nullptr)
-            this->material->addUser();
     }
-    loaded = true;
+
+    // Now we discard all the materials that were loaded but we won't use.
+    for (unsigned i = 0; i < materials.size(); i++) {
+        if (materials.at(i) != this->material) {
+            ResourcesManager::releaseResource(materials.at(i)->getName());
+        }
+    }
+    if (this->material != nullptr)
+        this->material->addUser();
 }
 
 void Model::unload() {
+    UploadQueue::cancel(this);
     if (loaded && glIsVertexArray(vao) == GL_TRUE) {
         glDeleteVertexArrays(1, &vao);
         glDeleteBuffers(MAX_BUFFER, bufferObjects);
+        Naquadah::getRenderer()->onVertexArrayDeleted(vao);
         loaded = false;
         vao = 0;
+        for (int i = 0; i < MAX_BUFFER; i++) {
+            bufferObjects[i] = 0;
+        }
     }
-    if (vertexes != nullptr) {
+    // Models loaded from a mesh cache have no data on the CPU, but still hold their Material
+    if (vertexes != nullptr || fileName != "") {
         if (material != nullptr) {
             ResourcesManager::releaseResource(material->getName());
             material = nullptr;
@@ -385,13 +436,18 @@ void Model::unload() {
             ResourcesManager::releaseResource(shader->getName());
             shader = nullptr;
         }
+        valid = false;
+    }
+    if (vertexes != nullptr) {
         delete[] vertexes; // Not really deleting and freeing the memory?!
         delete[] uv_maps;
         delete[] normals;
+        delete[] floors;
         delete[] indexes;
         vertexes = nullptr;
         uv_maps = nullptr;
         normals = nullptr;
+        floors = nullptr;
         indexes = nullptr;
         valid = false;
     }
@@ -421,19 +477,23 @@ Model *Model::getQuadMesh(int name) {
 }
 
 Model *Model::getOrCreate(int name, const std::string &fileName, bool preLoad) {
-    if (ResourcesManager::resourceExists(name)) {
-        return (Model*) ResourcesManager::getResource(name);
-    } else {
-        Model *newModel = new Model(fileName, name);
-        ResourcesManager::addResource(newModel, preLoad);
-        return newModel;
+    // Keep the lock during the whole operation, so two Chunk workers can't create the same Model twice
+    ResourcesManager::lockMutex();
+    Model *model = (Model*) ResourcesManager::getResource(name);
+    if (model == nullptr) {
+        model = new Model(fileName, name);
+        ResourcesManager::addResource(model, preLoad);
     }
+    ResourcesManager::unlockMutex();
+    return model;
 }
 
 Model *Model::getOrCreate(int name, const std::vector<Vector3> &vertices, const std::vector<Vector2> &uv_maps,
     const Colour &colour, Texture *texture, bool preLoad) {
+    ResourcesManager::lockMutex();
     Model *m = (Model*) ResourcesManager::getResource(name);
     if (m != nullptr) {
+        ResourcesManager::unlockMutex();
         return m;
     } else {
         m = new Model();
@@ -451,8 +511,79 @@ Model *Model::getOrCreate(int name, const std::vector<Vector3> &vertices, const
         }
         m->generateNormals();
         ResourcesManager::addResource(m, preLoad);
+        ResourcesManager::unlockMutex();
+        return m;
+    }
+}
+
+Model *Model::getOrCreate(int name, const MeshData &meshData, const Colour &colour, Texture *texture,
+    bool preLoad) {
+    ResourcesManager::lockMutex();
+    Model *m = (Model*) ResourcesManager::getResource(name);
+    if (m != nullptr) {
+        ResourcesManager::unlockMutex();
         return m;
     }
+    m = new Model();
+    m->name = name;
+    m->setMeshData(meshData);
+    Material *material = new Material(ResourcesManager::generateNextName(), 1.0f, colour, colour, colour, texture);
+    ResourcesManager::addResource(material, true);
+    m->setMaterial(material);
+    ResourcesManager::addResource(m, preLoad);
+    if (!preLoad) {
+        UploadQueue::push(m);
+    }
+    ResourcesManager::unlockMutex();
+    return m;
+}
+
+void Model::setMeshData(const MeshData &meshData) {
+    numVertices = (int) meshData.vertices.size();
+    vertexes = new Vector3[numVertices];
+    for (int i = 0; i < numVertices; i++) {
+        vertexes[i] = meshData.vertices[i];
+    }
+    if (meshData.uv_maps.size() == meshData.vertices.size()) {
+        uv_maps = new Vector2[numVertices];
+        for (int i = 0; i < numVertices; i++) {
+            uv_maps[i] = meshData.uv_maps[i];
+        }
+    }
+    if (meshData.normals.size() == meshData.vertices.size()) {
+        normals = new Vector3[numVertices];
+        for (int i = 0; i < numVertices; i++) {
+            normals[i] = meshData.normals[i];
+        }
+    } else if (meshData.indexes.empty()) {
+        generateNormals();
+    }
+    if (meshData.floors.size() == meshData.vertices.size()) {
+        floors = new float[numVertices];
+        for (int i = 0; i < numVertices; i++) {
+            floors[i] = meshData.floors[i];
+        }
+    }
+    if (!meshData.indexes.empty()) {
+        numIndexes = (int) meshData.indexes.size();
+        indexes = new unsigned int[numIndexes];
+        for (int i = 0; i < numIndexes; i++) {
+            indexes[i] = meshData.indexes[i];
+        }
+    }
+}
+
+size_t Model::getDataSize() {
+    if (vertexes == nullptr) {
+        // Models loaded from a mesh cache only keep the counts, their data went straight to the GPU
+        return (size_t) numVertices * cachedVertexSize + (size_t) numIndexes * sizeof(unsigned int);
+    }
+    size_t size = numVertices * sizeof(Vector3);
+    if (uv_maps != nullptr) size += numVertices * sizeof(Vector2);
+    if (normals != nullptr) size += numVertices * sizeof(Vector3);
+    if (floors != nullptr) size += numVertices * sizeof(float);
+    if (indexes != nullptr) size += numIndexes * sizeof(unsigned int);
+    return size;
 }
 
 void Model::setTexture(Texture *texture) {
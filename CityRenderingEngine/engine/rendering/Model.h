@@ -25,6 +25,7 @@
 #include "Material.h"
 #include "Colour.h"
 #include "Shader.h"
+#include "MeshData.h"
 #include "../ResourcesManager.h"
 
 class Naquadah;
@@ -33,7 +34,12 @@ class Texture;
 class Shader;
 
 enum ModelBuffer {
-    VERTEX_BUFFER, UV_MAP_BUFFER, NORMAL_BUFFER, INDEX_BUFFER, MAX_BUFFER
+    VERTEX_BUFFER, UV_MAP_BUFFER, NORMAL_BUFFER, FLOORS_BUFFER, INDEX_BUFFER, MAX_BUFFER
+};
+
+/* Attribute locations of the per-instance data of instanced draws. The matrix takes four locations, one per column. */
+enum InstanceAttribute {
+    INSTANCE_MATRIX_ATTRIBUTE = MAX_BUFFER, INSTANCE_PARAMS_ATTRIBUTE = MAX_BUFFER + 4
 };
 
 class Model : public Resource {
@@ -43,7 +49,17 @@ public:
     Model(std::string fileName, int name);
     virtual ~Model(void);
 
-    virtual void draw();
+    /*
+     * Draws this Model with the current Shader. If withMaterial is false, the texture of its Material isn't bound,
+     * because whoever is drawing it already did (see RenderQueue).
+     */
+    virtual void draw(bool withMaterial = true);
+
+    /*
+     * Draws numInstances copies of this Model with a single draw call, reading the model matrix and parameters of
+     * each copy from instanceBuffer, which must contain an InstanceData for each instance (see InstanceBatch).
+     */
+    void drawInstanced(GLuint instanceBuffer, int numInstances, bool withMaterial = true);
 
     /* This method should load the specific resource into memory */
     virtual void load();
@@ -56,6 +72,9 @@ public:
 
     void setMaterial(Material *material);
 
+    /* Returns the texture of the Material of this Model, or null if it has none. */
+    Texture *getTexture();
+
     /*
      * Functions to create some primitive models/meshes.
      * This is similar to the Graphics coursework functions,
@@ -88,11 +107,50 @@ public:
     static Model *getOrCreate(int name, const std::vector<Vector3> &vertices, const std::vector<Vector2> &uv_maps,
         const Colour &colour, Texture *texture, bool preLoad);
 
+    /*
+     * Same as above, but takes the mesh as a MeshData, which may also contain normals and indexes. Normals are
+     * generated if the MeshData has none. This can be called from any thread: if preLoad is false, the Model is not
+     * loaded here, but pushed to the UploadQueue, and the render thread will upload it in a later frame. The Model
+     * won't be drawn until then.
+     */
+    static Model *getOrCreate(int name, const MeshData &meshData, const Colour &colour, Texture *texture,
+        bool preLoad);
+
+    /* Returns the number of bytes of vertex data this Model has, or will have, on the GPU. */
+    size_t getDataSize();
+
+    /* The sphere around all vertices of a Model loaded from a file. Only valid once it's loaded. */
+    const Vector3 &getBoundsCentre() const { return boundsCentre; }
+    float getBoundsRadius() const { return boundsRadius; }
+
+    /* Indicates if this Model is waiting on the UploadQueue. Only UploadQueue should set this. */
+    bool isUploadPending() { return uploadPending; }
+    void setUploadPending(bool uploadPending) { this->uploadPending = uploadPending; }
+
     static const int meshTriangleName;
 
 protected:
 
     void bufferData();
+
+    /*
+     * Copies the data of meshData into the arrays of this Model. Normals are generated if the mesh has none and isn't
+     * indexed. The Model must not have any data yet.
+     */
+    void setMeshData(const MeshData &meshData);
+
+    /*
+     * Loads the Model from the mesh cache of its file, uploading the vertex data straight from the mapped cache. The
+     * Model keeps no copy of the data in memory. Returns false if there's no valid cache.
+     */
+    bool loadFromCache();
+
+    /* Loads the .mtl files, and uses the last of materialNames that was found in them as the Material. */
+    void loadMaterials(const std::vector<std::string> &materialLibraries,
+        const std::vector<std::string> &materialNames);
+
+    /* Binds the texture of the Material of this Model to the current Shader, loading it if necessary. */
+    void bindMaterial();
     void generateNormals();
 
     static Model *generateTriangle();
@@ -116,6 +174,9 @@ protected:
     Vector2 *uv_maps;
     Vector3 *normals;
 
+    /* Optional number of floors of each vertex, used by the batched Building meshes. */
+    float *floors;
+
     /* The array containing the indexes information, to map the vertexes, uv_maps and normals to OpenGL. */
     unsigned int *indexes;
 
@@ -124,4 +185,13 @@ protected:
 
     /* The Material used in this model. */
     Material *material;
+
+    Vector3 boundsCentre;
+    float boundsRadius;
+
+    /* The bytes of each vertex of a Model loaded from a mesh cache, with all its attributes. 0 for the others. */
+    int cachedVertexSize;
+
+    /* True while this Model is in the UploadQueue, waiting to be uploaded by the render thread. */
+    bool uploadPending;
 };
\ No newline at end of file
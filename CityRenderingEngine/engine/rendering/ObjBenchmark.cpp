@@ -0,0 +1,104 @@
+#include "ObjBenchmark.h"
+
+#include <algorithm>
+#include <functional>
+#include <cctype>
+#include <cfloat>
+#include "../input/FileIO.h"
+
+bool ObjBenchmark::run(const std::string &fileName, int numIterations) {
+    if (fileName == "" || numIterations <= 0) return true;
+    std::cout << "Benchmarking the OBJ parser with " << fileName << "..." << std::endl;
+    MappedFile file;
+    if (!file.open(fileName) || file.getSize() == 0) {
+        std::cout << "Could not open " << fileName << std::endl;
+        return false;
+    }
+    double megabytes = file.getSize() / (1024.0 * 1024.0);
+    file.close();
+
+    // The best time of each parser is used, so the first run, with the file not in the OS cache yet, doesn't count
+    float bestParserTime = FLT_MAX;
+    float bestLinesTime = FLT_MAX;
+    int parserFaces = 0;
+    int linesFaces = 0;
+    for (int i = 0; i < numIterations; i++) {
+        ProfilingTimer parserTimer(8, 1);
+        parserTimer.startMeasurement();
+        ObjData obj;
+        if (!ObjParser::parseObjFile(fileName, obj)) {
+            std::cout << "Could not parse " << fileName << std::endl;
+            return false;
+        }
+        parserTimer.finishMeasurement();
+        if (parserTimer.getMeasuredTime() < bestParserTime) bestParserTime = parserTimer.getMeasuredTime();
+        parserFaces = (int) obj.mesh.vertices.size() / 3;
+
+        ProfilingTimer linesTimer(9, 1);
+        linesTimer.startMeasurement();
+        linesFaces = parseWithLines(fileName);
+        linesTimer.finishMeasurement();
+        if (linesTimer.getMeasuredTime() < bestLinesTime) bestLinesTime = linesTimer.getMeasuredTime();
+    }
+    std::cout << "OBJ benchmark, " << megabytes << " MB, best of " << numIterations << ":" << std::endl;
+    std::cout << "    ObjParser: " << bestParserTime << "ms, " << megabytes * 1000.0 / bestParserTime << " MB/s, " <<
+        parserFaces << " faces" << std::endl;
+    std::cout << "    lines:     " << bestLinesTime << "ms, " << megabytes * 1000.0 / bestLinesTime << " MB/s, " <<
+        linesFaces << " faces" << std::endl;
+    return true;
+}
+
+int ObjBenchmark::parseWithLines(const std::string &fileName) {
+    std::vector<std::string> lines = FileIO::readTextFile(fileName);
+    std::vector<Vector3> vecVertices;
+    std::vector<Vector2> vecUvMaps;
+    std::vector<Vector3> vecNormals;
+    std::vector<Vector3> vecCorrectVertices;
+    std::vector<Vector2> vecCorrectUvMaps;
+    std::vector<Vector3> vecCorrectNormals;
+    for (unsigned i = 0; i < lines.size(); i++) {
+        std::string line = lines[i];
+        if (line.size() < 2) continue;
+        line.erase(line.begin(), std::find_if(line.begin(), line.end(), std::not1(std::ptr_fun<int, int>(std::isspace))));
+        if (line.size() < 2) continue;
+        float x, y, z;
+        int viX, viY, viZ, niX, niY, niZ, tiX, tiY, tiZ;
+        if (line[0] == 'v' && line[1] == ' ') {
+            sscanf(line.c_str(), "v %f %f %f", &x, &y, &z);
+            vecVertices.emplace_back(Vector3(x, y, z));
+        } else if (line[0] == 'v' && line[1] == 'n') {
+            sscanf(line.c_str(), "vn %f %f %f", &x, &y, &z);
+            vecNormals.emplace_back(Vector3(x, y, z));
+        } else if (line[0] == 'v' && line[1] == 't') {
+            sscanf(line.c_str(), "vt %f %f", &x, &y);
+            vecUvMaps.emplace_back(Vector2(x, y));
+        } else if (line[0] == 'f' && std::count(line.begin(), line.end(), ' ') == 3) {
+            if (line.find("//") != std::string::npos) {
+                if (sscanf(line.c_str(), "f %d//%d %d//%d %d//%d", &viX, &niX, &viY, &niY, &viZ, &niZ) != 6) continue;
+                vecCorrectNormals.emplace_back(vecNormals.at(niX - 1));
+                vecCorrectNormals.emplace_back(vecNormals.at(niY - 1));
+                vecCorrectNormals.emplace_back(vecNormals.at(niZ - 1));
+            } else if (std::count(line.begin(), line.end(), '/') == 6) {
+                if (sscanf(line.c_str(), "f %d/%d/%d %d/%d/%d %d/%d/%d", &viX, &tiX, &niX, &viY, &tiY, &niY, &viZ,
+                    &tiZ, &niZ) != 9) continue;
+                vecCorrectUvMaps.emplace_back(vecUvMaps.at(tiX - 1));
+                vecCorrectUvMaps.emplace_back(vecUvMaps.at(tiY - 1));
+                vecCorrectUvMaps.emplace_back(vecUvMaps.at(tiZ - 1));
+                vecCorrectNormals.emplace_back(vecNormals.at(niX - 1));
+                vecCorrectNormals.emplace_back(vecNormals.at(niY - 1));
+                vecCorrectNormals.emplace_back(vecNormals.at(niZ - 1));
+            } else if (line.find("/") != std::string::npos) {
+                if (sscanf(line.c_str(), "f %d/%d %d/%d %d/%d", &viX, &tiX, &viY, &tiY, &viZ, &tiZ) != 6) continue;
+                vecCorrectUvMaps.emplace_back(vecUvMaps.at(tiX - 1));
+                vecCorrectUvMaps.emplace_back(vecUvMaps.at(tiY - 1));
+                vecCorrectUvMaps.emplace_back(vecUvMaps.at(tiZ - 1));
+            } else if (sscanf(line.c_str(), "f %d %d %d", &viX, &viY, &viZ) != 3) {
+                continue;
+            }
+            vecCorrectVertices.emplace_back(vecVertices.at(viX - 1));
+            vecCorrectVertices.emplace_back(vecVertices.at(viY - 1));
+            vecCorrectVertices.emplace_back(vecVertices.at(viZ - 1));
+        }
+    }
+    return (int) vecCorrectVertices.size() / 3;
+}
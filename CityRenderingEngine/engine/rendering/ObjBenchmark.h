@@ -0,0 +1,32 @@
+/*
+ * Description: Measures the throughput of ObjParser on a .obj file, in MB/s, against the line based parser the Model
+ * used before it (the whole file read into a vector of strings, each line trimmed and read with sscanf). Both parse the
+ * file several times, and the best time of each is printed on the console, together with the number of faces read, so
+ * any mismatch between them is visible.
+ *
+ * The benchmark runs on the calling thread, before the game starts, if the "objBenchmark" configuration is set to the
+ * path of a .obj file. Bigger files give more reliable numbers.
+ * This is an instance-less class.
+ */
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include "ObjParser.h"
+#include "../ProfilingTimer.h"
+
+class ObjBenchmark {
+public:
+
+    /* Parses fileName numIterations times with each parser. Returns false if the file couldn't be parsed. */
+    static bool run(const std::string &fileName, int numIterations = 10);
+
+protected:
+
+    /* The old parser, kept only as the baseline. Returns the number of triangle faces read. */
+    static int parseWithLines(const std::string &fileName);
+
+    ObjBenchmark(void) {}
+    ~ObjBenchmark(void) {}
+};
@@ -0,0 +1,229 @@
+#include "ObjParser.h"
+#include "../input/FileIO.h"
+
+/* Powers of 10 used to scale the parsed numbers, up to the precision a double can hold. */
+static const double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const int MAX_POWER_OF_TEN = 22;
+
+bool ObjParser::parseObjFile(const std::string &fileName, ObjData &obj) {
+    MappedFile file;
+    if (!file.open(fileName)) return false;
+    return parseObj(file.getData(), file.getSize(), obj);
+}
+
+bool ObjParser::parseObj(const char *data, size_t size, ObjData &obj) {
+    // To store the vertexes, uvmaps and normals, indexed by the faces
+    std::vector<Vector3> vertices;
+    std::vector<Vector2> uvMaps;
+    std::vector<Vector3> normals;
+    // A rough guess from the size of the file avoids most of the reallocations on big files
+    vertices.reserve(size / 128);
+    obj.mesh.vertices.reserve(size / 64);
+
+    const char *position = data;
+    const char *end = data + size;
+    TextToken line;
+    while (readLine(position, end, line)) {
+        if (line.size() < 2) continue;
+        const char *it = line.begin;
+        TextToken keyword;
+        readWord(it, line.end, keyword);
+        if (keyword.equals("v")) {
+            Vector3 vertex;
+            readFloat(it, line.end, vertex.x);
+            readFloat(it, line.end, vertex.y);
+            readFloat(it, line.end, vertex.z);
+            vertices.push_back(vertex);
+        } else if (keyword.equals("vt")) {
+            Vector2 uvMap;
+            readFloat(it, line.end, uvMap.x);
+            readFloat(it, line.end, uvMap.y);
+            uvMaps.push_back(uvMap);
+        } else if (keyword.equals("vn")) {
+            Vector3 normal;
+            readFloat(it, line.end, normal.x);
+            readFloat(it, line.end, normal.y);
+            readFloat(it, line.end, normal.z);
+            normals.push_back(normal);
+        } else if (keyword.equals("f")) {
+            int vertexIndex[3], uvMapIndex[3], normalIndex[3];
+            int numCorners = 0;
+            int v, t, n;
+            while (readFaceCorner(it, line.end, v, t, n)) {
+                if (numCorners < 3) {
+                    vertexIndex[numCorners] = v;
+                    uvMapIndex[numCorners] = t;
+                    normalIndex[numCorners] = n;
+                }
+                numCorners++;
+            }
+            // Only triangles are supported, any other face is skipped
+            if (numCorners != 3) continue;
+            for (int c = 0; c < 3; c++) {
+                if (vertexIndex[c] < 1 || vertexIndex[c] > (int) vertices.size()) return false;
+                obj.mesh.vertices.push_back(vertices[vertexIndex[c] - 1]);
+                if (uvMapIndex[c] != 0) {
+                    if (uvMapIndex[c] < 1 || uvMapIndex[c] > (int) uvMaps.size()) return false;
+                    obj.mesh.uv_maps.push_back(uvMaps[uvMapIndex[c] - 1]);
+                }
+                if (normalIndex[c] != 0) {
+                    if (normalIndex[c] < 1 || normalIndex[c] > (int) normals.size()) return false;
+                    obj.mesh.normals.push_back(normals[normalIndex[c] - 1]);
+                }
+            }
+        } else if (keyword.equals("usemtl")) {
+            obj.materialNames.push_back(readRest(it, line.end).toString());
+        } else if (keyword.equals("mtllib")) {
+            obj.materialLibraries.push_back(readRest(it, line.end).toString());
+        }
+    }
+    // The faces that have uv_maps or normals must be all of them, or they won't match the vertexes anymore
+    if (obj.mesh.uv_maps.size() != obj.mesh.vertices.size()) obj.mesh.uv_maps.clear();
+    if (obj.mesh.normals.size() != obj.mesh.vertices.size()) obj.mesh.normals.clear();
+    return true;
+}
+
+bool ObjParser::readLine(const char *&position, const char *end, TextToken &line) {
+    while (position != end && (isSpace(*position) || *position == '\n')) {
+        ++position;
+    }
+    if (position == end) return false;
+    line.begin = position;
+    while (position != end && *position != '\n') {
+        ++position;
+    }
+    line.end = position;
+    while (line.end != line.begin && isSpace(*(line.end - 1))) {
+        --line.end;
+    }
+    return true;
+}
+
+bool ObjParser::readWord(const char *&position, const char *end, TextToken &word) {
+    while (position != end && isSpace(*position)) {
+        ++position;
+    }
+    word.begin = position;
+    while (position != end && !isSpace(*position) && *position != '\n') {
+        ++position;
+    }
+    word.end = position;
+    return !word.isEmpty();
+}
+
+TextToken ObjParser::readRest(const char *position, const char *end) {
+    TextToken rest;
+    while (position != end && isSpace(*position)) {
+        ++position;
+    }
+    rest.begin = position;
+    rest.end = end;
+    while (rest.end != rest.begin && isSpace(*(rest.end - 1))) {
+        --rest.end;
+    }
+    return rest;
+}
+
+bool ObjParser::readFloat(const char *&position, const char *end, float &value) {
+    const char *it = position;
+    while (it != end && isSpace(*it)) {
+        ++it;
+    }
+    bool negative = false;
+    if (it != end && (*it == '-' || *it == '+')) {
+        negative = *it == '-';
+        ++it;
+    }
+    // The digits are accumulated as an integer, and only scaled once at the end, so no precision is lost on the way
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    int numDigits = 0;
+    for (; it != end && isDigit(*it); ++it, ++numDigits) {
+        if (mantissa < 100000000000000000ULL) {
+            mantissa = mantissa * 10 + (*it - '0');
+        } else {
+            exponent++;
+        }
+    }
+    if (it != end && *it == '.') {
+        ++it;
+        for (; it != end && isDigit(*it); ++it, ++numDigits) {
+            if (mantissa < 100000000000000000ULL) {
+                mantissa = mantissa * 10 + (*it - '0');
+                exponent--;
+            }
+        }
+    }
+    if (numDigits == 0) return false;
+    if (it != end && (*it == 'e' || *it == 'E')) {
+        const char *exponentStart = it;
+        ++it;
+        bool negativeExponent = false;
+        if (it != end && (*it == '-' || *it == '+')) {
+            negativeExponent = *it == '-';
+            ++it;
+        }
+        if (it != end && isDigit(*it)) {
+            int writtenExponent = 0;
+            for (; it != end && isDigit(*it); ++it) {
+                if (writtenExponent < 1000) writtenExponent = writtenExponent * 10 + (*it - '0');
+            }
+            exponent += negativeExponent ? -writtenExponent : writtenExponent;
+        } else {
+            it = exponentStart; // Not an exponent after all, leave the 'e' to whoever reads next
+        }
+    }
+    double result = (double) mantissa;
+    while (exponent > MAX_POWER_OF_TEN) {
+        result *= POWERS_OF_TEN[MAX_POWER_OF_TEN];
+        exponent -= MAX_POWER_OF_TEN;
+    }
+    while (exponent < -MAX_POWER_OF_TEN) {
+        result /= POWERS_OF_TEN[MAX_POWER_OF_TEN];
+        exponent += MAX_POWER_OF_TEN;
+    }
+    result = exponent >= 0 ? result * POWERS_OF_TEN[exponent] : result / POWERS_OF_TEN[-exponent];
+    value = (float) (negative ? -result : result);
+    position = it;
+    return true;
+}
+
+bool ObjParser::readInt(const char *&position, const char *end, int &value) {
+    const char *it = position;
+    while (it != end && isSpace(*it)) {
+        ++it;
+    }
+    bool negative = false;
+    if (it != end && (*it == '-' || *it == '+')) {
+        negative = *it == '-';
+        ++it;
+    }
+    if (it == end || !isDigit(*it)) return false;
+    int result = 0;
+    for (; it != end && isDigit(*it); ++it) {
+        result = result * 10 + (*it - '0');
+    }
+    value = negative ? -result : result;
+    position = it;
+    return true;
+}
+
+bool ObjParser::readFaceCorner(const char *&position, const char *end, int &vertex, int &uvMap, int &normal) {
+    uvMap = 0;
+    normal = 0;
+    if (!readInt(position, end, vertex)) return false;
+    if (position == end || *position != '/') return true;
+    ++position;
+    if (position == end) return false;
+    if (*position != '/') {
+        // v/t or v/t/n
+        if (!readInt(position, end, uvMap)) return false;
+        if (position == end || *position != '/') return true;
+    }
+    // v//n or v/t/n
+    ++position;
+    return readInt(position, end, normal);
+}
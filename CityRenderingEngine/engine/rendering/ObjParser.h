@@ -0,0 +1,87 @@
+/*
+ * Description: Single pass parser for .obj and .mtl files. The file is mapped into memory (see MappedFile) and read in
+ * place: lines and words are TextTokens that point into the file, and numbers are converted straight from the file's
+ * characters, without creating a std::string for each line or going through sscanf.
+ *
+ * The .obj parser supports the same subset used by the engine so far: v, vt, vn, triangle faces (f) in any of the
+ * v, v/t, v//n and v/t/n forms, usemtl and mtllib. Faces that aren't triangles are ignored. The faces are expanded into
+ * a MeshData, one vertex per corner, ready to be indexed by MeshData::optimise(). The tokenizer functions are public,
+ * so the .mtl parser in Material uses them too.
+ * This is an instance-less class.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "MeshData.h"
+
+/* A piece of text inside a buffer, like a word or a line of a file. It doesn't own or copy the text. */
+struct TextToken {
+    const char *begin;
+    const char *end;
+
+    size_t size() const { return end - begin; }
+    bool isEmpty() const { return begin == end; }
+
+    /* Compares the token to a null terminated string. */
+    bool equals(const char *text) const {
+        const char *it = begin;
+        for (; it != end && *text != '\0'; ++it, ++text) {
+            if (*it != *text) return false;
+        }
+        return it == end && *text == '\0';
+    }
+
+    std::string toString() const { return std::string(begin, end); }
+};
+
+/* Everything read from a .obj file. */
+struct ObjData {
+    /* The vertices of all faces, 3 per face. uv_maps and normals are only filled if all faces have them. */
+    MeshData mesh;
+    /* The .mtl files referenced by mtllib, in the order they appear. */
+    std::vector<std::string> materialLibraries;
+    /* The materials selected by usemtl, in the order they appear. */
+    std::vector<std::string> materialNames;
+};
+
+class ObjParser {
+public:
+
+    /* Maps and parses a .obj file into obj. Returns false if the file can't be read or has invalid indexes. */
+    static bool parseObjFile(const std::string &fileName, ObjData &obj);
+
+    /* Parses a .obj file already in memory. data doesn't need to be null terminated. */
+    static bool parseObj(const char *data, size_t size, ObjData &obj);
+
+    /*
+     * Reads the next line from position, without its line break and leading whitespaces, and moves position to the
+     * start of the following one. Returns false when there are no more lines.
+     */
+    static bool readLine(const char *&position, const char *end, TextToken &line);
+
+    /* Reads the next word, skipping the whitespaces before it. Returns false if there are no more words. */
+    static bool readWord(const char *&position, const char *end, TextToken &word);
+
+    /*
+     * Reads the rest of the text after skipping the whitespaces, without the trailing ones. Used for names, like file
+     * names, that may contain spaces.
+     */
+    static TextToken readRest(const char *position, const char *end);
+
+    /* Reads a decimal number, skipping the whitespaces before it. Returns false if there's no number there. */
+    static bool readFloat(const char *&position, const char *end, float &value);
+    static bool readInt(const char *&position, const char *end, int &value);
+
+protected:
+
+    /* Reads one corner of a face, filling with 0 the indexes that it doesn't have. */
+    static bool readFaceCorner(const char *&position, const char *end, int &vertex, int &uvMap, int &normal);
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    ObjParser(void) {}
+    ~ObjParser(void) {}
+};
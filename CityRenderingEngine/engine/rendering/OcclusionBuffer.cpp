@@ -0,0 +1,162 @@
+#include "OcclusionBuffer.h"
+
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#define OCCLUSION_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+const float OcclusionBuffer::MIN_W = 1.0f;
+const float OcclusionBuffer::DEPTH_BIAS = 1.001f;
+
+OcclusionBuffer::OcclusionBuffer(void) {
+    this->depth = std::vector<float>(BUFFER_WIDTH * BUFFER_HEIGHT, 0.0f);
+    this->occluders = this->tested = this->culled = 0;
+    this->lastFrameOccluders = this->lastFrameTested = this->lastFrameCulled = 0;
+}
+
+void OcclusionBuffer::begin(const Matrix4 &viewProjection) {
+    this->viewProjection = viewProjection;
+    std::fill(depth.begin(), depth.end(), 0.0f);
+    lastFrameOccluders = occluders;
+    lastFrameTested = tested;
+    lastFrameCulled = culled;
+    occluders = tested = culled = 0;
+}
+
+void OcclusionBuffer::addOccluderTriangle(const Vector3 &a, const Vector3 &b, const Vector3 &c) {
+    ProjectedVertex v0, v1, v2;
+    if (project(a, v0) && project(b, v1) && project(c, v2)) {
+        rasterizeTriangle(v0, v1, v2);
+    }
+}
+
+void OcclusionBuffer::addOccluderPrism(const std::vector<Vector2> &footprint, float bottom, float top) {
+    int numSides = (int) footprint.size();
+    if (numSides < 3) return;
+    occluders++;
+    for (int i = 0; i < numSides; i++) {
+        const Vector2 &a2 = footprint[i];
+        const Vector2 &b2 = footprint[(i + 1) % numSides];
+        Vector3 a = Vector3(a2.x, top, a2.y);    // A ---- B
+        Vector3 b = Vector3(b2.x, top, b2.y);    // |      |
+        Vector3 c = Vector3(a2.x, bottom, a2.y); // |      |
+        Vector3 d = Vector3(b2.x, bottom, b2.y); // C ---- D
+        addOccluderTriangle(a, b, d);
+        addOccluderTriangle(a, d, c);
+    }
+}
+
+bool OcclusionBuffer::isBoxOccluded(const BoundingBox &box) {
+    if (box.isEmpty()) return false;
+    tested++;
+    // Project the 8 corners and find the screen rectangle they cover, and the closest depth
+    float minX = (float) BUFFER_WIDTH, minY = (float) BUFFER_HEIGHT, maxX = 0.0f, maxY = 0.0f, nearest = 0.0f;
+    for (int i = 0; i < 8; i++) {
+        Vector3 corner = Vector3((i & 1) ? box.maxPos.x : box.minPos.x, (i & 2) ? box.maxPos.y : box.minPos.y,
+            (i & 4) ? box.maxPos.z : box.minPos.z);
+        ProjectedVertex projected;
+        if (!project(corner, projected)) return false;
+        minX = min(minX, projected.x);
+        minY = min(minY, projected.y);
+        maxX = max(maxX, projected.x);
+        maxY = max(maxY, projected.y);
+        nearest = max(nearest, projected.z);
+    }
+    int x0 = max(0, (int) floor(minX));
+    int y0 = max(0, (int) floor(minY));
+    int x1 = min(BUFFER_WIDTH - 1, (int) ceil(maxX));
+    int y1 = min(BUFFER_HEIGHT - 1, (int) ceil(maxY));
+    if (x0 > x1 || y0 > y1) return false; // Off screen, the Frustum should deal with it
+    nearest *= DEPTH_BIAS;
+    for (int y = y0; y <= y1; y++) {
+        const float *row = &depth[y * BUFFER_WIDTH];
+        for (int x = x0; x <= x1; x++) {
+            if (row[x] <= nearest) return false;
+        }
+    }
+    culled++;
+    return true;
+}
+
+bool OcclusionBuffer::project(const Vector3 &point, ProjectedVertex &projected) {
+    const float *m = viewProjection.values;
+    float w = m[3] * point.x + m[7] * point.y + m[11] * point.z + m[15];
+    if (w < MIN_W) return false;
+    float invW = 1.0f / w;
+    float x = (m[0] * point.x + m[4] * point.y + m[8] * point.z + m[12]) * invW;
+    float y = (m[1] * point.x + m[5] * point.y + m[9] * point.z + m[13]) * invW;
+    projected.x = (x * 0.5f + 0.5f) * BUFFER_WIDTH;
+    projected.y = (y * 0.5f + 0.5f) * BUFFER_HEIGHT;
+    projected.z = invW;
+    return true;
+}
+
+void OcclusionBuffer::rasterizeTriangle(const ProjectedVertex &v0, const ProjectedVertex &v1,
+    const ProjectedVertex &v2) {
+    float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+    if (fabs(area) < 0.0001f) return;
+    // Walls are seen from both sides, so flip the triangles facing away instead of culling them
+    const ProjectedVertex &a = v0;
+    const ProjectedVertex &b = area > 0 ? v1 : v2;
+    const ProjectedVertex &c = area > 0 ? v2 : v1;
+    area = fabs(area);
+
+    // Edge functions in the form e(x, y) = ex * x + ey * y + e0, positive inside the triangle
+    float e0x = a.y - b.y, e0y = b.x - a.x, e00 = a.x * b.y - a.y * b.x; // Edge AB, weight of C
+    float e1x = b.y - c.y, e1y = c.x - b.x, e10 = b.x * c.y - b.y * c.x; // Edge BC, weight of A
+    float e2x = c.y - a.y, e2y = a.x - c.x, e20 = c.x * a.y - c.y * a.x; // Edge CA, weight of B
+    // The depth is interpolated with the edge functions, as barycentric coordinates
+    float zx = (e1x * a.z + e2x * b.z + e0x * c.z) / area;
+    float zy = (e1y * a.z + e2y * b.z + e0y * c.z) / area;
+    float z0 = (e10 * a.z + e20 * b.z + e00 * c.z) / area;
+
+    int minX = max(0, (int) floor(min(a.x, min(b.x, c.x))));
+    int maxX = min(BUFFER_WIDTH - 1, (int) ceil(max(a.x, max(b.x, c.x))));
+    int minY = max(0, (int) floor(min(a.y, min(b.y, c.y))));
+    int maxY = min(BUFFER_HEIGHT - 1, (int) ceil(max(a.y, max(b.y, c.y))));
+    if (minX > maxX || minY > maxY) return;
+    minX &= ~3; // Start aligned to a group of 4 pixels
+
+#ifdef OCCLUSION_USE_SSE
+    __m128 zero = _mm_setzero_ps();
+    __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    __m128 e0xStep = _mm_set1_ps(e0x * 4.0f), e1xStep = _mm_set1_ps(e1x * 4.0f), e2xStep = _mm_set1_ps(e2x * 4.0f);
+    __m128 zxStep = _mm_set1_ps(zx * 4.0f);
+    for (int y = minY; y <= maxY; y++) {
+        float py = y + 0.5f;
+        __m128 px = _mm_add_ps(_mm_set1_ps((float) minX), offsets);
+        // Values of the edge functions and the depth on the first 4 pixels of the row
+        __m128 w0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e0x), px), _mm_set1_ps(e0y * py + e00));
+        __m128 w1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e1x), px), _mm_set1_ps(e1y * py + e10));
+        __m128 w2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e2x), px), _mm_set1_ps(e2y * py + e20));
+        __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(zx), px), _mm_set1_ps(zy * py + z0));
+        float *row = &depth[y * BUFFER_WIDTH];
+        for (int x = minX; x <= maxX; x += 4) {
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)),
+                _mm_cmpge_ps(w2, zero));
+            if (_mm_movemask_ps(inside) != 0) {
+                __m128 current = _mm_loadu_ps(row + x);
+                __m128 closest = _mm_max_ps(current, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closest), _mm_andnot_ps(inside, current)));
+            }
+            w0 = _mm_add_ps(w0, e0xStep);
+            w1 = _mm_add_ps(w1, e1xStep);
+            w2 = _mm_add_ps(w2, e2xStep);
+            z = _mm_add_ps(z, zxStep);
+        }
+    }
+#else
+    for (int y = minY; y <= maxY; y++) {
+        float py = y + 0.5f;
+        float *row = &depth[y * BUFFER_WIDTH];
+        for (int x = minX; x <= maxX; x++) {
+            float px = x + 0.5f;
+            if (e0x * px + e0y * py + e00 >= 0 && e1x * px + e1y * py + e10 >= 0 && e2x * px + e2y * py + e20 >= 0) {
+                row[x] = max(row[x], zx * px + zy * py + z0);
+            }
+        }
+    }
+#endif
+}
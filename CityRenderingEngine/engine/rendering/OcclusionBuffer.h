@@ -0,0 +1,84 @@
+/*
+ * Description: A small depth buffer rasterized on the CPU, used to skip objects that are hidden behind big occluders,
+ * like tall Buildings seen from the street. Each frame, the Scene clears the buffer with begin() and rasterizes a few
+ * large occluders into it. Before drawing an object, its BoundingBox is projected to the screen and compared with the
+ * depth stored on the pixels it covers: if all of them hold something closer, the object is hidden.
+ *
+ * The buffer stores 1 / w for each pixel, which varies linearly over the screen, so the depth can be interpolated
+ * directly between the vertices of each triangle. Bigger values are closer to the camera, and an empty pixel is zero.
+ * The triangles are rasterized four pixels at a time with SSE, when it's available.
+ *
+ * Occluder triangles that cross the near plane are simply skipped, and boxes that cross it are always visible, so the
+ * buffer never hides something it shouldn't because of clipping.
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include "../math/Common.h"
+#include "../math/Matrix4.h"
+#include "../math/Vector2.h"
+#include "../math/Vector3.h"
+#include "../math/BoundingBox.h"
+
+class OcclusionBuffer {
+public:
+
+    /* Size of the buffer, in pixels. The width must be a multiple of 4. */
+    static const int BUFFER_WIDTH = 256;
+    static const int BUFFER_HEIGHT = 144;
+
+    OcclusionBuffer(void);
+    ~OcclusionBuffer(void) {}
+
+    /* Clears the buffer and sets the view projection matrix of the frame. Closes the counters of the last frame. */
+    void begin(const Matrix4 &viewProjection);
+
+    /* Rasterizes a triangle, in world coordinates, into the buffer. */
+    void addOccluderTriangle(const Vector3 &a, const Vector3 &b, const Vector3 &c);
+
+    /*
+     * Rasterizes the walls of a prism with the XZ polygon footprint, from the height bottom to top. This is the shape
+     * of the custom Buildings. The roof is left out, as it's rarely what's hiding something from the street.
+     */
+    void addOccluderPrism(const std::vector<Vector2> &footprint, float bottom, float top);
+
+    /* Returns true if box is completely hidden by the occluders rasterized this frame. */
+    bool isBoxOccluded(const BoundingBox &box);
+
+    /* Returns the counters of the last complete frame. */
+    int getLastFrameOccluders() { return lastFrameOccluders; }
+    int getLastFrameTested() { return lastFrameTested; }
+    int getLastFrameCulled() { return lastFrameCulled; }
+
+protected:
+
+    /* A vertex already projected to the buffer: pixel coordinates and 1 / w. */
+    struct ProjectedVertex {
+        float x, y, z;
+    };
+
+    /* Projects point to the buffer. Returns false if it's too close to, or behind, the camera. */
+    bool project(const Vector3 &point, ProjectedVertex &projected);
+
+    void rasterizeTriangle(const ProjectedVertex &v0, const ProjectedVertex &v1, const ProjectedVertex &v2);
+
+    /* Points closer than this w are considered to be crossing the near plane. */
+    static const float MIN_W;
+    /* Occluded boxes must be this much farther than the occluders, to avoid errors on boxes that touch them. */
+    static const float DEPTH_BIAS;
+
+    /* The depth of each pixel, stored as 1 / w, BUFFER_WIDTH * BUFFER_HEIGHT values. */
+    std::vector<float> depth;
+
+    Matrix4 viewProjection;
+
+    /* Counters of the current frame and of the last complete one. */
+    int occluders;
+    int tested;
+    int culled;
+    int lastFrameOccluders;
+    int lastFrameTested;
+    int lastFrameCulled;
+};
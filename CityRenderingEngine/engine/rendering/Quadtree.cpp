@@ -0,0 +1,103 @@
+#include "Quadtree.h"
+
+Quadtree::Quadtree(const BoundingBox &region, int maxDepth) {
+    this->maxDepth = maxDepth;
+    this->root = createNode(region);
+}
+
+Quadtree::~Quadtree(void) {
+    if (root != nullptr) {
+        deleteNode(root);
+        root = nullptr;
+    }
+}
+
+void Quadtree::insert(Entity *entity, const BoundingBox &box) {
+    if (box.isEmpty()) return;
+    QuadtreeNode *node = root;
+    for (int depth = 0; depth <= maxDepth; depth++) {
+        node->bounds.addBox(box);
+        if (depth == maxDepth) break;
+        // Find the quadrant that completely contains the box, if any
+        Vector3 centre = node->region.getCentre();
+        int quadrant = -1;
+        if (box.maxPos.x <= centre.x || box.minPos.x >= centre.x) {
+            if (box.maxPos.z <= centre.z || box.minPos.z >= centre.z) {
+                quadrant = (box.minPos.x >= centre.x ? 1 : 0) + (box.minPos.z >= centre.z ? 2 : 0);
+            }
+        }
+        if (quadrant < 0 || !node->region.containsXZ(box)) break;
+        if (node->children[quadrant] == nullptr) {
+            BoundingBox childRegion = node->region;
+            if (quadrant & 1) childRegion.minPos.x = centre.x; else childRegion.maxPos.x = centre.x;
+            if (quadrant & 2) childRegion.minPos.z = centre.z; else childRegion.maxPos.z = centre.z;
+            node->children[quadrant] = createNode(childRegion);
+        }
+        node = node->children[quadrant];
+    }
+    node->entities.push_back(entity);
+    node->boxes.push_back(box);
+}
+
+void Quadtree::clear() {
+    BoundingBox region = root->region;
+    deleteNode(root);
+    root = createNode(region);
+}
+
+void Quadtree::collectVisible(Frustum *frustum, unsigned char planeMask, std::vector<Entity*> &visible) {
+    collectVisible(root, frustum, planeMask, visible);
+}
+
+QuadtreeNode *Quadtree::createNode(const BoundingBox &region) {
+    QuadtreeNode *node = new QuadtreeNode();
+    node->region = region;
+    for (int i = 0; i < 4; i++) {
+        node->children[i] = nullptr;
+    }
+    return node;
+}
+
+void Quadtree::deleteNode(QuadtreeNode *node) {
+    for (int i = 0; i < 4; i++) {
+        if (node->children[i] != nullptr) {
+            deleteNode(node->children[i]);
+        }
+    }
+    delete node;
+}
+
+void Quadtree::collectVisible(QuadtreeNode *node, Frustum *frustum, unsigned char planeMask,
+    std::vector<Entity*> &visible) {
+    if (node->bounds.isEmpty()) return;
+    if (planeMask != 0) {
+        FrustumTest result = frustum->testBox(node->bounds, planeMask);
+        if (result == FRUSTUM_OUTSIDE) return;
+    }
+    if (planeMask == 0) {
+        // Completely inside the Frustum, so is everything below it
+        collectAll(node, visible);
+        return;
+    }
+    int numEntities = (int) node->entities.size();
+    for (int i = 0; i < numEntities; i++) {
+        unsigned char entityMask = planeMask;
+        if (frustum->testBox(node->boxes[i], entityMask) != FRUSTUM_OUTSIDE) {
+            visible.push_back(node->entities[i]);
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        if (node->children[i] != nullptr) {
+            collectVisible(node->children[i], frustum, planeMask, visible);
+        }
+    }
+}
+
+void Quadtree::collectAll(QuadtreeNode *node, std::vector<Entity*> &visible) {
+    visible.insert(visible.end(), node->entities.begin(), node->entities.end());
+    for (int i = 0; i < 4; i++) {
+        if (node->children[i] != nullptr) {
+            collectAll(node->children[i], visible);
+        }
+    }
+}
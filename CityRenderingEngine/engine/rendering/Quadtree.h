@@ -0,0 +1,66 @@
+/*
+ * Description: A quadtree of Entities over the XZ plane, used to cull groups of Entities against the view Frustum
+ * with a single test. Each Entity is inserted with its BoundingBox, and is stored on the deepest node whose region
+ * completely contains it. Each node keeps the bounds of everything stored on it and below it, so a node that's
+ * outside the Frustum rejects its whole subtree at once, and a node that's completely inside it accepts its whole
+ * subtree without any more tests.
+ *
+ * The tree doesn't own the Entities, and must be rebuilt when the Entities are added, removed or moved.
+ */
+
+#pragma once
+
+#include <vector>
+#include "Frustum.h"
+#include "../Entity.h"
+#include "../math/BoundingBox.h"
+
+class Entity;
+class Frustum;
+
+/* A node of the Quadtree. Children are only created when an Entity is inserted into them. */
+struct QuadtreeNode {
+    /* The XZ region covered by this node. */
+    BoundingBox region;
+    /* The bounds of all Entities stored on this node and on its children. */
+    BoundingBox bounds;
+    /* The Entities that don't fit completely into any of the children, and their boxes. */
+    std::vector<Entity*> entities;
+    std::vector<BoundingBox> boxes;
+    QuadtreeNode *children[4];
+};
+
+class Quadtree {
+public:
+
+    /* Creates an empty tree covering region, with at most maxDepth levels below the root. */
+    Quadtree(const BoundingBox &region, int maxDepth);
+    ~Quadtree(void);
+
+    /*
+     * Inserts entity with its world space box. Entities outside the region of the tree are kept on the root, and
+     * Entities with an empty box are ignored.
+     */
+    void insert(Entity *entity, const BoundingBox &box);
+
+    /* Removes all Entities and nodes from the tree. */
+    void clear();
+
+    /*
+     * Appends to visible the Entities whose boxes aren't outside frustum. planeMask is the mask of the parent volume,
+     * or Frustum::ALL_PLANES to test all planes.
+     */
+    void collectVisible(Frustum *frustum, unsigned char planeMask, std::vector<Entity*> &visible);
+
+protected:
+
+    QuadtreeNode *createNode(const BoundingBox &region);
+    void deleteNode(QuadtreeNode *node);
+    void collectVisible(QuadtreeNode *node, Frustum *frustum, unsigned char planeMask, std::vector<Entity*> &visible);
+
+    /* Appends all Entities of node and its children to visible, without testing them. */
+    void collectAll(QuadtreeNode *node, std::vector<Entity*> &visible);
+
+    QuadtreeNode *root;
+    int maxDepth;
+};
@@ -0,0 +1,144 @@
+#include "RenderQueue.h"
+
+#include <cstring>
+#include "Shader.h"
+#include "Model.h"
+#include "Texture.h"
+#include "InstanceBatch.h"
+#include "../Scene.h"
+
+RenderQueue::RenderQueue(void) {
+    this->items = new std::vector<RenderItem>();
+    this->items->reserve(1024);
+    this->cameraPosition = Vector3();
+    this->lastFrameItems = 0;
+    this->lastFrameShaderChanges = 0;
+    this->lastFrameTextureChanges = 0;
+}
+
+RenderQueue::~RenderQueue(void) {
+    if (items != nullptr) {
+        delete items;
+        items = nullptr;
+    }
+}
+
+void RenderQueue::begin(const Vector3 &cameraPosition) {
+    this->cameraPosition = cameraPosition;
+    items->clear();
+}
+
+RenderItem &RenderQueue::addModel(Shader *shader, Model *model, Texture *texture, const Matrix4 &modelMatrix,
+    const Vector3 &position, bool translucent) {
+    if (texture == nullptr) {
+        texture = model->getTexture();
+    }
+    RenderItem &item = addItem(shader, model, texture, position, translucent);
+    item.modelMatrix = &modelMatrix;
+    return item;
+}
+
+RenderItem &RenderQueue::addInstanceBatch(Shader *shader, InstanceBatch *instanceBatch, const Vector3 &position,
+    bool translucent) {
+    Model *model = instanceBatch->getModel();
+    RenderItem &item = addItem(shader, model, model->getTexture(), position, translucent);
+    item.instanceBatch = instanceBatch;
+    return item;
+}
+
+RenderItem &RenderQueue::addItem(Shader *shader, Model *model, Texture *texture, const Vector3 &position,
+    bool translucent) {
+    items->push_back(RenderItem());
+    RenderItem &item = items->back();
+    item.shader = shader;
+    item.model = model;
+    item.instanceBatch = nullptr;
+    item.texture = texture;
+    item.modelMatrix = nullptr;
+    item.parameter = NO_PARAMETER;
+    item.parameterValue.intValue = 0;
+    item.sortKey = calculateSortKey(item, (position - cameraPosition).getLength(), translucent);
+    return item;
+}
+
+unsigned long long RenderQueue::calculateSortKey(const RenderItem &item, float distance, bool translucent) {
+    // The resource names are used instead of the OpenGL ids, as they're known before the resources are loaded
+    unsigned long long shaderId = item.shader != nullptr ? (item.shader->getName() & 0x3FF) : 0;
+    unsigned long long textureId = item.texture != nullptr ? (item.texture->getName() & 0xFFF) : 0;
+    unsigned long long modelId = item.model != nullptr ? (item.model->getName() & 0xFFF) : 0;
+    // The bits of a positive float keep its order, so the top 28 bits of the distance can be compared as an integer
+    unsigned int distanceBits;
+    memcpy(&distanceBits, &distance, sizeof(float));
+    unsigned long long depth = distanceBits >> 3;
+    if (translucent) {
+        return ((unsigned long long) PASS_TRANSLUCENT << 62) | ((0x0FFFFFFF - depth) << 34) | (shaderId << 24) |
+            (textureId << 12) | modelId;
+    }
+    return ((unsigned long long) PASS_OPAQUE << 62) | (shaderId << 52) | (textureId << 40) | (modelId << 28) | depth;
+}
+
+void RenderQueue::submit(Scene *scene) {
+    std::sort(items->begin(), items->end(), RenderQueue::compareBySortKey);
+    Renderer *renderer = Naquadah::getRenderer();
+    Shader *currentShader = nullptr;
+    Texture *currentTexture = nullptr;
+    const Matrix4 *currentMatrix = nullptr;
+    int shaderChanges = 0;
+    int textureChanges = 0;
+    auto itEnd = items->end();
+    for (auto it = items->begin(); it != itEnd; ++it) {
+        if (it->shader != currentShader) {
+            scene->useShader(it->shader);
+            currentShader = it->shader;
+            // The texture uniforms and the model matrix are per program, they have to be set again
+            currentTexture = nullptr;
+            currentMatrix = nullptr;
+            shaderChanges++;
+        }
+        if (currentShader == nullptr || !currentShader->isValid()) continue;
+        if (it->texture != nullptr && it->texture != currentTexture) {
+            if (!it->texture->isLoaded())
+                it->texture->load();
+            if (it->texture->isValid()) {
+                it->texture->bindTexture(currentShader->getShaderProgram(), TEXTURE0);
+                currentTexture = it->texture;
+                textureChanges++;
+            }
+        }
+        if (it->parameter != NO_PARAMETER) {
+            applyParameter(*it);
+            currentShader->updateShaderParameters(false);
+        }
+        if (it->instanceBatch != nullptr) {
+            it->instanceBatch->draw(currentShader, false);
+        } else {
+            if (it->modelMatrix != currentMatrix) {
+                renderer->updateShaderMatrix(UNIFORM_MODEL_MATRIX, it->modelMatrix);
+                currentMatrix = it->modelMatrix;
+            }
+            it->model->draw(false);
+        }
+    }
+    lastFrameItems = (int) items->size();
+    lastFrameShaderChanges = shaderChanges;
+    lastFrameTextureChanges = textureChanges;
+}
+
+void RenderQueue::applyParameter(const RenderItem &item) {
+    ShaderParameter *parameter = item.shader->getShaderParameter(item.parameter);
+    if (parameter == nullptr || parameter->getValue() == nullptr) return;
+    // The value is owned by the parameter, so it's overwritten instead of replaced
+    if (parameter->parameterType == PARAMETER_FLOAT) {
+        float *value = (float*) parameter->getValue();
+        if (*value != item.parameterValue.floatValue) {
+            *value = item.parameterValue.floatValue;
+            parameter->setValueChanged(true);
+        }
+    } else if (parameter->parameterType == PARAMETER_INT) {
+        int *value = (int*) parameter->getValue();
+        if (*value != item.parameterValue.intValue) {
+            *value = item.parameterValue.intValue;
+            parameter->setValueChanged(true);
+        }
+    }
+}
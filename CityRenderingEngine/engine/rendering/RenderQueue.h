@@ -0,0 +1,120 @@
+/*
+ * Description: The RenderQueue collects everything that will be drawn in a frame, and draws it in the order that needs
+ * the fewest OpenGL state changes. The Entities that pass the culling tests add their draw items to it (see
+ * Entity::queueDraw()), and the Scene submits all of them at once, after the whole Scene was traversed.
+ *
+ * Each item has a 64 bit sort key. The opaque items are sorted by Shader, then texture, then Model, and finally by
+ * their distance to the camera, so the Shader and texture only change when they actually have to, and the items that
+ * share them are drawn roughly front to back. The translucent items are drawn after all opaque ones, back to front,
+ * so the distance comes before the state on their key:
+ *
+ *   opaque:      | pass (2) | shader (10) | texture (12) | model (12) | depth (28) |
+ *   translucent: | pass (2) | inverted depth (28) | shader (10) | texture (12) | model (12) |
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include "../math/Matrix4.h"
+#include "../math/Vector3.h"
+#include "ShaderParameter.h"
+
+class Scene;
+class Shader;
+class Model;
+class Texture;
+class InstanceBatch;
+
+/* The passes of the RenderQueue, in the order they're drawn. */
+enum RenderPass {
+    PASS_OPAQUE, PASS_TRANSLUCENT
+};
+
+/* A single draw of the RenderQueue: a Model, or an InstanceBatch, with the state it needs. */
+struct RenderItem {
+    unsigned long long sortKey;
+    Shader *shader;
+    /* The Model drawn by this item, or the Model of instanceBatch. */
+    Model *model;
+    /* If set, the whole batch is drawn with a single instanced draw call, and modelMatrix is ignored. */
+    InstanceBatch *instanceBatch;
+    /* The texture bound to TEXTURE0, either the texture of the Model's Material or one that replaces it. */
+    Texture *texture;
+    /* The model matrix of the item. It must stay valid until the queue is submitted. */
+    const Matrix4 *modelMatrix;
+    /* An int or float parameter set on the Shader just for this item, like the number of floors of a Building. */
+    ShaderParameterHandle parameter;
+    union {
+        int intValue;
+        float floatValue;
+    } parameterValue;
+
+    /* Sets the per item parameter. These only support PARAMETER_INT and PARAMETER_FLOAT parameters. */
+    void setIntParameter(ShaderParameterHandle handle, int value) {
+        this->parameter = handle;
+        this->parameterValue.intValue = value;
+    }
+    void setFloatParameter(ShaderParameterHandle handle, float value) {
+        this->parameter = handle;
+        this->parameterValue.floatValue = value;
+    }
+};
+
+class RenderQueue {
+public:
+
+    /* Value of RenderItem::parameter when the item has no parameter of its own. */
+    static const ShaderParameterHandle NO_PARAMETER = -1;
+
+    RenderQueue(void);
+    ~RenderQueue(void);
+
+    /* Removes the items of the last frame. cameraPosition is used to sort the items of this frame by depth. */
+    void begin(const Vector3 &cameraPosition);
+
+    /*
+     * Adds a draw of model, with the modelMatrix and shader provided. If texture is null, the texture of the Model's
+     * Material is used. position is only used to calculate the item's depth. The item is returned, so a parameter can
+     * be set on it, but it's only valid until the next item is added.
+     */
+    RenderItem &addModel(Shader *shader, Model *model, Texture *texture, const Matrix4 &modelMatrix,
+        const Vector3 &position, bool translucent = false);
+
+    /* Same as above, but adds an instanced draw of all instances of instanceBatch. */
+    RenderItem &addInstanceBatch(Shader *shader, InstanceBatch *instanceBatch, const Vector3 &position,
+        bool translucent = false);
+
+    /*
+     * Sorts the items and draws all of them, using the Scene to switch between Shaders. Only the state that's
+     * different from the previous item is changed. This function MUST ONLY be called from the render thread.
+     */
+    void submit(Scene *scene);
+
+    /* Statistics of the last submitted frame. */
+    int getLastFrameItems() { return lastFrameItems; }
+    int getLastFrameShaderChanges() { return lastFrameShaderChanges; }
+    int getLastFrameTextureChanges() { return lastFrameTextureChanges; }
+
+protected:
+
+    /* Adds a new item, filling its sort key. */
+    RenderItem &addItem(Shader *shader, Model *model, Texture *texture, const Vector3 &position, bool translucent);
+
+    /* Calculates the sort key of item. See the description of the class for its layout. */
+    unsigned long long calculateSortKey(const RenderItem &item, float distance, bool translucent);
+
+    /* Sets the parameter of item on its Shader, only marking it to be uploaded if its value actually changed. */
+    static void applyParameter(const RenderItem &item);
+
+    static bool compareBySortKey(const RenderItem &a, const RenderItem &b) { return a.sortKey < b.sortKey; }
+
+    /* The items of the current frame. The vector keeps its capacity between frames. */
+    std::vector<RenderItem> *items;
+
+    Vector3 cameraPosition;
+
+    int lastFrameItems;
+    int lastFrameShaderChanges;
+    int lastFrameTextureChanges;
+};
@@ -1,6 +1,13 @@
 ﻿#include "Renderer.h"
+#include "UploadQueue.h"
 
 Renderer::Renderer(void) {
+    drawCalls = 0;
+    lastFrameDrawCalls = 0;
+    stateCalls = 0;
+    filteredCalls = 0;
+    lastFrameStateCalls = 0;
+    lastFrameFilteredCalls = 0;
     // Reads some configuration from the config file
     std::string gameTitle = ConfigurationManager::getInstance()->readString("gameTitle", "Game");
     std::string resolution = ConfigurationManager::getInstance()->readString("resolution", "1280x720");
@@ -60,13 +67,30 @@ Renderer::Renderer(void) {
 
     currentShader = nullptr;
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // The state cache starts with the defaults of a new OpenGL context
+    boundProgram = 0;
+    boundVertexArray = 0;
+    activeTextureUnit = 0;
+    for (int i = 0; i < MAX_TEXTURE_UNITS; i++) {
+        boundTextures2D[i] = 0;
+        boundCubeMaps[i] = 0;
+    }
+    blendEnabled = false;
+    depthTestEnabled = false;
+    cullFaceEnabled = false;
+    blendSource = GL_ONE;
+    blendDestination = GL_ZERO;
+    depthFunc = GL_LESS;
+    depthMask = true;
+    cullFace = GL_BACK;
+
+    setCapability(GL_BLEND, true);
+    setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LEQUAL);
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    setCapability(GL_DEPTH_TEST, true);
+    setDepthFunc(GL_LEQUAL);
+    setCapability(GL_CULL_FACE, true);
+    setCullFace(GL_BACK);
     glFrontFace(GL_CW);
 
     // We initialize the primitive meshes that will be used by the interface
@@ -77,9 +101,12 @@ Renderer::~Renderer(void) {
 }
 
 void Renderer::render(Scene *scene, float millisElapsed) {
+    drawCalls = 0;
+    stateCalls = 0;
+    filteredCalls = 0;
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    setCapability(GL_BLEND, true);
+    setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     /* Enable this for wireframe view
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE); */
 
@@ -87,23 +114,30 @@ void Renderer::render(Scene *scene, float millisElapsed) {
     //glDepthFunc(GL_LEQUAL);
     //glEnable(GL_CULL_FACE);
     //glDisable(GL_CULL_FACE);
+    // Upload some of the Models built by other threads, within the budget of this frame
+    UploadQueue::process();
     // Draw current scene
     if (scene != nullptr)
         scene->render(this, millisElapsed);
+    lastFrameDrawCalls = drawCalls;
+    lastFrameStateCalls = stateCalls;
+    lastFrameFilteredCalls = filteredCalls;
     // Swap buffers
     SDL_GL_SwapWindow(window);
     logOpenGLError("END_RENDER");
 }
 
 bool Renderer::useShader(Shader *shader) {
-    if (currentShader == nullptr || currentShader->getShaderProgram() != shader->getShaderProgram()) {
-        glUseProgram(shader->getShaderProgram());
-        this->currentShader = shader;
+    GLuint program = shader->getShaderProgram();
+    countStateCall(program != boundProgram);
+    if (program != boundProgram) {
+        glUseProgram(program);
+        boundProgram = program;
         // TODO: Check if this affects performance
         //return (glIsProgram(shader->getShaderProgram()) == GL_TRUE);
-        return true;
     }
-    return currentShader != nullptr;
+    this->currentShader = shader;
+    return true;
 }
 
 bool Renderer::updateShaderMatrix(std::string matrixName, Matrix4 *matrix) {
@@ -115,4 +149,123 @@ bool Renderer::updateShaderMatrix(std::string matrixName, Matrix4 *matrix) {
         }
     }
     return false;
-}
\ No newline at end of file
+}
+
+bool Renderer::updateShaderMatrix(ShaderUniform uniform, const Matrix4 *matrix) {
+    if (currentShader != nullptr) {
+        GLint location = currentShader->getUniformLocation(uniform);
+        if (location != -1) {
+            glUniformMatrix4fv(location, 1, false, (const float*) matrix);
+            return true;
+        }
+    }
+    return false;
+}
+
+GLint Renderer::getUniformLocation(GLuint program, ShaderUniform uniform) {
+    if (currentShader != nullptr && currentShader->getShaderProgram() == program) {
+        return currentShader->getUniformLocation(uniform);
+    }
+    return glGetUniformLocation(program, Shader::getUniformName(uniform));
+}
+
+void Renderer::bindVertexArray(GLuint vao) {
+    countStateCall(vao != boundVertexArray);
+    if (vao != boundVertexArray) {
+        glBindVertexArray(vao);
+        boundVertexArray = vao;
+    }
+}
+
+void Renderer::bindTexture(int unit, GLenum target, GLuint texture) {
+    GLuint *boundTexture = (target == GL_TEXTURE_CUBE_MAP) ? &boundCubeMaps[unit] : &boundTextures2D[unit];
+    countStateCall(texture != *boundTexture);
+    if (texture != *boundTexture) {
+        if (unit != activeTextureUnit) {
+            glActiveTexture(GL_TEXTURE0 + unit);
+            activeTextureUnit = unit;
+        }
+        glBindTexture(target, texture);
+        *boundTexture = texture;
+    }
+}
+
+void Renderer::setCapability(GLenum capability, bool enabled) {
+    bool *current = nullptr;
+    switch (capability) {
+    case GL_BLEND:
+        current = &blendEnabled;
+        break;
+    case GL_DEPTH_TEST:
+        current = &depthTestEnabled;
+        break;
+    case GL_CULL_FACE:
+        current = &cullFaceEnabled;
+        break;
+    default:
+        return;
+    }
+    countStateCall(enabled != *current);
+    if (enabled != *current) {
+        if (enabled) {
+            glEnable(capability);
+        } else {
+            glDisable(capability);
+        }
+        *current = enabled;
+    }
+}
+
+void Renderer::setBlendFunc(GLenum source, GLenum destination) {
+    bool changed = source != blendSource || destination != blendDestination;
+    countStateCall(changed);
+    if (changed) {
+        glBlendFunc(source, destination);
+        blendSource = source;
+        blendDestination = destination;
+    }
+}
+
+void Renderer::setDepthFunc(GLenum depthFunc) {
+    countStateCall(depthFunc != this->depthFunc);
+    if (depthFunc != this->depthFunc) {
+        glDepthFunc(depthFunc);
+        this->depthFunc = depthFunc;
+    }
+}
+
+void Renderer::setDepthMask(bool depthMask) {
+    countStateCall(depthMask != this->depthMask);
+    if (depthMask != this->depthMask) {
+        glDepthMask(depthMask ? GL_TRUE : GL_FALSE);
+        this->depthMask = depthMask;
+    }
+}
+
+void Renderer::setCullFace(GLenum cullFace) {
+    countStateCall(cullFace != this->cullFace);
+    if (cullFace != this->cullFace) {
+        glCullFace(cullFace);
+        this->cullFace = cullFace;
+    }
+}
+
+void Renderer::onProgramDeleted(GLuint program) {
+    if (program == boundProgram) {
+        boundProgram = 0;
+        currentShader = nullptr;
+    }
+}
+
+void Renderer::onVertexArrayDeleted(GLuint vao) {
+    if (vao == boundVertexArray) {
+        boundVertexArray = 0;
+    }
+}
+
+void Renderer::onTextureDeleted(GLuint texture) {
+    for (int i = 0; i < MAX_TEXTURE_UNITS; i++) {
+        if (boundTextures2D[i] == texture) boundTextures2D[i] = 0;
+        if (boundCubeMaps[i] == texture) boundCubeMaps[i] = 0;
+    }
+}
@@ -12,6 +12,11 @@
  * fullscreen mode, and so on, from the config file of the ConfigurationManager, that is set on the initialization of
  * the engine itself. If the configuration file cannot be opened or the required values are not found, the default
  * values will be used.
+ *
+ * The Renderer also keeps a shadow copy of the OpenGL state it sets: the program, the vertex array, the textures bound
+ * to each unit, and the blend, depth and cull state. A call that would set the state to what it already is is filtered
+ * and never reaches OpenGL. For this to work, that state must only be changed through the Renderer, and the Renderer
+ * must be told when a bound object is deleted, as OpenGL reuses the names of deleted objects.
  */
 
 #pragma once
@@ -26,6 +31,9 @@ class Scene;
 class Renderer {
 public:
 
+    /* Number of texture units tracked by the state cache. */
+    static const int MAX_TEXTURE_UNITS = 8;
+
     Renderer(void);
     ~Renderer(void);
 
@@ -78,8 +86,58 @@ public:
      */
     bool updateShaderMatrix(std::string matrixName, Matrix4 *matrix);
 
+    /* Same as above, but uses the location of uniform cached on the current Shader, without asking OpenGL for it. */
+    bool updateShaderMatrix(ShaderUniform uniform, const Matrix4 *matrix);
+
+    /*
+     * Returns the location of uniform on program. If program belongs to the current Shader, the cached location is
+     * used, otherwise OpenGL is asked for it.
+     */
+    GLint getUniformLocation(GLuint program, ShaderUniform uniform);
+
     Shader *getCurrentShader() { return currentShader; }
 
+    /* Counts a draw call on the current frame. Should be called by everything that issues an OpenGL draw command. */
+    void addDrawCall() { drawCalls++; }
+
+    /* Returns the number of draw calls issued on the last complete frame. */
+    int getLastFrameDrawCalls() { return lastFrameDrawCalls; }
+
+    /*
+     * =========================
+     * State cache functions
+     * =========================
+     */
+
+    /* Binds vao, unless it's already bound. */
+    void bindVertexArray(GLuint vao);
+
+    /*
+     * Binds texture to target (GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP) on the texture unit, where 0 is GL_TEXTURE0.
+     * The active texture unit is only changed if the binding has to be.
+     */
+    void bindTexture(int unit, GLenum target, GLuint texture);
+
+    /* Enables or disables capability, which must be GL_BLEND, GL_DEPTH_TEST or GL_CULL_FACE. */
+    void setCapability(GLenum capability, bool enabled);
+
+    void setBlendFunc(GLenum source, GLenum destination);
+    void setDepthFunc(GLenum depthFunc);
+    void setDepthMask(bool depthMask);
+    void setCullFace(GLenum cullFace);
+
+    /*
+     * Must be called after an object is deleted, so the cache doesn't think it's still bound, as OpenGL unbinds it
+     * and may give its name to a new object.
+     */
+    void onProgramDeleted(GLuint program);
+    void onVertexArrayDeleted(GLuint vao);
+    void onTextureDeleted(GLuint texture);
+
+    /* Returns the number of state changes sent to OpenGL, and filtered by the cache, on the last complete frame. */
+    int getLastFrameStateCalls() { return lastFrameStateCalls; }
+    int getLastFrameFilteredCalls() { return lastFrameFilteredCalls; }
+
 protected:
 
     /* The size of the window. Defaults to (1280, 720). */
@@ -88,9 +146,43 @@ protected:
     /* True if the game is in fullscreen mode. Defaults to false. */
     bool fullscreen;
 
+    /* The number of draw calls of the frame being rendered, and of the last complete frame. */
+    int drawCalls;
+    int lastFrameDrawCalls;
+
     /* The current Shader being used be OpenGL. Defaults to null. */
     Shader *currentShader;
 
+    /* The state cache. The initial values are the OpenGL defaults. */
+    GLuint boundProgram;
+    GLuint boundVertexArray;
+    int activeTextureUnit;
+    GLuint boundTextures2D[MAX_TEXTURE_UNITS];
+    GLuint boundCubeMaps[MAX_TEXTURE_UNITS];
+    bool blendEnabled;
+    bool depthTestEnabled;
+    bool cullFaceEnabled;
+    GLenum blendSource;
+    GLenum blendDestination;
+    GLenum depthFunc;
+    bool depthMask;
+    GLenum cullFace;
+
+    /* The number of state changes sent to OpenGL and filtered by the cache, on this frame and on the last one. */
+    int stateCalls;
+    int filteredCalls;
+    int lastFrameStateCalls;
+    int lastFrameFilteredCalls;
+
+    /* Counts a state change that was sent to OpenGL if issued is true, or that was filtered otherwise. */
+    void countStateCall(bool issued) {
+        if (issued) {
+            stateCalls++;
+        } else {
+            filteredCalls++;
+        }
+    }
+
     /* The Window in which OpenGL will render to. */
     SDL_Window *window;
 
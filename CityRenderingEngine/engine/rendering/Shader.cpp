@@ -1,4 +1,7 @@
 #include "Shader.h"
+#include "FrameUniforms.h"
+#include "../input/BinaryBuffer.h"
+#include <sstream>
 
 Shader::Shader(int name, const std::string &vertexFilename, const std::string &fragmentFilename) : 
     Resource(name) {
@@ -7,7 +10,18 @@ Shader::Shader(int name, const std::string &vertexFilename, const std::string &f
     this->geometryFilename = "";
     this->tessCtrlFilename = "";
     this->tessEvalFilename = "";
+    this->defines = "";
+    this->program = 0;
+    this->vertexId = 0;
+    this->fragmentId = 0;
+    this->geometryId = 0;
+    this->tessCtrlId = 0;
+    this->tessEvalId = 0;
     this->shaderParameters = new std::vector<ShaderParameter*>();
+    this->parameterTable = new std::vector<ShaderParameter*>();
+    for (int i = 0; i < MAX_UNIFORM; i++) {
+        uniformLocations[i] = -1;
+    }
 }
 
 Shader::~Shader(void) {
@@ -17,48 +31,60 @@ Shader::~Shader(void) {
     shaderParameters->clear();
     delete shaderParameters;
     shaderParameters = nullptr;
+    delete parameterTable;
+    parameterTable = nullptr;
 }
 
 void Shader::load() {
     Renderer *renderer = Naquadah::getRenderer();
     if (renderer != nullptr) {
-        std::string vertexCode = FileIO::mergeLines(FileIO::readTextFile(vertexFilename));
-        std::string fragmentCode = FileIO::mergeLines(FileIO::readTextFile(fragmentFilename));
-        std::string geometryCode = FileIO::mergeLines(FileIO::readTextFile(geometryFilename));
-        std::string tessCtrlCode = FileIO::mergeLines(FileIO::readTextFile(tessCtrlFilename));
-        std::string tessEvalCode = FileIO::mergeLines(FileIO::readTextFile(tessEvalFilename));
-
-        this->program = glCreateProgram();
-        vertexId = compileShader(program, GL_VERTEX_SHADER, vertexCode.c_str());
-        fragmentId = compileShader(program, GL_FRAGMENT_SHADER, fragmentCode.c_str());
-        if (geometryCode.size() > 0)
-            geometryId = compileShader(program, GL_GEOMETRY_SHADER, geometryCode.c_str());
-        if (tessCtrlCode.size() > 0 && tessEvalCode.size() > 0) {
-            tessCtrlId = compileShader(program, GL_TESS_CONTROL_SHADER, tessCtrlCode.c_str());
-            tessEvalId = compileShader(program, GL_TESS_EVALUATION_SHADER, tessEvalCode.c_str());
+        std::string sources[5] = {
+            readSource(vertexFilename), readSource(fragmentFilename), readSource(geometryFilename),
+            readSource(tessCtrlFilename), readSource(tessEvalFilename)
+        };
+        // The defines are part of the hashed sources, so each variant has a binary of its own
+        for (int i = 0; i < 5; i++) {
+            sources[i] = addDefines(sources[i], defines);
         }
-        setDefaultAttributes();
-        if (linkProgram(program))
+        unsigned long long sourceHash = hashSources(sources, 5);
+        Uint64 frequency = SDL_GetPerformanceFrequency();
+        Uint64 start = SDL_GetPerformanceCounter();
+        if (loadProgramBinary(sourceHash)) {
+            valid = true;
+            std::cout << "Shader " << name << ": loaded from its program binary in " <<
+                (SDL_GetPerformanceCounter() - start) * 1000.0 / frequency << "ms" << std::endl;
+        } else if (compileProgram(sources)) {
             valid = true;
+            saveProgramBinary(sourceHash);
+        }
+        if (valid) {
+            resolveUniformLocations();
+        }
     } else
         valid = false;
     loaded = true;
 }
 
 void Shader::unload() {
-    // First detach and delete each individual shader
-    glDetachShader(program, vertexId);
-    glDeleteShader(vertexId);
-    glDetachShader(program, fragmentId);
-    glDeleteShader(fragmentId);
-    glDetachShader(program, geometryId);
-    glDeleteShader(geometryId);
-    glDetachShader(program, tessCtrlId);
-    glDeleteShader(tessCtrlId);
-    glDetachShader(program, tessEvalId);
-    glDeleteShader(tessEvalId);
+    // First detach and delete each individual shader. Programs loaded from a binary have none.
+    GLuint *shaderIds[] = { &vertexId, &fragmentId, &geometryId, &tessCtrlId, &tessEvalId };
+    for (int i = 0; i < 5; i++) {
+        if (*shaderIds[i] != 0 && glIsShader(*shaderIds[i])) {
+            glDetachShader(program, *shaderIds[i]);
+            glDeleteShader(*shaderIds[i]);
+        }
+        *shaderIds[i] = 0;
+    }
     // Then delete the shader program
     glDeleteProgram(program);
+    Naquadah::getRenderer()->onProgramDeleted(program);
+    program = 0;
+    for (int i = 0; i < MAX_UNIFORM; i++) {
+        uniformLocations[i] = -1;
+    }
+    for (auto it = shaderParameters->begin(); it != shaderParameters->end(); it++) {
+        (*it)->location = ShaderParameter::UNRESOLVED_LOCATION;
+    }
     loaded = false;
     valid = false;
 }
@@ -82,6 +108,9 @@ void Shader::setDefaultAttributes()	{
         bindAttributeLocation(program, VERTEX_BUFFER, "position");
         bindAttributeLocation(program, UV_MAP_BUFFER, "uv_map");
         bindAttributeLocation(program, NORMAL_BUFFER, "normal");
+        bindAttributeLocation(program, FLOORS_BUFFER, "floors");
+        bindAttributeLocation(program, INSTANCE_MATRIX_ATTRIBUTE, "instanceMatrix");
+        bindAttributeLocation(program, INSTANCE_PARAMS_ATTRIBUTE, "instanceParams");
         //renderer->bindAttributeLocation(program, LOC_TANGENT_BUFFER, "tangent");
     }
 }
@@ -110,6 +139,145 @@ int Shader::compileShader(GLuint program, GLenum shaderType, const char *shaderC
     return -1;
 }
 
+bool Shader::compileProgram(const std::string *sources) {
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter();
+    this->program = glCreateProgram();
+    vertexId = compileShader(program, GL_VERTEX_SHADER, sources[0].c_str());
+    fragmentId = compileShader(program, GL_FRAGMENT_SHADER, sources[1].c_str());
+    if (sources[2].size() > 0)
+        geometryId = compileShader(program, GL_GEOMETRY_SHADER, sources[2].c_str());
+    if (sources[3].size() > 0 && sources[4].size() > 0) {
+        tessCtrlId = compileShader(program, GL_TESS_CONTROL_SHADER, sources[3].c_str());
+        tessEvalId = compileShader(program, GL_TESS_EVALUATION_SHADER, sources[4].c_str());
+    }
+    Uint64 compiled = SDL_GetPerformanceCounter();
+    setDefaultAttributes();
+    if (supportsProgramBinary()) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    bool linked = linkProgram(program);
+    Uint64 end = SDL_GetPerformanceCounter();
+    std::cout << "Shader " << name << ": compiled in " << (compiled - start) * 1000.0 / frequency << "ms, linked in " <<
+        (end - compiled) * 1000.0 / frequency << "ms" << std::endl;
+    return linked;
+}
+
+bool Shader::loadProgramBinary(unsigned long long sourceHash) {
+    if (!supportsProgramBinary()) return false;
+    BinaryBuffer buffer;
+    if (!buffer.loadFromFile(getBinaryFilename())) return false;
+    unsigned int magic = buffer.read<unsigned int>();
+    unsigned int version = buffer.read<unsigned int>();
+    unsigned long long hash = buffer.read<unsigned long long>();
+    std::string driver(buffer.read<unsigned short>(), ' ');
+    if (!driver.empty()) {
+        buffer.readBytes(&driver[0], driver.size());
+    }
+    GLenum format = buffer.read<GLenum>();
+    unsigned int length = buffer.read<unsigned int>();
+    if (buffer.hasFailed() || magic != BINARY_MAGIC || version != BINARY_VERSION || length == 0 ||
+        buffer.getSize() - buffer.getReadPosition() != length) {
+        return false;
+    }
+    if (hash != sourceHash || driver != getDriverString()) {
+        return false; // The sources or the driver changed since the binary was saved
+    }
+    this->program = glCreateProgram();
+    glProgramBinary(program, format, &(*buffer.getData())[buffer.getReadPosition()], length);
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        // The driver can reject a binary for its own reasons, so just compile the Shader again
+        glDeleteProgram(program);
+        program = 0;
+        return false;
+    }
+    return true;
+}
+
+void Shader::saveProgramBinary(unsigned long long sourceHash) {
+    if (!supportsProgramBinary()) return;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, &binary[0]);
+    const std::string &driver = getDriverString();
+    BinaryBuffer buffer;
+    buffer.write(BINARY_MAGIC);
+    buffer.write(BINARY_VERSION);
+    buffer.write(sourceHash);
+    buffer.write((unsigned short) driver.size());
+    buffer.writeBytes(driver.c_str(), driver.size());
+    buffer.write(format);
+    buffer.write((unsigned int) length);
+    buffer.writeBytes(&binary[0], length);
+    if (!buffer.saveToFile(getBinaryFilename())) {
+        std::cout << "Could not save the program binary of Shader " << name << std::endl;
+    }
+}
+
+std::string Shader::getBinaryFilename() {
+    std::stringstream filename;
+    filename << vertexFilename << "." << name << ".bin";
+    return filename.str();
+}
+
+std::string Shader::readSource(const std::string &filename) {
+    if (filename.empty()) return "";
+    return FileIO::mergeLines(FileIO::readTextFile(filename));
+}
+
+std::string Shader::addDefines(const std::string &source, const std::string &defines) {
+    if (source.empty() || defines.empty()) return source;
+    size_t version = source.find("version");
+    size_t lineEnd = source.find('\n');
+    if (version == std::string::npos || lineEnd == std::string::npos || version > lineEnd) {
+        return defines + source;
+    }
+    return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
+
+unsigned long long Shader::hashSources(const std::string *sources, int numSources) {
+    // FNV-1a, with each source terminated by a null, so moving code between stages changes the hash too
+    unsigned long long hash = 14695981039346656037ULL;
+    for (int i = 0; i < numSources; i++) {
+        const std::string &source = sources[i];
+        for (size_t c = 0; c <= source.size(); c++) {
+            hash = (hash ^ (unsigned char) source.c_str()[c]) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+const std::string &Shader::getDriverString() {
+    static std::string driver;
+    if (driver.empty()) {
+        GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for (int i = 0; i < 3; i++) {
+            const char *value = (const char*) glGetString(names[i]);
+            driver += value != nullptr ? value : "";
+            driver += "|";
+        }
+    }
+    return driver;
+}
+
+bool Shader::supportsProgramBinary() {
+    // Some drivers have the extension, but no binary formats, which means they can't actually save any binary
+    static int supported = -1;
+    if (supported < 0) {
+        GLint numFormats = 0;
+        if (GLEW_ARB_get_program_binary) {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+        }
+        supported = numFormats > 0 ? 1 : 0;
+    }
+    return supported == 1;
+}
+
 bool Shader::linkProgram(GLuint program) {
     if (glIsProgram(program)) {
         glLinkProgram(program);
@@ -130,12 +298,63 @@ void Shader::bindAttributeLocation(GLuint program, GLuint location, std::string
     glBindAttribLocation(program, location, attrName.c_str());
 }
 
+void Shader::resolveUniformLocations() {
+    FrameUniforms::bindBlock(program);
+    for (int i = 0; i < MAX_UNIFORM; i++) {
+        uniformLocations[i] = glGetUniformLocation(program, getUniformName((ShaderUniform) i));
+    }
+    // Each sampler always reads from the same texture unit, so they're only set once (see Texture::bindTexture())
+    for (int i = UNIFORM_TEXTURE0; i <= UNIFORM_TEXTURE2; i++) {
+        if (uniformLocations[i] != -1) {
+            glProgramUniform1i(program, uniformLocations[i], i - UNIFORM_TEXTURE0);
+        }
+    }
+    // The cube map of the Skybox is bound to the unit of texture2 (see Skybox::render())
+    if (uniformLocations[UNIFORM_CUBE_TEXTURE] != -1) {
+        glProgramUniform1i(program, uniformLocations[UNIFORM_CUBE_TEXTURE], UNIFORM_TEXTURE2 - UNIFORM_TEXTURE0);
+    }
+    for (auto it = shaderParameters->begin(); it != shaderParameters->end(); it++) {
+        (*it)->location = ShaderParameter::UNRESOLVED_LOCATION;
+        resolveParameterLocation(*it);
+    }
+}
+
+void Shader::resolveParameterLocation(ShaderParameter *parameter) {
+    if (valid && parameter->location == ShaderParameter::UNRESOLVED_LOCATION) {
+        parameter->location = glGetUniformLocation(program, parameter->parameterName.c_str());
+        parameter->setValueChanged(true);
+    }
+}
+
+const char *Shader::getUniformName(ShaderUniform uniform) {
+    switch (uniform) {
+    case UNIFORM_MODEL_MATRIX:
+        return "modelMatrix";
+    case UNIFORM_VIEW_MATRIX:
+        return "viewMatrix";
+    case UNIFORM_PROJ_MATRIX:
+        return "projMatrix";
+    case UNIFORM_TEXTURE0:
+        return "texture0";
+    case UNIFORM_TEXTURE1:
+        return "texture1";
+    case UNIFORM_TEXTURE2:
+        return "texture2";
+    case UNIFORM_CUBE_TEXTURE:
+        return "cubeTex";
+    default:
+        return "";
+    }
+}
+
 void Shader::updateShaderParameters(bool forceUpdate) {
     for (int i = 0; i < shaderParameters->size(); i++) {
         ShaderParameter *parameter = shaderParameters->at(i);
         if (parameter->hasValueChanged() || forceUpdate) {
-            GLuint location = glGetUniformLocation(program, parameter->parameterName.c_str());
-            if (location != -1) {
+            // Parameters added after the program was linked are resolved on their first upload
+            resolveParameterLocation(parameter);
+            GLint location = parameter->location;
+            if (location >= 0) {
                 switch (parameter->parameterType) {
                 case PARAMETER_INT:
                     glUniform1iv(location, parameter->valueSize, (int*) parameter->getValue());
@@ -163,64 +382,68 @@ void Shader::updateShaderParameters(bool forceUpdate) {
                     break;
                 }
             }
+            parameter->setValueChanged(false);
         }
     }
 }
 
 void Shader::addShaderParameter(ShaderParameter *shaderParameter) {
-    bool exists = false;
-    for (int i = 0; i < shaderParameters->size(); i++) {
-        if (shaderParameters->at(i)->parameterName == shaderParameter->parameterName) {
-            exists = true;
-        }
-    }
-    if (!exists) {
-        shaderParameters->emplace_back(shaderParameter);
+    if (getShaderParameter(shaderParameter->handle) == nullptr) {
+        insertShaderParameter(shaderParameter);
     }
 }
 
 void Shader::addShaderParameter(std::string paramName, ParameterType paramType, void *value) {
-    bool exists = false;
-    for (int i = 0; i < shaderParameters->size(); i++) {
-        if (shaderParameters->at(i)->parameterName == paramName) {
-            exists = true;
-        }
+    if (getShaderParameter(ShaderParameter::getHandle(paramName)) == nullptr) {
+        insertShaderParameter(new ShaderParameter(paramName, paramType, value));
     }
-    if (!exists) {
-        shaderParameters->push_back(new ShaderParameter(paramName, paramType, value));
+}
+
+void Shader::insertShaderParameter(ShaderParameter *shaderParameter) {
+    shaderParameters->push_back(shaderParameter);
+    if (shaderParameter->handle >= (int) parameterTable->size()) {
+        parameterTable->resize(shaderParameter->handle + 1, nullptr);
     }
+    (*parameterTable)[shaderParameter->handle] = shaderParameter;
 }
     
 void Shader::removeShaderParameter(std::string parameterName) {
-    for (int i = 0; i < shaderParameters->size(); i++) {
-        if (shaderParameters->at(i)->parameterName == parameterName) {
-            ShaderParameter *shaderParameter = shaderParameters->at(i);
-            shaderParameters->erase(shaderParameters->begin() + i);
-            delete shaderParameter;
-            return;
-        }
+    ShaderParameter *shaderParameter = getShaderParameter(parameterName);
+    if (shaderParameter != nullptr) {
+        (*parameterTable)[shaderParameter->handle] = nullptr;
+        shaderParameters->erase(std::find(shaderParameters->begin(), shaderParameters->end(), shaderParameter));
+        delete shaderParameter;
     }
 }
 
 ShaderParameter *Shader::getShaderParameter(std::string parameterName) {
-    for (int i = 0; i < shaderParameters->size(); i++) {
-        if (shaderParameters->at(i)->parameterName == parameterName) {
-            return shaderParameters->at(i);
-        }
-    }
-    return nullptr;
+    return getShaderParameter(ShaderParameter::getHandle(parameterName));
 }
 
 
 Shader *Shader::getOrCreate(int name, const std::string &vertexFilename, const std::string &fragFilename,
     bool preLoad) {
-    if (ResourcesManager::resourceExists(name)) {
-        return (Shader*) ResourcesManager::getResource(name);
-    } else {
-        Shader *newShader = new Shader(name, vertexFilename, fragFilename);
-        ResourcesManager::addResource(newShader, preLoad);
-        return newShader;
+    ResourcesManager::lockMutex();
+    Shader *shader = (Shader*) ResourcesManager::getResource(name);
+    if (shader == nullptr) {
+        shader = new Shader(name, vertexFilename, fragFilename);
+        ResourcesManager::addResource(shader, preLoad);
+    }
+    ResourcesManager::unlockMutex();
+    return shader;
+}
+
+Shader *Shader::getOrCreate(int name, const std::string &vertexFilename, const std::string &fragFilename,
+    const std::string &defines, bool preLoad) {
+    ResourcesManager::lockMutex();
+    Shader *shader = (Shader*) ResourcesManager::getResource(name);
+    if (shader == nullptr) {
+        shader = new Shader(name, vertexFilename, fragFilename);
+        shader->setDefines(defines);
+        ResourcesManager::addResource(shader, preLoad);
     }
+    ResourcesManager::unlockMutex();
+    return shader;
 }
 
 bool Shader::operator==(Shader &other) {
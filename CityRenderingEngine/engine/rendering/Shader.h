@@ -5,6 +5,18 @@
  * Description: Class to encapsulate OpenGL GLSL shader functionality, treating all of the shader stages as a single
  * coherent program.
  *
+ * The locations of the uniforms used by most Shaders (see ShaderUniform) and of all ShaderParameters are resolved
+ * once, right after the program is linked, so drawing never needs to ask OpenGL for a location by name.
+ *
+ * Linked programs are saved as driver specific binaries (glGetProgramBinary), in a file next to the vertex shader, and
+ * the next loads use the binary instead of compiling the GLSL again. The binary is keyed by a hash of the sources and
+ * by the OpenGL vendor, renderer and version, so editing a shader or updating the driver just compiles it again. If
+ * the driver rejects the binary, the Shader is compiled as usual.
+ *
+ * A Shader can also have a list of #defines, added to all of its stages right after the #version line. This is how
+ * the variants of a shader are made: each one is a Shader of its own, compiled from the same files with a different
+ * set of defines, so the code that a variant doesn't need is left out at compile time (see LightShader).
+ *
  * -_-_-_-_-_-_-_,------,   
  * _-_-_-_-_-_-_-|   /\_/\   NYANYANYAN
  * -_-_-_-_-_-_-~|__( ^ .^) /
@@ -35,6 +47,11 @@ public:
     Shader(int name, const std::string &vertexFilename, const std::string &fragmentFilename);
     virtual ~Shader(void);
 
+    /* The first four bytes of every program binary file, "NPRG". */
+    static const unsigned int BINARY_MAGIC = 0x4752504E;
+    /* Version of the program binary file format. Must be incremented whenever the format changes. */
+    static const unsigned int BINARY_VERSION = 1;
+
     /* This function should load the shader into OpenGL */
     virtual void load();
 
@@ -59,9 +76,19 @@ public:
     void setTessCtrlFilename(std::string filename) { this->tessCtrlFilename = filename; }
     void setTessEvalFilename(std::string filename) { this->tessEvalFilename = filename; }
 
+    /* The #define lines added to all stages, like "#define FOG\n". Only used the next time the Shader is loaded. */
+    const std::string &getDefines() { return defines; }
+    void setDefines(const std::string &defines) { this->defines = defines; }
+
     /* Returns the OpenGL ID of this Shader Program. */
     GLuint getShaderProgram() { return program; }
 
+    /* Returns the location of uniform on this Shader Program, or -1 if the program doesn't use it. */
+    GLint getUniformLocation(ShaderUniform uniform) { return uniformLocations[uniform]; }
+
+    /* Returns the GLSL name of uniform. */
+    static const char *getUniformName(ShaderUniform uniform);
+
     /*
      * Creates and compiles a new shader, attaching it to program. The shaderType defines the type of the shader that
      * will be created, and shaderCode is the actual shader text. Returns a positive number if the shader was created
@@ -106,10 +133,16 @@ public:
 
     /*
      * Returns a ShaderParameter, searching using the GLSL variable name. This method returns null if no variable with
-     * the provided name exists in this Shader.
+     * the provided name exists in this Shader. Prefer the version with a handle on code that runs every frame.
      */
     ShaderParameter *getShaderParameter(std::string parameterName);
 
+    /* Returns the ShaderParameter with the handle, or null if this Shader has no such parameter. */
+    ShaderParameter *getShaderParameter(ShaderParameterHandle handle) {
+        if (handle < 0 || handle >= (int) parameterTable->size()) return nullptr;
+        return (*parameterTable)[handle];
+    }
+
     /*
      * Returns a string with the name of the type of the shader. If it's a vertex shader, it'll return "VERTEX_SHADER",
      * and so on. If it's not any type of supported shader, it'll return "INVALID_SHADER_TYPE"
@@ -144,6 +177,10 @@ public:
     static Shader *getOrCreate(int name, const std::string &vertexFilename, const std::string &fragFilename,
         bool preLoad);
 
+    /* The same as above, but a new Shader is created with the provided #defines. Used to create shader variants. */
+    static Shader *getOrCreate(int name, const std::string &vertexFilename, const std::string &fragFilename,
+        const std::string &defines, bool preLoad);
+
     bool operator==(Shader &other);
     bool operator!=(Shader &other);
 
@@ -164,6 +201,9 @@ protected:
     std::string tessCtrlFilename;
     std::string tessEvalFilename;
 
+    /* The #define lines added after the #version line of each stage. */
+    std::string defines;
+
     /*
      * The vector os the parameters for this Shader. The world transforms aren't inluded in this list, as they are
      * uploaded to all shaders. This list should contain values such as light source information and other variables
@@ -171,6 +211,51 @@ protected:
      */
     std::vector<ShaderParameter*> *shaderParameters;
 
+    /* The same ShaderParameters, indexed by their handles. Handles not used by this Shader have null. */
+    std::vector<ShaderParameter*> *parameterTable;
+
+    /* The locations of the uniforms in ShaderUniform on the linked program. */
+    GLint uniformLocations[MAX_UNIFORM];
+
     /* Sets some attributes necessary to tell OpenGL the names that we're going to use for some GLSL variables. */
     void setDefaultAttributes();
+
+    /*
+     * Resolves the locations of the uniforms and of all ShaderParameters, and binds the FrameData block. Called after
+     * the program is linked.
+     */
+    void resolveUniformLocations();
+
+    /* Resolves the location of a single parameter, if the program is linked. */
+    void resolveParameterLocation(ShaderParameter *parameter);
+
+    /* Adds a parameter to the list and to the table. The name must not be in use. */
+    void insertShaderParameter(ShaderParameter *shaderParameter);
+
+    /* Compiles and links the program from the sources, in the order vertex, fragment, geometry and tessellation. */
+    bool compileProgram(const std::string *sources);
+
+    /* Returns the name of the file with the program binary of this Shader. */
+    std::string getBinaryFilename();
+
+    /* Links the program from its binary file, if it matches sourceHash and the current driver. */
+    bool loadProgramBinary(unsigned long long sourceHash);
+
+    /* Saves the binary of the linked program, so it doesn't need to be compiled next time. */
+    void saveProgramBinary(unsigned long long sourceHash);
+
+    /* Reads the source of a shader stage, or returns an empty string if filename is empty. */
+    static std::string readSource(const std::string &filename);
+
+    /* Returns source with the defines inserted after its #version line, which must stay the first thing in it. */
+    static std::string addDefines(const std::string &source, const std::string &defines);
+
+    /* Returns the hash of all sources, used to detect changes to any of them. */
+    static unsigned long long hashSources(const std::string *sources, int numSources);
+
+    /* Returns the vendor, renderer and version of the OpenGL driver. Binaries only work on the same driver. */
+    static const std::string &getDriverString();
+
+    /* Returns true if the driver can save and load program binaries. */
+    static bool supportsProgramBinary();
 };
\ No newline at end of file
@@ -1,10 +1,16 @@
 #include "ShaderParameter.h"
 
+#include <SDL.h>
+#include <unordered_map>
+
 ShaderParameter::ShaderParameter(std::string variableName, ParameterType type, void *value) {
     this->parameterName = variableName;
     this->parameterType = type;
     this->value = value;
     this->valueSize = 1;
+    this->handle = getHandle(variableName);
+    this->location = UNRESOLVED_LOCATION;
+    this->valueChanged = true;
 }
 
 ShaderParameter::~ShaderParameter() {
@@ -16,4 +22,22 @@ void ShaderParameter::setValue(void *value, bool deletePrevious) {
     if (this->value != nullptr && deletePrevious) delete this->value;
     this->value = value;
     valueChanged = true;
+}
+
+ShaderParameterHandle ShaderParameter::getHandle(const std::string &parameterName) {
+    // Handles are mostly registered during static initialization, but Shaders built on worker threads may add more
+    static SDL_mutex *mutex = SDL_CreateMutex();
+    static std::unordered_map<std::string, ShaderParameterHandle> *handles =
+        new std::unordered_map<std::string, ShaderParameterHandle>();
+    SDL_LockMutex(mutex);
+    auto it = handles->find(parameterName);
+    ShaderParameterHandle handle;
+    if (it != handles->end()) {
+        handle = it->second;
+    } else {
+        handle = (ShaderParameterHandle) handles->size();
+        (*handles)[parameterName] = handle;
+    }
+    SDL_UnlockMutex(mutex);
+    return handle;
 }
\ No newline at end of file
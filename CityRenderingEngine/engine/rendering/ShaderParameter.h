@@ -5,6 +5,11 @@
  * Description: This class encapsulates a single Shader Parameter, a variable that needs to be sent to the current
  * Shader. It exists to facilitate the management of these variables, and provide a safe environment to correctly feed
  * these variables with data and upload it to OpenGL.
+ *
+ * Each parameter name is registered once and gets a ShaderParameterHandle, a small integer shared by all Shaders. The
+ * Shaders keep their parameters in a table indexed by these handles, and each parameter keeps the location of its
+ * uniform, resolved when its Shader is linked. Code that sets a parameter on every draw should get the handle once and
+ * keep it, so no strings are compared or hashed, and OpenGL is never asked for the location, on the hot path.
  */
 
 #pragma once
@@ -23,9 +28,30 @@ enum ParameterType {
     PARAMETER_MATRIX_4
 };
 
+/*
+ * The uniforms shared by most Shaders, like the matrices and textures. Their locations are kept in a table on each
+ * Shader, instead of being ShaderParameters.
+ */
+enum ShaderUniform {
+    UNIFORM_MODEL_MATRIX,
+    UNIFORM_VIEW_MATRIX,
+    UNIFORM_PROJ_MATRIX,
+    UNIFORM_TEXTURE0,
+    UNIFORM_TEXTURE1,
+    UNIFORM_TEXTURE2,
+    UNIFORM_CUBE_TEXTURE,
+    MAX_UNIFORM
+};
+
+/* Identifies a parameter name on every Shader. See ShaderParameter::getHandle(). */
+typedef int ShaderParameterHandle;
+
 class ShaderParameter {
 public:
 
+    /* Value of location before the parameter is resolved on the program of its Shader. */
+    static const int UNRESOLVED_LOCATION = -2;
+
     /* The name of the parameter (variable) inside the Shader. */
     std::string parameterName;
 
@@ -38,6 +64,12 @@ public:
     /* The size of the parameter, in case it's an array. Defaults to 1. */
     int valueSize;
 
+    /* The handle of parameterName. */
+    ShaderParameterHandle handle;
+
+    /* The location of the uniform on the program of the Shader, -1 if it's not used by the program. */
+    int location;
+
     ShaderParameter(std::string variableName, ParameterType type, void *value);
     ~ShaderParameter(void);
 
@@ -54,6 +86,12 @@ public:
     void setValueChanged(bool valueChanged) { this->valueChanged = valueChanged; }
     bool hasValueChanged() { return valueChanged; }
 
+    /*
+     * Returns the handle of the parameter name, registering it the first time it's used. Handles are consecutive and
+     * start at zero, so they can be used as indexes. Thread safe.
+     */
+    static ShaderParameterHandle getHandle(const std::string &parameterName);
+
 protected:
 
     /* The value that this parameter holds. It can be set to any type that is supported by GLSL. */
@@ -54,20 +54,20 @@ void Skybox::render(Scene *scene) {
         quad->addUser();
         return; // Skip this frame
     }
-    glDepthMask(GL_FALSE);
+    Renderer *renderer = Naquadah::getRenderer();
+    renderer->setDepthMask(false);
+    // The cubeTex sampler is set to unit 2 once, when the shader is linked (see Shader::resolveUniformLocations())
     scene->useShader(shader);
-    glUniform1i(glGetUniformLocation(shader->getShaderProgram(), "cubeTex"), 2);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapId);
+    renderer->bindTexture(2, GL_TEXTURE_CUBE_MAP, cubemapId);
     quad->draw();
-    glDepthMask(GL_TRUE);
+    renderer->setDepthMask(true);
 }
 
 void Skybox::load() {
     if (!loaded) {
         if (fileNames.size() == 6) {
             glGenTextures(1, &cubemapId);
-            glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapId);
+            Naquadah::getRenderer()->bindTexture(0, GL_TEXTURE_CUBE_MAP, cubemapId);
             int index = 0;
             for (auto it = fileNames.begin(); it != fileNames.end(); it++) {
                 std::string fileName = *it;
@@ -129,7 +129,7 @@ void Skybox::load() {
             if (!shader->isLoaded()) {
                 shader->load();
             }
-            glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+            Naquadah::getRenderer()->bindTexture(0, GL_TEXTURE_CUBE_MAP, 0);
         }
         loaded = true;
         if (cubemapId >= 0) {
@@ -141,6 +141,7 @@ void Skybox::load() {
 void Skybox::unload() {
     if (loaded) {
         glDeleteTextures(1, &cubemapId);
+        Naquadah::getRenderer()->onTextureDeleted(cubemapId);
         loaded = false;
     }
 }
@@ -89,7 +89,7 @@ void Texture::load() {
 			glGenTextures(1, &textureId);
 
 			// this reads from the sdl surface and puts it into an opengl texture
-			glBindTexture(GL_TEXTURE_2D, textureId);
+			Naquadah::getRenderer()->bindTexture(0, GL_TEXTURE_2D, textureId);
 			glTexImage2D(GL_TEXTURE_2D, 0, mode, texWidth, texHeight, 0, mode, GL_UNSIGNED_BYTE, surface->pixels);
 
 			// these affect how this texture is drawn later on...
@@ -105,7 +105,7 @@ void Texture::load() {
 			this->texHeight = 1;
 			glGenTextures(1, &textureId);
 
-			glBindTexture(GL_TEXTURE_2D, textureId);
+			Naquadah::getRenderer()->bindTexture(0, GL_TEXTURE_2D, textureId);
 			Uint32 col = colour.getColour();
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texWidth, texHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, &col);
 
@@ -147,7 +147,7 @@ void Texture::load() {
 		    this->texHeight = textSurface->h;
 		    glGenTextures(1, &textureId);
 
-		    glBindTexture(GL_TEXTURE_2D, textureId);
+		    Naquadah::getRenderer()->bindTexture(0, GL_TEXTURE_2D, textureId);
 		    glTexImage2D(GL_TEXTURE_2D, 0, mode, texWidth, texHeight, 0, mode, GL_UNSIGNED_BYTE, textSurface->pixels);
 		    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -166,6 +166,7 @@ void Texture::load() {
 void Texture::unload() {
 	if (loaded) {
 		glDeleteTextures(1, &textureId);
+		Naquadah::getRenderer()->onTextureDeleted(textureId);
 		textureId = 0;
 		loaded = false;
 	}
@@ -177,52 +178,50 @@ void Texture::bindTexture(Texture *texture, GLuint shaderProgram, TextureSlot sl
 
 void Texture::bindTexture(GLuint shaderProgram, TextureSlot slot) {
 	if (loaded) {
-		GLuint texUnit = GL_TEXTURE0;
-		GLuint texVar = -1;
+		Renderer *renderer = Naquadah::getRenderer();
+		GLint texVar = -1;
 		int texVal = 0;
 		switch (slot) {
 		case TEXTURE0:
-			texVar = glGetUniformLocation(shaderProgram, "texture0");
+			texVar = renderer->getUniformLocation(shaderProgram, UNIFORM_TEXTURE0);
 			break;
 		case TEXTURE1:
-			texUnit = GL_TEXTURE1;
 			texVal = 1;
-			texVar = glGetUniformLocation(shaderProgram, "texture1");
+			texVar = renderer->getUniformLocation(shaderProgram, UNIFORM_TEXTURE1);
 			break;
 		case TEXTURE2:
-			texUnit = GL_TEXTURE2;
 			texVal = 2;
-			texVar = glGetUniformLocation(shaderProgram, "texture2");
+			texVar = renderer->getUniformLocation(shaderProgram, UNIFORM_TEXTURE2);
 			break;
 		}
 		if (texVar != -1) {
-			glUniform1i(texVar, texVal);
-			glActiveTexture(texUnit);
-			glBindTexture(GL_TEXTURE_2D, textureId);
+			// The sampler uniforms are set to their units when the Shader is linked, only the texture is bound here
+			renderer->bindTexture(texVal, GL_TEXTURE_2D, textureId);
 			//GameApp::logOpenGLError(((string) "TEX_BIND ") + std::to_string((long long) textureId));
 		}
 	}
 }
 
 Texture *Texture::getOrCreate(int name, const std::string &fileName, bool preLoad) {
-    Texture *texture = (Texture*) ResourcesManager::getResource(name);
-	if (texture != nullptr) {
-		return texture;
-	} else {
+	ResourcesManager::lockMutex();
+	Texture *texture = (Texture*) ResourcesManager::getResource(name);
+	if (texture == nullptr) {
 		texture = new Texture(fileName, name);
 		ResourcesManager::addResource(texture, preLoad);
-		return texture;
 	}
+	ResourcesManager::unlockMutex();
+	return texture;
 }
 
 Texture *Texture::getOrCreate(int name, Colour &colour, bool preLoad) {
-	if (ResourcesManager::resourceExists(name)) {
-		return (Texture*) ResourcesManager::getResource(name);
-	} else {
-		Texture *newTexture = new Texture(colour, name);
-		ResourcesManager::addResource(newTexture, preLoad);
-		return newTexture;
+	ResourcesManager::lockMutex();
+	Texture *texture = (Texture*) ResourcesManager::getResource(name);
+	if (texture == nullptr) {
+		texture = new Texture(colour, name);
+		ResourcesManager::addResource(texture, preLoad);
 	}
+	ResourcesManager::unlockMutex();
+	return texture;
 }
 
 Texture *Texture::getColourWhite() {
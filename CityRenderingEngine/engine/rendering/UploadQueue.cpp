@@ -0,0 +1,102 @@
+#include "UploadQueue.h"
+#include "Model.h"
+
+const float UploadQueue::DEFAULT_BUDGET_MS = 2.0f;
+std::deque<Model*> *UploadQueue::queue = nullptr;
+size_t UploadQueue::backlogBytes = 0;
+size_t UploadQueue::budgetBytes = DEFAULT_BUDGET_KB * 1024;
+float UploadQueue::budgetMillis = DEFAULT_BUDGET_MS;
+int UploadQueue::lastFrameCount = 0;
+size_t UploadQueue::lastFrameBytes = 0;
+SDL_mutex *UploadQueue::mutex = nullptr;
+
+void UploadQueue::initialize() {
+    if (queue != nullptr) return;
+    queue = new std::deque<Model*>();
+    mutex = SDL_CreateMutex();
+    int budgetKB = ConfigurationManager::getInstance()->readInt("uploadBudgetKB", DEFAULT_BUDGET_KB);
+    budgetBytes = (size_t) max(budgetKB, 1) * 1024;
+    budgetMillis = ConfigurationManager::getInstance()->readFloat("uploadBudgetMs", DEFAULT_BUDGET_MS);
+}
+
+void UploadQueue::terminate() {
+    if (queue == nullptr) return;
+    lockMutex();
+    for (auto it = queue->begin(); it != queue->end(); it++) {
+        (*it)->setUploadPending(false);
+    }
+    delete queue;
+    queue = nullptr;
+    backlogBytes = 0;
+    unlockMutex();
+    SDL_DestroyMutex(mutex);
+    mutex = nullptr;
+}
+
+void UploadQueue::push(Model *model) {
+    if (queue == nullptr || model == nullptr) return;
+    lockMutex();
+    if (!model->isUploadPending()) {
+        model->setUploadPending(true);
+        queue->push_back(model);
+        backlogBytes += model->getDataSize();
+    }
+    unlockMutex();
+}
+
+void UploadQueue::cancel(Model *model) {
+    if (queue == nullptr || model == nullptr) return;
+    lockMutex();
+    if (model->isUploadPending()) {
+        auto itEnd = queue->end();
+        auto it = std::find(queue->begin(), itEnd, model);
+        if (it != itEnd) {
+            queue->erase(it);
+            backlogBytes -= min(backlogBytes, model->getDataSize());
+        }
+        model->setUploadPending(false);
+    }
+    unlockMutex();
+}
+
+int UploadQueue::process() {
+    lastFrameCount = 0;
+    lastFrameBytes = 0;
+    if (queue == nullptr) return 0;
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 start = SDL_GetPerformanceCounter();
+    // The lock is kept during each upload, so a worker can't delete the Model being uploaded
+    lockMutex();
+    while (!queue->empty()) {
+        Model *model = queue->front();
+        size_t size = model->getDataSize();
+        if (lastFrameCount > 0) {
+            // Always upload at least one Model, even if it's bigger than the budget
+            float elapsed = (float) ((SDL_GetPerformanceCounter() - start) * 1000.0 / frequency);
+            if (lastFrameBytes + size > budgetBytes || elapsed >= budgetMillis) break;
+        }
+        queue->pop_front();
+        backlogBytes -= min(backlogBytes, size);
+        model->setUploadPending(false);
+        model->load();
+        lastFrameCount++;
+        lastFrameBytes += size;
+    }
+    unlockMutex();
+    return lastFrameCount;
+}
+
+int UploadQueue::getBacklogCount() {
+    if (queue == nullptr) return 0;
+    lockMutex();
+    int count = (int) queue->size();
+    unlockMutex();
+    return count;
+}
+
+size_t UploadQueue::getBacklogBytes() {
+    lockMutex();
+    size_t bytes = backlogBytes;
+    unlockMutex();
+    return bytes;
+}
@@ -0,0 +1,81 @@
+/*
+ * Description: A queue of Models waiting to have their data uploaded to the GPU. Models built from a MeshData on other
+ * threads (like the Buildings generated by the ChunkLoader workers) can't touch OpenGL, so they're pushed to this
+ * queue instead, and the render thread uploads them a few at a time, at the start of each frame. This spreads the
+ * cost of a new Chunk over several frames, instead of doing all uploads in the frame the Chunk first appears.
+ *
+ * The amount of work done per frame is limited both by the number of bytes uploaded and by the time spent, read from
+ * the configurations "uploadBudgetKB" and "uploadBudgetMs". At least one Model is always uploaded per frame, so the
+ * queue never stalls even if a single Model is larger than the budget. A Model that's still in the queue is simply not
+ * drawn. This class is instance-less, and all of its methods and variables are static.
+ */
+
+#pragma once
+
+#include <deque>
+#include <algorithm>
+#include <SDL.h>
+#include "../input/ConfigurationManager.h"
+
+class Model;
+
+class UploadQueue {
+public:
+
+    /* Default budget per frame, used if it's not set on the configurations. */
+    static const int DEFAULT_BUDGET_KB = 2048;
+    static const float DEFAULT_BUDGET_MS;
+
+    /* Creates the queue and reads the budget from the configurations. Must be called before any Model is pushed. */
+    static void initialize();
+
+    /* Releases the queue. Models still in it are not uploaded. */
+    static void terminate();
+
+    /* Adds a Model to the end of the queue. It will be uploaded by the render thread in a future frame. */
+    static void push(Model *model);
+
+    /* Removes a Model from the queue, if it's there. Must be called before a queued Model is unloaded or deleted. */
+    static void cancel(Model *model);
+
+    /*
+     * Uploads Models from the front of the queue until the budget of this frame is used up, or the queue is empty.
+     * Returns the number of Models uploaded. This function MUST ONLY be called from the render thread.
+     */
+    static int process();
+
+    /* Returns the number of Models waiting to be uploaded. */
+    static int getBacklogCount();
+
+    /* Returns the total size in bytes of the Models waiting to be uploaded. */
+    static size_t getBacklogBytes();
+
+    /* Returns the number of Models and bytes uploaded in the last call to process(). */
+    static int getLastFrameCount() { return lastFrameCount; }
+    static size_t getLastFrameBytes() { return lastFrameBytes; }
+
+protected:
+
+    static void lockMutex() { if (mutex != nullptr) SDL_LockMutex(mutex); }
+    static void unlockMutex() { if (mutex != nullptr) SDL_UnlockMutex(mutex); }
+
+    /* The Models waiting to be uploaded, in the order they were pushed. */
+    static std::deque<Model*> *queue;
+
+    /* The total size of the Models in the queue. */
+    static size_t backlogBytes;
+
+    /* The maximum number of bytes and milliseconds to spend uploading on each frame. */
+    static size_t budgetBytes;
+    static float budgetMillis;
+
+    /* Statistics of the last frame. */
+    static int lastFrameCount;
+    static size_t lastFrameBytes;
+
+    /* Protects the queue, as Models are pushed and cancelled from any thread. */
+    static SDL_mutex *mutex;
+
+    UploadQueue(void) {}
+    ~UploadQueue(void) {}
+};
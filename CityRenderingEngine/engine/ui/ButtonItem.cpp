@@ -122,7 +122,8 @@ void ButtonItem::draw(float millisElapsed, GLuint program) {
 			chosenTex = selectedTex;
 			break;
 		}
-		glUniformMatrix4fv(glGetUniformLocation(program, "modelMatrix"), 1, false, (float*) &modelMatrix);
+		GLint modelLocation = Naquadah::getRenderer()->getUniformLocation(program, UNIFORM_MODEL_MATRIX);
+		glUniformMatrix4fv(modelLocation, 1, false, (float*) &modelMatrix);
 		if (&chosenTex) {
 			chosenTex->bindTexture(program, TEXTURE0);
 		} else if (normalTex) {
@@ -169,7 +169,8 @@ void InterfaceItem::draw(float millisElapsed, GLuint program) {
             if (!texture->isLoaded()) {
                 texture->load();
             }
-            glUniformMatrix4fv(glGetUniformLocation(program, "modelMatrix"), 1, false, (float*) &modelMatrix);
+            GLint modelLocation = Naquadah::getRenderer()->getUniformLocation(program, UNIFORM_MODEL_MATRIX);
+            glUniformMatrix4fv(modelLocation, 1, false, (float*) &modelMatrix);
             texture->bindTexture(program, TEXTURE0);
             Model::getQuadMesh(MODEL_UI_QUAD)->draw();
         }	
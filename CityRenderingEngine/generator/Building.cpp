@@ -1,29 +1,36 @@
 #include "Building.h"
+#include "../engine/rendering/RenderQueue.h"
+#include "../engine/rendering/LightShader.h"
+
+const ShaderParameterHandle Building::NUM_FLOORS_PARAMETER = ShaderParameter::getHandle("numFloors");
 
 Building::Building(void) : Entity() {
     shader = Shader::getOrCreate(SHADER_LIGHT_BASIC, "resources/shaders/vertNormal.glsl",
         "resources/shaders/fragLight.glsl", false);
     shader->addUser();
     this->cityBlock = nullptr;
+    this->textureIndex = 1;
+    this->batched = false;
+    this->instanced = false;
 }
 
-Building::Building(CityBlock *cityBlock, Vector3 blockPosition) : Entity() {
+Building::Building(CityBlock *cityBlock, Vector3 blockPosition, RandomStream &random) : Entity() {
     setModel(Model::getOrCreate(MODEL_CUBE, "resources/meshes/cube.obj", false));
     shader = Shader::getOrCreate(SHADER_LIGHT_BASIC, "resources/shaders/vertNormal.glsl",
         "resources/shaders/fragLight.glsl", false);
     shader->addUser();
     this->cityBlock = cityBlock;
-    int numFloors = (int) generateRandom(2, 10);
+    int numFloors = random.nextInt(2, 9);
     float height = numFloors * 3.2f;
     float width = 50.0f; // Width relative to the pavement
     float depth = 50.0f; // Depth relative to going inwards the city block, to the centre of it
-    this->scale = Vector3(width / 2.0f, height / 2.0f, depth / 2.0f);
-    this->position = blockPosition;
-    this->position.x += width / 2.0f;
-    this->position.y += height / 2.0f;
-    this->position.z += depth / 2.0f;
+    setScale(Vector3(width / 2.0f, height / 2.0f, depth / 2.0f));
+    setPosition(blockPosition + Vector3(width / 2.0f, height / 2.0f, depth / 2.0f));
     this->renderRadius = Vector3(width, height, depth).getLength();
     this->lotArea = new std::vector<Vector2>();
+    this->textureIndex = 1;
+    this->batched = false;
+    this->instanced = false;
 }
 
 Building::Building(std::vector<Vector2> lotArea, CityBlock *cityBlock, bool connects, const Vector2 &roadNormal) {
@@ -42,11 +49,13 @@ Building::Building(std::vector<Vector2> lotArea, CityBlock *cityBlock, bool conn
     centrePos /= (float) numSidesLot;
     this->connectsToRoad = connects;
     this->roadConnection = roadNormal;
+    this->textureIndex = 1;
+    this->batched = false;
+    this->instanced = false;
 
     // Set the Building position within its CityBlock
     Vector3 cityBlockPos = cityBlock->getPosition();
-    this->position = Vector3(centrePos.x - cityBlockPos.x, 0, centrePos.y - cityBlockPos.z);
-    this->rotChanged = true; // Forces the ModelMatrix to be updated
+    setPosition(Vector3(centrePos.x - cityBlockPos.x, 0, centrePos.y - cityBlockPos.z));
 
     /*******************************************************************************************
      * Use density and CityBlock position to choose the height and texture of this Building
@@ -55,7 +64,6 @@ Building::Building(std::vector<Vector2> lotArea, CityBlock *cityBlock, bool conn
     float baseHeight = cityBlock->getPosition().y;
     float density = cityBlock->getDensity();
     int posSum = (int) abs(centrePos.x + centrePos.y); // Used to choose stuff
-    // TODO: Switch generateRandom with the same MOD calculations as in the CityBlock
     switch (cityBlock->getType()) {
     case CITY_BLOCK_RESIDENTIAL_LOW: {
         numFloors = (int) (1 + ((posSum % 8) * density));
@@ -153,7 +161,15 @@ Building::Building(std::vector<Vector2> lotArea, CityBlock *cityBlock, bool conn
         break;
     }
     height = numFloors * 3.2f; // Assuming each floor has 3.2m of height
-    shader->addShaderParameter("numFloors", PARAMETER_INT, &numFloors);
+}
+
+void Building::registerShaderParameters() {
+    Shader *buildingShader = Shader::getOrCreate(SHADER_LIGHT_BASIC, "resources/shaders/vertNormal.glsl",
+        "resources/shaders/fragLight.glsl", false);
+    if (buildingShader->getShaderParameter(NUM_FLOORS_PARAMETER) == nullptr) {
+        // The value is owned by the parameter, and deleted with it
+        buildingShader->addShaderParameter("numFloors", PARAMETER_INT, new int(0));
+    }
 }
 
 Building::~Building(void) {
@@ -175,16 +191,23 @@ Building::~Building(void) {
     }
 }
 
-void Building::draw(float millisElapsed) {
-    if (model != nullptr) {
-        Naquadah::getInstance()->getCurrentScene()->useShader(shader);
-        Naquadah::getRenderer()->updateShaderMatrix("modelMatrix", modelMatrix);
-        shader->getShaderParameter("numFloors")->setValue(&numFloors, false);
-        shader->updateShaderParameters(false);
-        model->draw();
+void Building::queueDraw(RenderQueue *queue, unsigned char /* planeMask */) {
+    if (model != nullptr && !instanced) {
+        Shader *buildingShader = LightShader::get(Naquadah::getInstance()->getCurrentScene(), LIGHT_SURFACE_BUILDING);
+        const Matrix4 &modelMatrix = getModelMatrix();
+        RenderItem &item = queue->addModel(buildingShader, model, nullptr, modelMatrix,
+            modelMatrix.getPositionVector());
+        item.setIntParameter(NUM_FLOORS_PARAMETER, numFloors);
     }
 }
 
+void Building::constructGeometry(RandomStream &random) {
+    if (cityBlock->getType() != CITY_BLOCK_RESIDENTIAL_LOW && lotArea != nullptr && lotArea->size() > 2) {
+        textureIndex = random.nextInt(1, 5);
+    }
+    constructGeometry();
+}
+
 void Building::constructGeometry() {
     if (cityBlock->getType() == CITY_BLOCK_RESIDENTIAL_LOW) {
         // Use small house models
@@ -199,82 +222,81 @@ void Building::constructGeometry() {
         roadMiddle += roadConnection.normalised() * 14.0f;
         roadMiddle.x -= cityBlockPos.x;
         roadMiddle.y -= cityBlockPos.z;
-        setPosition(Vector3(roadMiddle.x, position.y, roadMiddle.y));
+        setPosition(Vector3(roadMiddle.x, getPosition().y, roadMiddle.y));
         setRotation(Vector3(0, angle, 0));
         numFloors = -1;
+        instanced = true;
     } else {
-        // Generate custom cubes to use as the building model
-        if (lotArea != nullptr && lotArea->size() > 2) {
-            // Triangulate the footprint of the Building.
-            std::vector<Vector2> baseTriangles;
-            bool triangulated = Triangulation::triangulate(*lotArea, baseTriangles);
-            if (triangulated) {
-                Vector3 cityBlockPos = cityBlock->getPosition();
-                cityBlock->setPosition(cityBlockPos); // Forces the ModelMatrix to be updated
-
-                Vector2 centrePos;
-                auto itEnd = lotArea->end();
-                int numSidesLot = (int) this->lotArea->size();
-                for (auto it = this->lotArea->begin(); it != itEnd; it++) {
-                    centrePos += (*it);
-                }
-                centrePos /= (float) numSidesLot;
+        // Custom Buildings are merged with the others of the same texture by the CityBlock, see buildBatches()
+        setModel(nullptr);
+        batched = lotArea != nullptr && lotArea->size() > 2;
+    }
+}
 
-                std::vector<Vector3> vertices = std::vector<Vector3>();
-                std::vector<Vector2> uv_maps = std::vector<Vector2>();
+bool Building::buildMesh(MeshData &mesh) {
+    if (lotArea == nullptr || lotArea->size() < 3) return false;
+    // Triangulate the footprint of the Building.
+    std::vector<Vector2> baseTriangles;
+    if (!Triangulation::triangulate(*lotArea, baseTriangles)) return false;
 
-                // Transform the base faces into the roof faces, applying the correct height.
-                itEnd = baseTriangles.end();
-                for (auto it = baseTriangles.begin(); it != itEnd; it++) {
-                    // The lotArea is in world position, we need to transform it to model coordinates.
-                    // A model should have (0, 0, 0) at its centre, so we subtract centrePos from it.
-                    // The Building will actually have (0, height / 2, 0) as its centre.
-                    vertices.push_back(Vector3((*it).x - centrePos.x, height, (*it).y - centrePos.y));
-                }
-                // TODO: Calculate uv_map here
-                uv_maps.push_back(Vector2(-1.0f, -1.0f));
-                uv_maps.push_back(Vector2(-1.0f, 0.0f));
-                uv_maps.push_back(Vector2(0.0f, 0.0f));
-                uv_maps.push_back(Vector2(0.0f, 0.0f));
-                uv_maps.push_back(Vector2(0.0f, -1.0f));
-                uv_maps.push_back(Vector2(-1.0f, -1.0f));
-                // For each side of the roof polygon (lotArea), create a quad that will be the walls of the Building.
-                for (int i = 1; i < numSidesLot + 1; i++) {
-                    Vector2 a2 = lotArea->at(i - 1) - centrePos;
-                    Vector2 b2 = ((i == numSidesLot) ? lotArea->at(0) : lotArea->at(i)) - centrePos;
-                    Vector3 a = Vector3(a2.x, height, a2.y); // A ---- B
-                    Vector3 b = Vector3(b2.x, height, b2.y); // | \    |
-                    Vector3 c = Vector3(a2.x, 0, a2.y);      // |   \  |
-                    Vector3 d = Vector3(b2.x, 0, b2.y);      // C ---- D
-                    float width = (a - b).getLength();
-                    float texScaleX = width / 10.0f;
-                    // Add the 2 triangles that form up the quad for each wall
-                    vertices.push_back(a); // Triangle 1: ABD
-                    vertices.push_back(b);
-                    vertices.push_back(d);
-                    vertices.push_back(a); // Triangle 2: ADC
-                    vertices.push_back(d);
-                    vertices.push_back(c);
-                    uv_maps.push_back(Vector2(0.0f, 0.0f));
-                    uv_maps.push_back(Vector2(texScaleX, 0.0f));
-                    uv_maps.push_back(Vector2(texScaleX, (float) numFloors));
-                    uv_maps.push_back(Vector2(0.0f, 0.0f));
-                    uv_maps.push_back(Vector2(texScaleX, (float) numFloors));
-                    uv_maps.push_back(Vector2(0.0f, (float) numFloors));
-                }
-                // Create the Model using the vertices
-                std::string modelName = getEntityName();
-                modelName.replace(0, 8, "MODEL");
-                std::stringstream texFileName;
-                int texIndex = (int) generateRandom(1, 6);
-                texFileName << "resources/textures/buildings/office_" << texIndex << ".png";
-                Texture *texture = Texture::getOrCreate(texIndex + 1010, texFileName.str(), false);
+    Vector2 centrePos;
+    auto itEnd = lotArea->end();
+    int numSidesLot = (int) this->lotArea->size();
+    for (auto it = this->lotArea->begin(); it != itEnd; it++) {
+        centrePos += (*it);
+    }
+    centrePos /= (float) numSidesLot;
 
-                Model::getOrCreate(ResourcesManager::generateNextName(), vertices, uv_maps, Colour::WHITE, texture, false);
+    std::vector<Vector3> vertices = std::vector<Vector3>();
+    std::vector<Vector2> uv_maps = std::vector<Vector2>();
 
-                setModel(Model::getOrCreate(ResourcesManager::generateNextName(), vertices, uv_maps, Colour::WHITE,
-                    texture, false));
-            }
-        }
+    // Transform the base faces into the roof faces, applying the correct height.
+    itEnd = baseTriangles.end();
+    for (auto it = baseTriangles.begin(); it != itEnd; it++) {
+        // The lotArea is in world position, we need to transform it to model coordinates.
+        // A model should have (0, 0, 0) at its centre, so we subtract centrePos from it.
+        // The Building will actually have (0, height / 2, 0) as its centre.
+        vertices.push_back(Vector3((*it).x - centrePos.x, height, (*it).y - centrePos.y));
     }
+    // TODO: Calculate uv_map here
+    uv_maps.push_back(Vector2(-1.0f, -1.0f));
+    uv_maps.push_back(Vector2(-1.0f, 0.0f));
+    uv_maps.push_back(Vector2(0.0f, 0.0f));
+    uv_maps.push_back(Vector2(0.0f, 0.0f));
+    uv_maps.push_back(Vector2(0.0f, -1.0f));
+    uv_maps.push_back(Vector2(-1.0f, -1.0f));
+    uv_maps.resize(vertices.size(), Vector2(-1.0f, -1.0f)); // Keep the walls aligned with their uv_maps
+    // For each side of the roof polygon (lotArea), create a quad that will be the walls of the Building.
+    for (int i = 1; i < numSidesLot + 1; i++) {
+        Vector2 a2 = lotArea->at(i - 1) - centrePos;
+        Vector2 b2 = ((i == numSidesLot) ? lotArea->at(0) : lotArea->at(i)) - centrePos;
+        Vector3 a = Vector3(a2.x, height, a2.y); // A ---- B
+        Vector3 b = Vector3(b2.x, height, b2.y); // | \    |
+        Vector3 c = Vector3(a2.x, 0, a2.y);      // |   \  |
+        Vector3 d = Vector3(b2.x, 0, b2.y);      // C ---- D
+        float width = (a - b).getLength();
+        float texScaleX = width / 10.0f;
+        // Add the 2 triangles that form up the quad for each wall
+        vertices.push_back(a); // Triangle 1: ABD
+        vertices.push_back(b);
+        vertices.push_back(d);
+        vertices.push_back(a); // Triangle 2: ADC
+        vertices.push_back(d);
+        vertices.push_back(c);
+        uv_maps.push_back(Vector2(0.0f, 0.0f));
+        uv_maps.push_back(Vector2(texScaleX, 0.0f));
+        uv_maps.push_back(Vector2(texScaleX, (float) numFloors));
+        uv_maps.push_back(Vector2(0.0f, 0.0f));
+        uv_maps.push_back(Vector2(texScaleX, (float) numFloors));
+        uv_maps.push_back(Vector2(0.0f, (float) numFloors));
+    }
+
+    MeshData buildingMesh;
+    buildingMesh.vertices.swap(vertices);
+    buildingMesh.uv_maps.swap(uv_maps);
+    buildingMesh.generateNormals();
+    buildingMesh.floors.assign(buildingMesh.vertices.size(), (float) numFloors);
+    // Custom Buildings are never rotated or scaled, so their position is all that's needed to place them
+    mesh.append(buildingMesh, getPosition());
+    return true;
 }
\ No newline at end of file
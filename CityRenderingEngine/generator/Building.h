@@ -9,6 +9,7 @@
 
 #include <vector>
 #include "CityBlock.h"
+#include "math/RandomStream.h"
 #include "../engine/Entity.h"
 #include "../engine/math/Common.h"
 #include "../engine/math/Vector2.h"
@@ -19,22 +20,75 @@ class CityBlock;
 class Building : public Entity {
 public:
 
+    /*
+     * Value of the numFloors shader parameter telling the Shader to read the number of floors from the floors vertex
+     * attribute instead, as in the batched meshes of CityBlock, which merge Buildings with different number of floors.
+     */
+    static const int FLOORS_PER_VERTEX = -2;
+
+    /* Handle of the numFloors shader parameter, also used by CityBlock and Chunk. */
+    static const ShaderParameterHandle NUM_FLOORS_PARAMETER;
+
+    /*
+     * Adds the numFloors parameter to the shared Building Shader. It must be called once, on the main thread, before
+     * any Chunk is generated, as the parameters of a Shader can't be changed while the render thread is using them.
+     */
+    static void registerShaderParameters();
+
     Building(void);
-    Building(CityBlock *cityBlock, Vector3 blockPosition);
+    Building(CityBlock *cityBlock, Vector3 blockPosition, RandomStream &random);
     /* Constructor with a vector of Vector2 to delimiter the area that this Building will occupy. */
     Building(std::vector<Vector2> lotArea, CityBlock *cityBlock, bool connects, const Vector2 &roadNormal);
 
     virtual ~Building(void);
 
-    virtual void draw(float millisElapsed);
+    /* Adds the Model of this Building to queue, unless it's batched or instanced, which are drawn by others. */
+    virtual void queueDraw(RenderQueue *queue, unsigned char planeMask);
 
     /*
      * This function should only be called after both the lotArea and the type attributes are set. It will define and
      * build the 3D model for the building. If the building already has a 3D model, it will erase and unload the older
-     * one and recreate it.
+     * one and recreate it. The random stream is used to pick the variations of the model, like its texture.
+     */
+    void constructGeometry(RandomStream &random);
+
+    /*
+     * Builds the 3D model using the variations already picked, as when this Building is loaded from a file. Custom
+     * Buildings don't get a Model of their own, they're marked as batched and drawn by their CityBlock instead, after
+     * CityBlock::buildBatches() is called.
      */
     void constructGeometry();
 
+    /*
+     * Builds the custom model of this Building into mesh, relative to the position of this Building, with its number
+     * of floors on every vertex. Returns false if the lot can't be triangulated. This doesn't use OpenGL, so it's safe
+     * to call from the ChunkLoader workers.
+     */
+    bool buildMesh(MeshData &mesh);
+
+    /* Returns true if this Building is drawn as part of the batched meshes of its CityBlock. */
+    bool isBatched() { return batched; }
+
+    /* Returns true if this Building uses a shared Model, and is drawn by its Chunk with an InstanceBatch. */
+    bool isInstanced() { return instanced; }
+
+    std::vector<Vector2> *getLotArea() { return lotArea; }
+    CityBlock *getCityBlock() { return cityBlock; }
+    bool getConnectsToRoad() { return connectsToRoad; }
+    Vector2 getRoadConnection() { return roadConnection; }
+    float getHeight() { return height; }
+    int getNumFloors() { return numFloors; }
+    int getTextureIndex() { return textureIndex; }
+
+    /* Sets the height and number of floors. Must be called before constructGeometry(). */
+    void setFloors(int numFloors, float height) {
+        this->numFloors = numFloors;
+        this->height = height;
+    }
+
+    /* Sets the index of the texture used by the custom Building models. Must be called before constructGeometry(). */
+    void setTextureIndex(int textureIndex) { this->textureIndex = textureIndex; }
+
     /* Returns a unique name identifier for this Building. */
     std::string getEntityName() {
         std::stringstream name;
@@ -60,6 +114,15 @@ protected:
     /* The name of the texture that will be used for this Building. */
     std::string textureName;
 
+    /* The index of the texture used by the custom models, from resources/textures/buildings/office_N.png. */
+    int textureIndex;
+
+    /* Indicates if this Building is drawn by its CityBlock, instead of having its own Model. */
+    bool batched;
+
+    /* Indicates if this Building is drawn by its Chunk as an instance of its shared Model. */
+    bool instanced;
+
     /* A flag indicating whether this Building connects to any road. Defaults to false. */
     bool connectsToRoad;
 
@@ -1,38 +1,83 @@
 #include "Chunk.h"
+#include "RegionManager.h"
+#include "../engine/rendering/RenderQueue.h"
+#include "../engine/rendering/LightShader.h"
 
 Chunk::Chunk(void) : Entity(), Resource() {
     this->intersections = new std::vector<Intersection*>();
     this->intersections->reserve(100);
+    this->intersectionGrid = new IntersectionGrid((float) Chunk::INTERSECTION_GRID_CELL_SIZE);
     this->roads = new std::vector<Road*>();
     this->cityBlocks = new std::vector<CityBlock*>();
     this->setRenderRadius((Chunk::CHUNK_SIZE * 1.42f) / 2.0f);
+    // The children of a Chunk all have world coordinate transforms
+    this->childrenInheritTransform = false;
+    // A Chunk only updates its own children, so all Chunks can be updated in parallel
+    this->independentUpdate = true;
+    this->sceneHandle = INVALID_ENTITY_HANDLE;
+    this->arena = new MemoryArena();
     this->city = nullptr;
     this->safeToDelete = false;
     this->childEntities->reserve(500);
+    createInstanceBatches();
 }
 
 Chunk::Chunk(const Vector2 &position, City *city) : Entity(), Resource() {
-    this->position = Vector3(position.x + 500.0f, 0, position.y + 500.0f);
+    setPosition(Vector3(position.x + 500.0f, 0, position.y + 500.0f));
+    // The children of a Chunk all have world coordinate transforms
+    this->childrenInheritTransform = false;
+    // A Chunk only updates its own children, so all Chunks can be updated in parallel
+    this->independentUpdate = true;
+    this->sceneHandle = INVALID_ENTITY_HANDLE;
+    this->arena = new MemoryArena();
     this->intersections = new std::vector<Intersection*>();
     this->intersections->reserve(100);
+    this->intersectionGrid = new IntersectionGrid((float) Chunk::INTERSECTION_GRID_CELL_SIZE);
     this->roads = new std::vector<Road*>();
     this->cityBlocks = new std::vector<CityBlock*>();
     this->setRenderRadius((Chunk::CHUNK_SIZE * 1.42f) / 2.0f);
     this->city = city;
     this->safeToDelete = false;
     this->childEntities->reserve(500);
+    createInstanceBatches();
     float groundScale = ((float) Chunk::CHUNK_SIZE) / 2.0f;
-    Vector3 groundPos = Vector3(this->position.x, this->position.y - 0.1f, this->position.z);
+    Vector3 groundPos = getPosition() - Vector3(0, 0.1f, 0);
     this->ground = new Entity(groundPos, Vector3(0, 0, 0), Vector3(groundScale, 1, groundScale));
     this->ground->setModel(Model::getOrCreate(MODEL_GROUND, "resources/meshes/plane.obj", false));
 }
 
 Chunk::~Chunk(void) {
+    // The children left are deleted now, as the Entity destructor would only do it after the arena is gone
+    for (auto it = childEntities->begin(); it != childEntities->end(); it++) {
+        delete *it;
+    }
+    childEntities->clear();
+    numChildEntities = 0;
+    if (arena != nullptr) {
+        const ArenaStats &stats = arena->getStats();
+        if (stats.numLiveObjects > 0) {
+            // Something may still point to them, so the arena is leaked instead of leaving them dangling. The leak is
+            // counted in the arena totals (see ChunkBenchmark), so it's only logged in debug builds
+#ifdef _DEBUG
+            std::stringstream leakLog;
+            leakLog << "Chunk " << getChunkPos() << " leaked " << stats.numLiveObjects << " objects, " <<
+                stats.bytesLive << " bytes" << std::endl;
+            std::cout << leakLog.str();
+#endif
+        } else {
+            delete arena;
+        }
+        arena = nullptr;
+    }
     if (intersections != nullptr) {
         //intersections->clear();
         delete intersections;
         intersections = nullptr;
     }
+    if (intersectionGrid != nullptr) {
+        delete intersectionGrid;
+        intersectionGrid = nullptr;
+    }
     if (roads != nullptr) {
         //roads->clear();
         delete roads;
@@ -44,67 +89,151 @@ Chunk::~Chunk(void) {
         cityBlocks = nullptr;
     }
     city = nullptr;
-}
-
-void Chunk::calculateModelMatrix(Vector3 addPos, Vector3 addRot, Vector3 addSiz, bool pDiff, bool rDiff, bool sDiff) {
-    // A Chunk won't be rendered itself, so it does not need a modelMatrix
-    // We only need to update its children's modelMatrix
-    if (numChildEntities > 0) {
-        for(auto it = childEntities->begin(); it != childEntities->end(); it++) {
-            // We also don't pass any derived transform values, as all children will have world coordinate transforms
-            (*it)->calculateModelMatrix(Vector3(), Vector3(), Vector3(1, 1, 1), false, false, false);
-        }
+    if (roadInstances != nullptr) {
+        delete roadInstances;
+        roadInstances = nullptr;
+    }
+    if (intersectionInstances != nullptr) {
+        delete intersectionInstances;
+        intersectionInstances = nullptr;
+    }
+    if (houseInstances != nullptr) {
+        delete houseInstances;
+        houseInstances = nullptr;
+    }
+    if (cityBlockTree != nullptr) {
+        delete cityBlockTree;
+        cityBlockTree = nullptr;
     }
 }
 
 void Chunk::update(float millisElapsed) {
-    calculateModelMatrix(Vector3(), Vector3(), Vector3(1, 1, 1), false, false, false);
+    // The transforms of all the children are in the store of the Chunk, and updated in a single pass
+    updateTransforms();
     ground->update(millisElapsed);
     // Update the distanceToCamera if that's changed
     if (Naquadah::getInstance()->getCurrentScene()->getCamera()->hasChanged()) {
         Camera *camera = Naquadah::getInstance()->getCurrentScene()->getCamera();
-        Vector3 dir = position - camera->getPosition();
+        Vector3 dir = getPosition() - camera->getPosition();
         distanceToCamera = Vector3::dot(dir, dir);
     }
 
     if (numChildEntities > 0) {
         for (std::vector<Entity*>::iterator it = childEntities->begin(); it != childEntities->end(); it++) {
-            (*it)->update(millisElapsed);
+            // The children shared with other Chunks are only updated by their parent, which may be on another thread
+            if ((*it)->getParent() == this) {
+                (*it)->update(millisElapsed);
+            }
         }
     }
 }
 
-void Chunk::draw(float millisElapsed) {
-    if (numChildEntities > 0) {
-        Frustum *frustum = Naquadah::getInstance()->getCurrentScene()->getFrustum();
-        for (auto it = childEntities->begin(); it != childEntities->end(); ++it) {
-            if (frustum->isEntityInside(*it)) {
-                (*it)->draw(millisElapsed);
+void Chunk::queueDraw(RenderQueue *queue, unsigned char planeMask) {
+    Scene *scene = Naquadah::getInstance()->getCurrentScene();
+    if (contentsChanged) {
+        rebuildContents();
+    }
+    OcclusionBuffer *occlusionBuffer = scene->getOcclusionBuffer();
+    if (occlusionBuffer->isBoxOccluded(bounds)) return;
+    // Roads, Intersections and small houses are drawn with one instanced draw call each
+    if (roadInstances->getNumInstances() > 0 || intersectionInstances->getNumInstances() > 0) {
+        Shader *roadShader = Shader::getOrCreate(SHADER_LIGHT_ROAD,
+            "resources/shaders/vertRoad.glsl", "resources/shaders/fragRoad.glsl", false);
+        queue->addInstanceBatch(roadShader, roadInstances, getPosition());
+        queue->addInstanceBatch(roadShader, intersectionInstances, getPosition());
+    }
+    // The houses and the ground aren't Buildings, so their uv_maps are drawn as they are
+    Shader *groundShader = LightShader::get(scene, LIGHT_SURFACE_GROUND);
+    if (houseInstances->getNumInstances() > 0) {
+        queue->addInstanceBatch(groundShader, houseInstances, getPosition()).setIntParameter(
+            Building::NUM_FLOORS_PARAMETER, -1);
+    }
+    // The CityBlocks add their batched Buildings, and the Buildings that aren't instanced
+    Frustum *frustum = scene->getFrustum();
+    std::vector<Entity*> visibleBlocks;
+    cityBlockTree->collectVisible(frustum, planeMask, visibleBlocks);
+    auto itEnd = visibleBlocks.end();
+    for (auto it = visibleBlocks.begin(); it != itEnd; ++it) {
+        if (occlusionBuffer->isBoxOccluded(((CityBlock*) (*it))->getBoundingBox())) continue;
+        frustum->addObjectDrawn();
+        (*it)->queueDraw(queue, planeMask);
+    }
+    Texture *grass = Texture::getOrCreate(TEXTURE_GRASS, "resources/textures/grass_1.jpg", true);
+    queue->addModel(groundShader, ground->getModel(), grass, ground->getModelMatrix(), ground->getPosition())
+        .setIntParameter(Building::NUM_FLOORS_PARAMETER, -1);
+}
+
+void Chunk::createInstanceBatches() {
+    this->roadInstances = new InstanceBatch(Model::getOrCreate(MODEL_ROAD, "resources/meshes/plane.obj", false));
+    this->intersectionInstances = new InstanceBatch(Model::getOrCreate(MODEL_INTERSECTION,
+        "resources/meshes/plane.obj", false));
+    this->houseInstances = new InstanceBatch(Model::getOrCreate(MODEL_SIMPLE_HOUSE,
+        "resources/meshes/simple_house.obj", false));
+    this->cityBlockTree = nullptr;
+    this->contentsChanged = true;
+}
+
+void Chunk::rebuildContents() {
+    roadInstances->clear();
+    intersectionInstances->clear();
+    houseInstances->clear();
+    // Roads and Intersections on the seams are only drawn by the Chunk that contains them, as in hideOutsideChildren
+    for (auto it = roads->begin(); it != roads->end(); it++) {
+        if (containsPosition((*it)->getPosition())) {
+            float roadScale = (*it)->getScale().z * 2.0f;
+            roadInstances->addInstance(calculateInstanceMatrix(*it), Vector4(roadScale, 0, 0, 0));
+        }
+    }
+    for (auto it = intersections->begin(); it != intersections->end(); it++) {
+        if (containsPosition((*it)->getPosition())) {
+            float roadScale = (*it)->getScale().z * 2.0f;
+            intersectionInstances->addInstance(calculateInstanceMatrix(*it), Vector4(roadScale, 0, 0, 0));
+        }
+    }
+    Vector2 chunkPos = getChunkPos();
+    float height = getPosition().y;
+    bounds = BoundingBox(Vector3(chunkPos.x, height, chunkPos.y),
+        Vector3(chunkPos.x + CHUNK_SIZE, height, chunkPos.y + CHUNK_SIZE));
+    if (cityBlockTree == nullptr) {
+        cityBlockTree = new Quadtree(bounds, QUADTREE_DEPTH);
+    } else {
+        cityBlockTree->clear();
+    }
+    for (auto it = cityBlocks->begin(); it != cityBlocks->end(); it++) {
+        cityBlockTree->insert(*it, (*it)->getBoundingBox());
+        bounds.addBox((*it)->getBoundingBox());
+        std::vector<Entity*> *buildings = (*it)->getBuildings();
+        for (auto itB = buildings->begin(); itB != buildings->end(); itB++) {
+            Building *building = (Building*) (*itB);
+            if (building->isInstanced()) {
+                houseInstances->addInstance(calculateInstanceMatrix(building), Vector4());
             }
         }
     }
-    Texture *grass = Texture::getOrCreate(TEXTURE_GRASS, "resources/textures/grass_1.jpg", true);
-    Naquadah::getInstance()->getCurrentScene()->useShader(Shader::getOrCreate(SHADER_LIGHT_BASIC,
-        "resources/shaders/vertNormal.glsl", "resources/shaders/fragLight.glsl", false));
-    Shader *shader = Naquadah::getRenderer()->getCurrentShader();
-    int numFloors = -1;
-    shader->getShaderParameter("numFloors")->setValue(&numFloors, false);
-    shader->updateShaderParameters(false);
-    grass->bindTexture(shader->getShaderProgram(), TEXTURE0);
-    ground->draw(millisElapsed);
+    contentsChanged = false;
+}
+
+Matrix4 Chunk::calculateInstanceMatrix(Entity *entity) {
+    // Same transform as the TransformStore, Chunks and CityBlocks are never rotated or scaled. It's built here because
+    // the Intersections and Roads hidden by hideOutsideChildren() aren't in the Chunk's store, and aren't updated
+    return Matrix4::Transform(entity->getWorldPosition(), entity->getRotation(), entity->getScale());
 }
 
 void Chunk::addIntersection(Intersection *intersection) {
     intersections->push_back(intersection);
+    intersectionGrid->insert(intersection);
     intersection->addChunkSharing();
     addChild(intersection);
+    contentsChanged = true;
 }
 
 void Chunk::removeIntersection(Intersection *intersection) {
     auto itEnd = intersections->end();
     intersections->erase(std::remove(intersections->begin(), itEnd, intersection), itEnd);
+    intersectionGrid->remove(intersection);
     intersection->removeChunkSharing();
     removeChild(intersection);
+    contentsChanged = true;
 }
 
 bool Chunk::hasIntersection(Intersection *intersection) {
@@ -120,6 +249,7 @@ void Chunk::addRoad(Road *road) {
     roads->push_back(road);
     road->addChunkSharing();
     addChild(road);
+    contentsChanged = true;
 }
 
 void Chunk::removeRoad(Road *road) {
@@ -127,12 +257,14 @@ void Chunk::removeRoad(Road *road) {
     roads->erase(std::remove(roads->begin(), itEnd, road), itEnd);
     road->removeChunkSharing();
     removeChild(road);
+    contentsChanged = true;
 }
 
 void Chunk::addCityBlock(CityBlock *cityBlock) {
     cityBlocks->push_back(cityBlock);
     cityBlock->addChunkSharing();
     addChild(cityBlock);
+    contentsChanged = true;
 }
 
 void Chunk::removeCityBlock(CityBlock *cityBlock) {
@@ -140,49 +272,38 @@ void Chunk::removeCityBlock(CityBlock *cityBlock) {
     cityBlocks->erase(std::remove(cityBlocks->begin(), itEnd, cityBlock), itEnd);
     cityBlock->removeChunkSharing();
     removeChild(cityBlock);
+    contentsChanged = true;
 }
 
-Intersection *Chunk::getClosestIntersectionTo(const Vector3 &position) {
-    auto it = intersections->begin();
-    auto endIt = intersections->end();
-    Intersection *closest = nullptr;
-    float closestDistance = 999999.9f;
-    for (; it != endIt; it++) {
-        float distance = (position - (*it)->getPosition()).getLength();
-        if (distance < closestDistance) {
-            closest = (*it);
-            closestDistance = distance;
-        }
-    }
-    return closest;
+Intersection *Chunk::getClosestIntersectionTo(const Vector3 &position, float maxDistance) {
+    return intersectionGrid->getClosestTo(position, maxDistance);
 }
 
 std::vector<Intersection*> Chunk::getClosestIntersectionsTo(Intersection *intersection, int number) {
-    std::vector<Intersection*> orderedIntersections = std::vector<Intersection*>();
-    std::vector<float> distances = std::vector<float>();
+    return intersectionGrid->getClosestListTo(intersection->getWorldPosition(), number);
+}
+
+std::vector<Intersection*> Chunk::getIntersectionsWithin(const Vector3 &position, float radius) {
+    return intersectionGrid->getWithinRadius(position, radius);
+}
+
+bool Chunk::hasIntersectionWithin(const Vector3 &position, float radius) {
+    return intersectionGrid->hasAnyWithinRadius(position, radius);
+}
+
+void Chunk::hideOutsideChildren() {
     auto itEnd = intersections->end();
     for (auto it = intersections->begin(); it != itEnd; it++) {
-        float distance = abs((intersection->getWorldPosition() - (*it)->getWorldPosition()).getLength());
-        bool inserted = false;
-        int distancesSize = (int) distances.size();
-        for (int i = 0; i < distancesSize; i++) {
-            if (distance <= distances.at(i) && distance != 0.0f) {
-                orderedIntersections.insert(orderedIntersections.begin() + i, (*it));
-                distances.insert(distances.begin() + i, distance);
-                inserted = true;
-                break;
-            }
-        }
-        if (!inserted && distance != 0.0f) {
-            orderedIntersections.push_back((*it));
-            distances.push_back(distance);
+        if (!containsPosition((*it)->getPosition())) {
+            removeChild(*it);
         }
     }
-    if (orderedIntersections.size() > number) {
-        orderedIntersections.erase(orderedIntersections.begin() + number, orderedIntersections.end());
-        orderedIntersections.shrink_to_fit();
+    auto itRoadEnd = roads->end();
+    for (auto it = roads->begin(); it != itRoadEnd; it++) {
+        if (!containsPosition((*it)->getPosition())) {
+            removeChild(*it);
+        }
     }
-    return orderedIntersections;
 }
 
 void Chunk::load() {
@@ -213,20 +334,17 @@ void Chunk::unload() {
         }
     }
     intersections->clear();
-    // TODO: Find and fix a small memoryleak on the chunk loading/unloading, about 4kb each 20 or so chunks
+    intersectionGrid->clear();
 
-    // Unload the Roads
-    for (auto it = roads->begin(); it != roads->end(); it++) {
-        //removeChild(*it);
-        //if (((*it)->getPointA() == nullptr || (*it)->getPointA()->getNumChunksSharing() <= 1)
-            //&& ((*it)->getPointB() == nullptr || (*it)->getPointB()->getNumChunksSharing() <= 1)) {
-            //delete *it;
-        //}
-    }
+    // The Roads were deleted with their Intersections, only the ones shared with other Chunks are left
     roads->clear();
+    contentsChanged = true;
 }
 
 void Chunk::unloadOpenGL() {
+    roadInstances->unload();
+    intersectionInstances->unload();
+    houseInstances->unload();
     auto itEnd = cityBlocks->end();
     for (auto it = cityBlocks->begin(); it != itEnd; it++) {
         if ((*it)->getNumChunksSharing() <= 1) {
@@ -235,20 +353,184 @@ void Chunk::unloadOpenGL() {
     }
 }
 
-void Chunk::saveToFile() {
+/*
+ * Writes the index in the file of intersection. Returns false if it's not one of the Intersections of the Chunk, as
+ * any index written would refer to another Intersection.
+ */
+static bool writeIntersectionIndex(BinaryBuffer &buffer,
+    const std::unordered_map<Intersection*, unsigned int> &indices, Intersection *intersection) {
+    auto it = indices.find(intersection);
+    if (it == indices.end()) return false;
+    buffer.write(it->second);
+    return true;
+}
+
+bool Chunk::saveToFile() {
+    BinaryBuffer buffer;
+    Vector2 chunkPos = getChunkPos();
+    buffer.write((unsigned int) Chunk::FILE_MAGIC);
+    buffer.write((unsigned short) Chunk::FILE_VERSION);
+    buffer.write(city != nullptr ? city->getSeed() : 0ULL);
+    buffer.write(chunkPos.x);
+    buffer.write(chunkPos.y);
+
+    // Intersections are referenced by their index in the file
+    std::unordered_map<Intersection*, unsigned int> indices = std::unordered_map<Intersection*, unsigned int>();
+    unsigned int numIntersections = (unsigned int) intersections->size();
+    buffer.write(numIntersections);
+    for (unsigned int i = 0; i < numIntersections; i++) {
+        indices[intersections->at(i)] = i;
+        Vector3 interPos = intersections->at(i)->getPosition();
+        buffer.write(interPos.x);
+        buffer.write(interPos.z);
+    }
+
+    buffer.write((unsigned int) roads->size());
+    for (auto it = roads->begin(); it != roads->end(); it++) {
+        if (!writeIntersectionIndex(buffer, indices, (*it)->getPointA()) ||
+            !writeIntersectionIndex(buffer, indices, (*it)->getPointB())) {
+            return false;
+        }
+    }
 
+    buffer.write((unsigned int) cityBlocks->size());
+    for (auto it = cityBlocks->begin(); it != cityBlocks->end(); it++) {
+        CityBlock *cityBlock = (*it);
+        buffer.write(cityBlock->getDensity());
+        buffer.write((unsigned char) cityBlock->getType());
+        std::vector<Intersection*> *vertices = cityBlock->getVertices();
+        buffer.write((unsigned short) vertices->size());
+        for (auto itV = vertices->begin(); itV != vertices->end(); itV++) {
+            if (!writeIntersectionIndex(buffer, indices, *itV)) return false;
+        }
+        std::vector<Entity*> *buildings = cityBlock->getBuildings();
+        buffer.write((unsigned short) buildings->size());
+        for (auto itB = buildings->begin(); itB != buildings->end(); itB++) {
+            Building *building = (Building*) (*itB);
+            std::vector<Vector2> *lotArea = building->getLotArea();
+            buffer.write((unsigned short) lotArea->size());
+            for (auto itL = lotArea->begin(); itL != lotArea->end(); itL++) {
+                buffer.write((*itL).x);
+                buffer.write((*itL).y);
+            }
+            buffer.write((unsigned char) (building->getConnectsToRoad() ? 1 : 0));
+            buffer.write(building->getRoadConnection().x);
+            buffer.write(building->getRoadConnection().y);
+            buffer.write((short) building->getNumFloors());
+            buffer.write(building->getHeight());
+            buffer.write((unsigned char) building->getTextureIndex());
+        }
+    }
+    return RegionManager::writeChunk(chunkPos, buffer);
 }
 
 std::string Chunk::getFileName() {
-    return Chunk::getFileName(Vector2(position.x, position.z));
+    return Chunk::getFileName(getChunkPos());
+}
+
+std::string Chunk::getFileName(const Vector2 &position) {
+    return RegionManager::getFileName(position);
 }
 
 bool Chunk::chunkExists(const Vector2 &position) {
-    return FileIO::fileExists(Chunk::getFileName(position));
+    return RegionManager::chunkExists(position);
 }
 
 Chunk *Chunk::loadChunk(const Vector2 &position, City *city) {
-    //Chunk *chunk = new Chunk(position, city);
-    //return chunk;
-    return nullptr;
+    BinaryBuffer buffer;
+    if (!RegionManager::readChunk(position, buffer)) {
+        return nullptr;
+    }
+    unsigned int magic = buffer.read<unsigned int>();
+    unsigned short version = buffer.read<unsigned short>();
+    unsigned long long seed = buffer.read<unsigned long long>();
+    float chunkPosX = buffer.read<float>();
+    float chunkPosY = buffer.read<float>();
+    if (buffer.hasFailed() || magic != Chunk::FILE_MAGIC || version != Chunk::FILE_VERSION) {
+        return nullptr;
+    }
+    if (seed != city->getSeed() || chunkPosX != position.x || chunkPosY != position.y) {
+        return nullptr; // This file belongs to another City, or to another Chunk
+    }
+
+    Chunk *chunk = new Chunk(position, city);
+    unsigned int numIntersections = buffer.read<unsigned int>();
+    std::vector<Intersection*> loadedIntersections = std::vector<Intersection*>();
+    loadedIntersections.reserve(numIntersections);
+    for (unsigned int i = 0; i < numIntersections && !buffer.hasFailed(); i++) {
+        float posX = buffer.read<float>();
+        float posZ = buffer.read<float>();
+        Intersection *intersection = new (chunk->getArena()) Intersection(Vector3(posX, 0, posZ));
+        chunk->addIntersection(intersection);
+        loadedIntersections.push_back(intersection);
+    }
+
+    unsigned int numRoads = buffer.read<unsigned int>();
+    for (unsigned int i = 0; i < numRoads && !buffer.hasFailed(); i++) {
+        unsigned int indexA = buffer.read<unsigned int>();
+        unsigned int indexB = buffer.read<unsigned int>();
+        if (indexA >= loadedIntersections.size() || indexB >= loadedIntersections.size()) {
+            buffer.skip(buffer.getSize()); // Invalid index, the file is corrupted
+            break;
+        }
+        Road *road = loadedIntersections[indexA]->connectTo(loadedIntersections[indexB]);
+        if (road != nullptr) chunk->addRoad(road);
+    }
+
+    unsigned int numCityBlocks = buffer.read<unsigned int>();
+    for (unsigned int i = 0; i < numCityBlocks && !buffer.hasFailed(); i++) {
+        float density = buffer.read<float>();
+        unsigned char type = buffer.read<unsigned char>();
+        CityBlock *cityBlock = new (chunk->getArena()) CityBlock(density);
+        cityBlock->setType((CityBlockType) type);
+        unsigned short numVertices = buffer.read<unsigned short>();
+        for (unsigned short j = 0; j < numVertices && !buffer.hasFailed(); j++) {
+            unsigned int index = buffer.read<unsigned int>();
+            if (index >= loadedIntersections.size()) {
+                buffer.skip(buffer.getSize());
+                break;
+            }
+            cityBlock->addVertice(loadedIntersections[index]);
+        }
+        // The CityBlock is added before its Buildings, so it's deleted with the Chunk if the file is truncated
+        chunk->addCityBlock(cityBlock);
+        if (buffer.hasFailed()) break;
+        cityBlock->calculateRenderRadius();
+
+        unsigned short numBuildings = buffer.read<unsigned short>();
+        for (unsigned short j = 0; j < numBuildings && !buffer.hasFailed(); j++) {
+            unsigned short numLotPoints = buffer.read<unsigned short>();
+            std::vector<Vector2> lotArea = std::vector<Vector2>();
+            lotArea.reserve(numLotPoints);
+            for (unsigned short k = 0; k < numLotPoints; k++) {
+                float lotX = buffer.read<float>();
+                float lotY = buffer.read<float>();
+                lotArea.push_back(Vector2(lotX, lotY));
+            }
+            bool connectsToRoad = buffer.read<unsigned char>() != 0;
+            float normalX = buffer.read<float>();
+            float normalY = buffer.read<float>();
+            short numFloors = buffer.read<short>();
+            float height = buffer.read<float>();
+            unsigned char textureIndex = buffer.read<unsigned char>();
+            if (buffer.hasFailed()) break;
+            Building *building = new (chunk->getArena()) Building(lotArea, cityBlock, connectsToRoad,
+                Vector2(normalX, normalY));
+            building->setFloors(numFloors, height);
+            building->setTextureIndex(textureIndex);
+            cityBlock->addChild(building);
+            building->constructGeometry();
+        }
+        cityBlock->buildBatches();
+    }
+
+    if (buffer.hasFailed()) {
+        std::cout << "Chunk " << position << " on " << Chunk::getFileName(position)
+            << " is corrupted, it will be regenerated" << std::endl;
+        chunk->unload();
+        delete chunk;
+        return nullptr;
+    }
+    chunk->hideOutsideChildren();
+    return chunk;
 }
\ No newline at end of file
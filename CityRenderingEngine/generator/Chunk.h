@@ -14,19 +14,30 @@
  *
  * A chunk contains a vector with all the intersections that are inside it and also all intersections that are outside
  * it but are necessary to define all CityBlocks that are inside the Chunl. So if there's a CityBlock on the edge of
- * the chunk, the Chunk will have all of its Intersections, and the chunk next to it will also have the same
- * Intersections. This duplicates some Intersections when saving to file, using up more space in disk, but ensures that
- * when loading a chunk, all CityBlocks will be correctly loaded.
+ * the chunk, the Chunk will have all of its Intersections, and the chunk next to it will also have its own copies of
+ * the same Intersections. This duplicates some Intersections when saving to file, using up more space in disk, but
+ * ensures that when loading a chunk, all CityBlocks will be correctly loaded.
+ *
+ * The chunk data is saved in a compact binary format (see saveToFile()). It starts with a header with FILE_MAGIC,
+ * FILE_VERSION and the City seed, followed by the Intersection positions, the Roads as pairs of Intersection indices,
+ * and the CityBlocks as lists of Intersection indices, each with its density, type and Building lots. Data with a
+ * different version or seed is ignored, and the Chunk is generated again. The data of many Chunks is packed together
+ * in a single region file, see RegionFile and RegionManager.
  */
 
 #pragma once
 
+#include <unordered_map>
 #include "City.h"
 #include "Road.h"
 #include "CityBlock.h"
 #include "Intersection.h"
+#include "IntersectionGrid.h"
+#include "../engine/rendering/InstanceBatch.h"
+#include "../engine/rendering/Quadtree.h"
 #include "../engine/Entity.h"
 #include "../engine/Resource.h"
+#include "../engine/input/BinaryBuffer.h"
 
 class City;
 
@@ -37,24 +48,32 @@ public:
     static const int CHUNK_SIZE = 1000;
     /* Size of the subchunks. This MUST be a number that CHUKN_SIZE is divisible by. */
     static const int SUBCHUNK_SIZE = 10;
+    /*
+     * Size of the cells of the Intersection spatial grid. It matches the minimum distance between Intersections used
+     * by the generator, and MUST be a multiple of SUBCHUNK_SIZE.
+     */
+    static const int INTERSECTION_GRID_CELL_SIZE = 50;
+    /* Number of levels of the CityBlock Quadtree below its root. With 3 levels, the smallest nodes are 125m wide. */
+    static const int QUADTREE_DEPTH = 3;
+
+    /* The first four bytes of every chunk file, "CNKF". */
+    static const unsigned int FILE_MAGIC = 0x464B4E43;
+    /* Version of the chunk file format. Must be incremented whenever the format changes. */
+    static const unsigned short FILE_VERSION = 1;
 
     Chunk(void);
     Chunk(const Vector2 &position, City *city);
     virtual ~Chunk(void);
 
+    virtual void update(float millisElapsed);
+
     /*
-     * Here we get the entity's attributes and calculate the final model matrix. If the entity has children, it will
-     * update its child's matrices as well. The three parameter Vector3 are the offset of the Transform, and should be
-     * set to make children position, rotate and scale relative to their parents and grandparents. If the Entity don't
-     * have any parent, these vectors should be passed at their neutral values. The bool parameters indicate if their
-     * correspondent offset Vector3 has changed since the last frame. If they changed, the modelMatrix will have to be
-     * updated even if this Entity's Transform didn't change.
+     * Adds the contents of this Chunk that are inside the Frustum to queue: the instance batches, the ground and the
+     * visible CityBlocks. The CityBlocks are culled with the Chunk's Quadtree, starting from planeMask, so planes that
+     * already contain the whole Chunk aren't tested again. The whole Chunk, and then each visible CityBlock, are also
+     * tested against the OcclusionBuffer of the Scene.
      */
-    virtual void calculateModelMatrix(Vector3 addPos, Vector3 addRot, Vector3 addSiz,
-        bool pDiff, bool rDiff, bool sDiff);
-
-    virtual void update(float millisElapsed);
-    virtual void draw(float millisElapsed);
+    virtual void queueDraw(RenderQueue *queue, unsigned char planeMask);
 
     /*
      * Loads this chunk from file to memory. The chunk to be loaded is the one at position. If the position is invlaid
@@ -93,27 +112,47 @@ public:
     /* Removes a CityBlock from this Chunk. */
     void removeCityBlock(CityBlock *cityBlock);
 
-    /* Returns the closest Intersection to the intersection provided. */
-    Intersection *getClosestIntersectionTo(const Vector3 &position);
+    /*
+     * Returns the closest Intersection to the position provided. If maxDistance is positive, Intersections farther
+     * than that will be ignored. Returns nullptr if no Intersection was found.
+     */
+    Intersection *getClosestIntersectionTo(const Vector3 &position, float maxDistance = -1.0f);
 
     /* Returns the closest Intersections to the intersection provided. */
     std::vector<Intersection*> getClosestIntersectionsTo(Intersection *intersection, int number);
 
+    /* Returns all Intersections of this Chunk that are within radius of position. */
+    std::vector<Intersection*> getIntersectionsWithin(const Vector3 &position, float radius);
+
+    /* Returns true if there's at least one Intersection of this Chunk within radius of position. */
+    bool hasIntersectionWithin(const Vector3 &position, float radius);
+
+    /*
+     * Removes the Intersections and Roads that are outside the Chunk from its child entities, so they aren't rendered.
+     * They are kept on the Chunk's lists, as they're still used by the CityBlocks on the edges and must be deleted
+     * with the Chunk. The Chunk that contains them is the one that renders them.
+     */
+    void hideOutsideChildren();
+
     /*
      * Saves this Chunk to its file. If the file already exists, this will override its contents. This function should
      * only be called when there's an update to the Chunk's data, such as a new building, or a modification to an
-     * existing one. This will automatically locate the chunk's file, using the path that's set on City.
+     * existing one. Returns true if the file was written successfully, and false if it couldn't be, or if a Road or
+     * CityBlock uses an Intersection that isn't one of this Chunk's, which has no index in the file.
      */
-    void saveToFile();
+    bool saveToFile();
 
-    /* Generates and returns the filename for this chunk. */
+    /* Returns the name of the region file where this chunk is saved. */
     std::string getFileName();
 
     /*
      * Returns the position of the centre of this Chunk as a Vector2. This is the same as getPosition(), without the
      * "y" element of the Vector3.
      */
-    Vector2 getCentrePos() { return Vector2(position.x, position.z); }
+    Vector2 getCentrePos() {
+        Vector3 position = getPosition();
+        return Vector2(position.x, position.z);
+    }
 
     /* Returns the chunkPosition, the position at the bottom left corner of the Chunk, as a Vector2. */
     Vector2 getChunkPos() {
@@ -121,29 +160,51 @@ public:
         return this->getCentrePos() - Vector2(offset, offset);
     }
 
+    /*
+     * Returns true if the XZ coordinates of position are inside this Chunk. The bottom left edges are inclusive and
+     * the top right ones are exclusive, so a position on a seam belongs to exactly one Chunk.
+     */
+    bool containsPosition(const Vector3 &position) {
+        Vector2 chunkMin = getChunkPos();
+        return position.x >= chunkMin.x && position.x < chunkMin.x + Chunk::CHUNK_SIZE &&
+            position.z >= chunkMin.y && position.z < chunkMin.y + Chunk::CHUNK_SIZE;
+    }
+
     /* Indicates if OpenGL resources have already been safely released by the render main thread. */
     bool isSafeToDelete() { return safeToDelete; }
 
     /* Sets the bool that indicates if the OpenGL resources were safely released. */
     void setSafeToDelete(bool safeToDelete) { this->safeToDelete = safeToDelete; }
 
-    /* Checks if the Chunk exists as a file. Returns true if ti exists, and false if it needs to be generated. */
+    /*
+     * Checks if the Chunk was saved to its region file. Returns true if it exists, and false if it needs to be
+     * generated. This only looks at the region's offset table in memory, it doesn't touch the disk.
+     */
     static bool chunkExists(const Vector2 &position);
 
     /*
-     * Loads the Chunk at position from the disk. If the Chunk doesn't exist, doesn't load anything and returns null.
-     * If the Chunk is successfully loaded, it's added to the ResourcesManager and it's returned.
+     * Loads the Chunk at position from the disk. If the Chunk doesn't exist, or if its file is invalid, truncated or
+     * was generated with another City seed, doesn't load anything and returns null, so the Chunk can be generated.
      */
     static Chunk *loadChunk(const Vector2 &position, City *city);
 
-    static std::string getFileName(const Vector2 &position) {
-        std::stringstream fileName;
-        fileName << position.x << "-" << position.y << ".cnk";
-        return fileName.str();
-    }
+    /* Returns the name of the region file where the Chunk at position is saved. */
+    static std::string getFileName(const Vector2 &position);
+
+    /*
+     * Returns the arena of the contents of this Chunk. Its Intersections, Roads, CityBlocks and Buildings are allocated
+     * in it, and it's released as a whole when the Chunk is deleted, after unload().
+     */
+    MemoryArena *getArena() { return arena; }
 
+    /* The handle of this Chunk in the Scene, set when it's added by the City. */
+    EntityHandle getSceneHandle() { return sceneHandle; }
+    void setSceneHandle(EntityHandle sceneHandle) { this->sceneHandle = sceneHandle; }
+
+    /* Returns the name of this Chunk in the Scene. It's only kept by debug builds. */
     std::string getEntityName() {
         std::stringstream name;
+        Vector3 position = getPosition();
         name << "CHUNK_" << position.x << "-" << position.z;
         return name.str();
     }
@@ -158,6 +219,9 @@ protected:
     /* The Intersections that are in this chunk. */
     std::vector<Intersection*> *intersections;
 
+    /* Spatial grid with the same Intersections, used to speed up the lookups by position. */
+    IntersectionGrid *intersectionGrid;
+
     /* The Roads that are in this chunk. */
     std::vector<Road*> *roads;
 
@@ -172,4 +236,40 @@ protected:
 
     /* Indicates if OpenGL resources have already been safely released by the render main thread. Defaults to false. */
     bool safeToDelete;
+
+    /* The Roads, Intersections and small houses of this Chunk, each drawn with a single instanced draw call. */
+    InstanceBatch *roadInstances;
+    InstanceBatch *intersectionInstances;
+    InstanceBatch *houseInstances;
+
+    /* The CityBlocks of this Chunk, arranged by their BoundingBoxes for culling. */
+    Quadtree *cityBlockTree;
+
+    /* The box around the ground and all the CityBlocks of this Chunk. */
+    BoundingBox bounds;
+
+    /* Indicates if the contents of this Chunk changed since the instance batches and the Quadtree were last built. */
+    bool contentsChanged;
+
+    /* The handle of this Chunk in the Scene, or INVALID_ENTITY_HANDLE if it was never added. */
+    EntityHandle sceneHandle;
+
+    /*
+     * The memory of the contents of this Chunk. If any of them is still alive when the Chunk is deleted, the arena is
+     * kept and the leak is reported.
+     */
+    MemoryArena *arena;
+
+    /* Creates the empty instance batches and Quadtree. Called by the constructors. */
+    void createInstanceBatches();
+
+    /*
+     * Fills the instance batches with the Roads and Intersections inside this Chunk, and the small houses of its
+     * CityBlocks, and inserts the CityBlocks into the Quadtree. The batches upload their buffers again on their next
+     * draw.
+     */
+    void rebuildContents();
+
+    /* Calculates the world model matrix of entity, which must be a direct child of the Chunk or of a CityBlock. */
+    static Matrix4 calculateInstanceMatrix(Entity *entity);
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "ChunkBenchmark.h"
+
+bool ChunkBenchmark::run(City *city, int numChunks) {
+    if (numChunks <= 0) return true;
+    std::cout << "Benchmarking chunk loading with " << numChunks << " chunks..." << std::endl;
+    ProfilingTimer generateTimer(5, 1);
+    ProfilingTimer saveTimer(6, 1);
+    ProfilingTimer loadTimer(7, 1);
+    int numMismatches = 0;
+    long long totalFileSize = 0;
+    long long totalArenaBytes = 0;
+    long long totalArenaObjects = 0;
+    long long totalEntityBytes = 0;
+    long long totalPhysicalBodies = 0;
+    int physicalBodiesBefore = Entity::getPhysicalBodyPool().size();
+    int liveObjectsBefore = MemoryArena::getTotalLiveObjects();
+    CityBlock::resetBatchStatistics();
+    for (int i = 0; i < numChunks; i++) {
+        // Use a row of chunks far away from where the game starts, so no real chunk file is touched
+        Vector2 position = Vector2((float) (1000000 + i * Chunk::CHUNK_SIZE), 1000000.0f);
+        generateTimer.startMeasurement();
+        Chunk *generated = ChunkGenerator::generateChunk(city, position);
+        generateTimer.finishMeasurement();
+        if (generated == nullptr) continue;
+
+        saveTimer.startMeasurement();
+        bool saved = generated->saveToFile();
+        saveTimer.finishMeasurement();
+        if (!saved) {
+            std::cout << "Could not save chunk " << position << " to " << generated->getFileName() << std::endl;
+            deleteChunk(generated);
+            numMismatches++;
+            continue;
+        }
+
+        loadTimer.startMeasurement();
+        Chunk *loaded = Chunk::loadChunk(position, city);
+        loadTimer.finishMeasurement();
+        if (loaded == nullptr || !compareChunks(generated, loaded)) {
+            std::cout << "Chunk " << position << " was not loaded correctly" << std::endl;
+            numMismatches++;
+        }
+        totalFileSize += RegionManager::getChunkSize(position);
+        const ArenaStats &arenaStats = generated->getArena()->getStats();
+        totalArenaBytes += arenaStats.bytesReserved;
+        totalArenaObjects += arenaStats.peakLiveObjects;
+        totalEntityBytes += arenaStats.peakBytesLive;
+        // Both the generated and the loaded chunks are alive here
+        totalPhysicalBodies += Entity::getPhysicalBodyPool().size() - physicalBodiesBefore;
+        RegionManager::removeChunk(position);
+        deleteChunk(generated);
+        if (loaded != nullptr) deleteChunk(loaded);
+    }
+    // The benchmark chunks were all removed, so this just deletes their region file
+    RegionManager::compactAll();
+    std::cout << "Chunk benchmark, average per chunk:" << std::endl;
+    std::cout << "    generate: " << generateTimer.getMeasuredTime() / numChunks << "ms" << std::endl;
+    std::cout << "    save:     " << saveTimer.getMeasuredTime() / numChunks << "ms" << std::endl;
+    std::cout << "    load:     " << loadTimer.getMeasuredTime() / numChunks << "ms" << std::endl;
+    std::cout << "    size:     " << totalFileSize / numChunks << " bytes" << std::endl;
+    // Both the generated and the loaded chunks build their batches, so these are averaged over twice the chunks
+    std::cout << "    batches:  " << CityBlock::getBatchVerticesBefore() / (2 * numChunks) << " -> " <<
+        CityBlock::getBatchVerticesAfter() / (2 * numChunks) << " vertexes, " <<
+        CityBlock::getBatchBytesBefore() / (2 * 1024 * numChunks) << " -> " <<
+        CityBlock::getBatchBytesAfter() / (2 * 1024 * numChunks) << " KB" << std::endl;
+    std::cout << "    arena:    " << totalArenaBytes / (1024 * numChunks) << " KB, " <<
+        totalArenaObjects / numChunks << " objects" << std::endl;
+    // Every object in the arenas is an Entity, so this is the memory of an Entity, without its lists and components
+    if (totalArenaObjects > 0) {
+        std::cout << "    entity:   " << totalEntityBytes / totalArenaObjects << " bytes, " <<
+            totalPhysicalBodies / (2 * numChunks) << " physical bodies (" <<
+            sizeof(PhysicalBody) << " bytes each)" << std::endl;
+    }
+    // Every Chunk was deleted, so any object still alive in an arena was leaked
+    int leakedObjects = MemoryArena::getTotalLiveObjects() - liveObjectsBefore;
+    if (leakedObjects > 0) {
+        std::cout << "    " << leakedObjects << " objects leaked by the chunks!" << std::endl;
+    }
+    if (numMismatches > 0) {
+        std::cout << "    " << numMismatches << " chunks did not match after loading!" << std::endl;
+    }
+    return numMismatches == 0;
+}
+
+bool ChunkBenchmark::compareChunks(Chunk *generated, Chunk *loaded) {
+    return generated->getIntersections()->size() == loaded->getIntersections()->size() &&
+        generated->getRoads()->size() == loaded->getRoads()->size() &&
+        generated->getCityBlocks()->size() == loaded->getCityBlocks()->size() &&
+        countBuildings(generated) == countBuildings(loaded);
+}
+
+int ChunkBenchmark::countBuildings(Chunk *chunk) {
+    int numBuildings = 0;
+    auto itEnd = chunk->getCityBlocks()->end();
+    for (auto it = chunk->getCityBlocks()->begin(); it != itEnd; it++) {
+        numBuildings += (int) (*it)->getBuildings()->size();
+    }
+    return numBuildings;
+}
+
+void ChunkBenchmark::deleteChunk(Chunk *chunk) {
+    chunk->unload();
+    delete chunk;
+}
@@ -0,0 +1,41 @@
+/*
+ * Description: Measures how long it takes to load a Chunk from its file, compared to generating it from scratch. For
+ * each Chunk, it generates, saves and loads it back, checking that the loaded Chunk has the same contents as the
+ * generated one. The average times, arena memory per Chunk and memory per Entity are printed on the console at the end,
+ * along with any object the Chunks leaked.
+ *
+ * The benchmark runs on the calling thread, before the game starts, if the "chunkBenchmark" configuration is set to the
+ * number of Chunks to measure. The Chunks are taken far away from the origin, and are removed from their region file at
+ * the end.
+ * This is an instance-less class.
+ */
+
+#pragma once
+
+#include <iostream>
+#include "City.h"
+#include "Chunk.h"
+#include "ChunkGenerator.h"
+#include "RegionManager.h"
+#include "../engine/ProfilingTimer.h"
+
+class ChunkBenchmark {
+public:
+
+    /* Runs the benchmark on numChunks Chunks of city. Returns false if any loaded Chunk didn't match. */
+    static bool run(City *city, int numChunks);
+
+protected:
+
+    /* Returns true if both Chunks have the same number of Intersections, Roads, CityBlocks and Buildings. */
+    static bool compareChunks(Chunk *generated, Chunk *loaded);
+
+    /* Returns the total number of Buildings in a Chunk. */
+    static int countBuildings(Chunk *chunk);
+
+    /* Unloads and deletes a Chunk that was never added to the City. */
+    static void deleteChunk(Chunk *chunk);
+
+    ChunkBenchmark(void) {}
+    ~ChunkBenchmark(void) {}
+};
@@ -6,77 +6,72 @@ Chunk *ChunkGenerator::generateChunk(City *city, const Vector2 &position) {
     if ((int) position.x % 1000 != 0 || (int) position.y % 1000 != 0) {
         return nullptr;
     }
-    // And also if this chunk doesn't already exists
-    if (FileIO::fileExists(Chunk::getFileName(position))) {
-        return nullptr;
-    }
-
-    Profiler::getTimer(3)->startMeasurement();
+    // Each worker of ChunkLoader may be generating a Chunk at the same time, so use a timer local to this generation
+    ProfilingTimer generationTimer(3, 1);
+    generationTimer.startMeasurement();
 
     /*
      * Generate Intersections and Roads
      */
 
     //TODO: Put this condition on the different grid layout generators. Each may have different limits
-    int minDistanceIntersections = 50; // Minimum distance between intersections
+    // Minimum distance between intersections. The Chunk's Intersection grid uses the same value as its cell size
+    int minDistanceIntersections = Chunk::INTERSECTION_GRID_CELL_SIZE;
     Chunk *chunk = new Chunk(position, city);
-    std::vector<Chunk*> neighbourChunks = city->getNeighbourChunks(chunk, true);
     ManhattanGridLayout gridLayout = ManhattanGridLayout(Vector2(), Vector2());
-    int numSubChunks = Chunk::CHUNK_SIZE / Chunk::SUBCHUNK_SIZE;
-    float subChunkSize = (float) Chunk::SUBCHUNK_SIZE;
-    for (int i = 0; i < numSubChunks; i++) {
-        for (int j = 0; j < numSubChunks; j++) {
-            // Calculate the position of the new intersection on this subchunk
-            gridLayout.posMin = Vector2(i * subChunkSize, j * subChunkSize);
-            gridLayout.posMax = Vector2((i + 1) * subChunkSize, (j + 1) * subChunkSize);
-            Vector2 intersectionPos = gridLayout.getIntersectionPosition();
-            float den = Perlin::getCityBlockDensity(intersectionPos.x + position.x, intersectionPos.y + position.y);
-            if (intersectionPos.x > -99 && intersectionPos.y > -99 && den > 0.0f) {
-                // If there's an intersection in this subchunk, check if it has enough distance from the others
-                intersectionPos += position; // Convert to World Position
-                auto it = chunk->getIntersections()->begin();
-                auto itEnd = chunk->getIntersections()->end();
-                bool tooClose = false;
-                Vector3 newIntPos = Vector3(intersectionPos.x, 0, intersectionPos.y);
-                for (; it != itEnd; it++) {
-                    Intersection *intersection = (*it);
-                    // Chunk position for the new intersection position (0 to 1000)
-                    float length = (intersection->getPosition() - newIntPos).getLength();
-                    //std::cout << length << std::endl;
-                    if (length < minDistanceIntersections) {
-                        tooClose = true;
-                        break;
-                    }
-                }
-                if (!tooClose) {
-                    // If the new intersections is sufficiently distant from all the others, proceed
-                    Intersection *newInter = nullptr;
-                    Intersection *neighbourSubstitute = nullptr;
-                    // Check if the new Intersection is too close to any Intersection on the neighbours
-                    for (auto it = neighbourChunks.begin(); it != neighbourChunks.end(); it++) {
-                        Intersection *closest = (*it)->getClosestIntersectionTo(newIntPos);
-                        if (closest != nullptr) {
-                            float distance = (closest->getPosition() - newIntPos).getLength();
-                            if (distance < minDistanceIntersections) {
-                                // The new Intersection is too close to an Intersection on an neighbour. Use the
-                                // neighbour's Intersection instead
-                                neighbourSubstitute = closest;
-                                break;
-                            }
-                        }
-                    }
-                    if (neighbourSubstitute != nullptr) {
-                        newInter = neighbourSubstitute;
-                    } else {
-                        newInter = new Intersection(newIntPos);
+    int subChunkSize = Chunk::SUBCHUNK_SIZE;
+    // Subchunks that will get Intersections: the Chunk itself plus the generation margin around it
+    int marginSubChunks = ChunkGenerator::GENERATION_MARGIN / subChunkSize;
+    int numSubChunks = Chunk::CHUNK_SIZE / subChunkSize + marginSubChunks * 2;
+    // Candidates can be moved up to 4 half subchunks away from their subchunk, so to decide if a candidate is kept we
+    // need to look at all subchunks that may have a candidate within the minimum distance
+    int searchSubChunks = (minDistanceIntersections + subChunkSize * 4) / subChunkSize + 1;
+    int numCandidates = numSubChunks + searchSubChunks * 2;
+    int firstSubChunkX = (int) position.x / subChunkSize - marginSubChunks - searchSubChunks;
+    int firstSubChunkZ = (int) position.y / subChunkSize - marginSubChunks - searchSubChunks;
+
+    // Calculate the candidates of all subchunks, including the ones only used to thin out the others
+    std::vector<IntersectionCandidate> candidates = std::vector<IntersectionCandidate>();
+    candidates.resize(numCandidates * numCandidates);
+    for (int i = 0; i < numCandidates; i++) {
+        for (int j = 0; j < numCandidates; j++) {
+            Vector2 subChunkMin = Vector2((float) ((firstSubChunkX + i) * subChunkSize),
+                (float) ((firstSubChunkZ + j) * subChunkSize));
+            candidates[i * numCandidates + j] = getCandidate(city, gridLayout, subChunkMin);
+        }
+    }
+
+    // Keep only the candidates that have precedence over every other candidate too close to them
+    float minDistanceSquared = (float) (minDistanceIntersections * minDistanceIntersections);
+    for (int i = searchSubChunks; i < numSubChunks + searchSubChunks; i++) {
+        for (int j = searchSubChunks; j < numSubChunks + searchSubChunks; j++) {
+            IntersectionCandidate &candidate = candidates[i * numCandidates + j];
+            if (!candidate.exists) continue;
+            bool kept = true;
+            for (int k = i - searchSubChunks; k <= i + searchSubChunks && kept; k++) {
+                for (int l = j - searchSubChunks; l <= j + searchSubChunks && kept; l++) {
+                    IntersectionCandidate &other = candidates[k * numCandidates + l];
+                    if (!other.exists || (k == i && l == j)) continue;
+                    Vector2 dir = other.position - candidate.position;
+                    if (dir.x * dir.x + dir.y * dir.y < minDistanceSquared && hasPrecedence(other, candidate)) {
+                        kept = false;
                     }
-                    chunk->addIntersection(newInter);
-                    gridLayout.generateRoads(chunk, newInter);
                 }
             }
+            if (kept) {
+                chunk->addIntersection(
+                    new (chunk->getArena()) Intersection(Vector3(candidate.position.x, 0, candidate.position.y)));
+            }
         }
     }
 
+    // Only connect the Intersections after all of them exist, so the Roads don't depend on the generation order
+    std::vector<Intersection*> intersections = *(chunk->getIntersections());
+    auto itInterEnd = intersections.end();
+    for (auto it = intersections.begin(); it != itInterEnd; it++) {
+        gridLayout.generateRoads(chunk, (*it));
+    }
+
     //Profiler::getTimer(3)->finishMeasurement();
     //Profiler::getTimer(3)->resetCycle();
     //std::cout << chunk->getChunkPos() << " generated in " << Profiler::getTimer(3)->getAverageTime() << "ms" << std::endl;
@@ -118,16 +113,22 @@ Chunk *ChunkGenerator::generateChunk(City *city, const Vector2 &position) {
                 }
             }
             if (!duplicate) {
-                cityBlock->generateBuildings();
+                Vector3 blockCentre = cityBlock->getCentralPosition();
+                RandomStream blockRandom = RandomStream::forPosition(city->getSeed(), blockCentre.x, blockCentre.z);
+                cityBlock->generateBuildings(blockRandom);
             } else {
                 chunk->removeCityBlock(cityBlock);
                 delete cityBlock;
             }
         }
     }
-    Profiler::getTimer(3)->finishMeasurement();
-    Profiler::getTimer(3)->resetCycle();
-    std::cout << chunk->getChunkPos() << " generated in " << Profiler::getTimer(3)->getAverageTime() << "ms" << std::endl;
+
+    // The Intersections and Roads on the margin are drawn by the Chunks that contain them
+    chunk->hideOutsideChildren();
+    generationTimer.finishMeasurement();
+    std::stringstream generationLog;
+    generationLog << chunk->getChunkPos() << " generated in " << generationTimer.getMeasuredTime() << "ms" << std::endl;
+    std::cout << generationLog.str();
     //std::cout << ResourcesManager::getResourcesCount() << std::endl;
 
     return chunk;
@@ -135,14 +136,15 @@ Chunk *ChunkGenerator::generateChunk(City *city, const Vector2 &position) {
     /* Chunk Generator Algorithm: */
 
     /*
-     * 1 - We try to load the adjacent chunks to detect invalid intersections near the borders.
+     * 1 - Calculate the Intersection candidates of the chunk and its margin, using only the city seed, and keep the
+     * ones that have precedence over their close neighbours, so adjacent chunks agree on their borders.
      * 
      * 2 - Iterate over the 10x10 grid of partial chunks, calculate the grid layout for each one and call the generator
      * algorithm of the correct grid layout to generate intersections and roads for each one of the partial chunks.
      * NOTE: Consider Voronoi Diagram for the GridLayout selector
      * 
-     * 3 - Connect this chunk's intersections with the adjacent chunk's intersections, if the corresponding adjacent
-     * chunk exists.
+     * 3 - Connect the intersections of the chunk and its margin. The margin is generated exactly as the adjacent
+     * chunks generate it, so the roads crossing the borders match.
      * 
      * 4 - Generate empty city blocks and add everything generated so far to the scene, so it can render something
      * while we generate the buildings
@@ -154,11 +156,32 @@ Chunk *ChunkGenerator::generateChunk(City *city, const Vector2 &position) {
      * 7 - Add the new buildings to the scene so it can render everything
      * 
      * 8 - Save this chunk to its file
-     * 
-     * 9 - Update the adjacent chunks with the new edge city blocks, intersections and roads
      */
 }
 
 int ChunkGenerator::getGridLayout(const Vector2 &position) {
     return 1; // 1 will be the future ManhattanGridLayout
-}
\ No newline at end of file
+}
+
+ChunkGenerator::IntersectionCandidate ChunkGenerator::getCandidate(City *city, GridLayout &gridLayout,
+                                                                   const Vector2 &subChunkMin) {
+    IntersectionCandidate candidate;
+    candidate.exists = false;
+    candidate.priority = 0;
+    gridLayout.posMin = subChunkMin;
+    gridLayout.posMax = subChunkMin + (float) Chunk::SUBCHUNK_SIZE;
+    RandomStream random = RandomStream::forPosition(city->getSeed(), subChunkMin.x, subChunkMin.y).derive(1);
+    if (gridLayout.getIntersectionPosition(random, candidate.position)) {
+        if (Perlin::getCityBlockDensity(candidate.position.x, candidate.position.y) > 0.0f) {
+            candidate.exists = true;
+            candidate.priority = random.nextLong();
+        }
+    }
+    return candidate;
+}
+
+bool ChunkGenerator::hasPrecedence(const IntersectionCandidate &b, const IntersectionCandidate &a) {
+    if (b.priority != a.priority) return b.priority < a.priority;
+    if (b.position.x != a.position.x) return b.position.x < a.position.x;
+    return b.position.y < a.position.y;
+}
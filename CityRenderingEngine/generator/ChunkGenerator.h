@@ -9,6 +9,13 @@
  * To generate a Chunk, the algorithm will first choose the grid type to be applied to specific chunk areas. This will
  * be selected randomly using the City Seed. After this, a GridGenerator will generate Intersections and Roads, and the
  * resulting spaces will be filled with CityBlocks.
+ *
+ * A Chunk is generated only from its coordinates and the City seed, never from the Chunks that are already loaded.
+ * Each subchunk may have an Intersection candidate, whose position and priority come only from a random stream keyed
+ * by the subchunk's world position. A candidate is kept if no other candidate within the minimum distance has a lower
+ * priority, a rule that only looks at the neighbourhood of the candidate. Because of that, two Chunks will always agree
+ * on every Intersection they both see, so the generator also builds the Intersections and Roads on a margin around the
+ * Chunk. This margin is only used to close the CityBlocks on the edges, and is not rendered by this Chunk.
  */
 
 #pragma once
@@ -18,18 +25,27 @@
 #include "../engine/input/FileIO.h"
 #include "../engine/math/Vector2.h"
 #include "math/Perlin.h"
+#include "math/RandomStream.h"
 
 class City;
 class Chunk;
+class GridLayout;
 
 class ChunkGenerator {
 public:
 
+    /*
+     * Size, in meters, of the margin around the Chunk where Intersections and Roads are also generated. It must be
+     * large enough to contain every Intersection of a CityBlock whose centre is inside the Chunk.
+     */
+    static const int GENERATION_MARGIN = 300;
+
     ~ChunkGenerator(void) {}
 
     /*
-     * Generates a new Chunk on the specified position. A new Chunk will only be generated if the position is valid and
-     * there's no Chunk already in that position. If the Chunk cannot be generated, the function will return null.
+     * Generates a new Chunk on the specified position. A new Chunk will only be generated if the position is valid. If
+     * the Chunk cannot be generated, the function will return null. The Chunk is not saved to its file, the caller
+     * should do it if needed.
      */
     static Chunk *generateChunk(City *city, const Vector2 &position);
 
@@ -39,5 +55,24 @@ public:
 
 protected:
 
+    /* A possible Intersection of a subchunk, before the ones that are too close to each other are discarded. */
+    struct IntersectionCandidate {
+        bool exists;
+        Vector2 position;
+        unsigned long long priority;
+    };
+
+    /*
+     * Calculates the Intersection candidate of the subchunk whose bottom left corner is at subChunkMin. The result
+     * depends only on the City seed and the subchunk position, so it's the same for every Chunk that calculates it.
+     */
+    static IntersectionCandidate getCandidate(City *city, GridLayout &gridLayout, const Vector2 &subChunkMin);
+
+    /*
+     * Returns true if candidate b wins over candidate a, that is, if b has a lower priority. Ties are broken by the
+     * position, so the order is total and doesn't depend on which candidate is tested first.
+     */
+    static bool hasPrecedence(const IntersectionCandidate &b, const IntersectionCandidate &a);
+
     ChunkGenerator(void) {}
 };
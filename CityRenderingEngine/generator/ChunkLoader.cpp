@@ -2,86 +2,94 @@
 
 ChunkLoader *ChunkLoader::instance = nullptr;
 
-/* This function is the loop in which the ChunkLoader will perform the loading and unloading operations. */
+/*
+ * This function is the loop in which each worker of the ChunkLoader will perform the loading and unloading operations.
+ * All workers run this same loop, claiming operations from the shared queue.
+ */
 int chunkLoaderLoop(void *data) {
     ChunkLoader *loader = (ChunkLoader*) data;
     while (loader->isExecuting()) {
-        if (loader->getQueue()->size() > 0) {
-            loader->lockMutex();
-            ChunkOperation operation = loader->getQueue()->front();
-            loader->unlockMutex();
-            if (operation.load) {
-                // Load the Chunk
-                Chunk *chunk = nullptr;
-                // We first check if while on the queue, the Chunk wasn't loaded already
-                City *city = operation.city;
-                city->lockMutex();
-                bool duplicate = false;
-                auto itEnd = city->getChunks()->end();
-                for (auto it = city->getChunks()->begin(); it != itEnd; it++) {
-                    if (operation.chunkPos == (*it)->getChunkPos()) {
-                        duplicate = true;
-                    }
+        ChunkOperation operation;
+        if (!loader->claimOperation(operation)) {
+            // Nothing that can be processed right now, so don't hog the CPU
+            SDL_Delay(1);
+            continue;
+        }
+        if (operation.load) {
+            // Load the Chunk
+            Chunk *chunk = nullptr;
+            // We first check if while on the queue, the Chunk wasn't loaded already
+            City *city = operation.city;
+            if (!city->isChunkLoaded(operation.chunkPos)) {
+                if (Chunk::chunkExists(operation.chunkPos)) {
+                    // Load it from the disk
+                    chunk = Chunk::loadChunk(operation.chunkPos, operation.city);
                 }
-                city->unlockMutex();
-                if (!duplicate) {
-                    if (Chunk::chunkExists(operation.chunkPos)) {
-                        // Load it from the disk
-                        chunk = Chunk::loadChunk(operation.chunkPos, operation.city);
-                    } else {
-                        // Generate it
-                        chunk = ChunkGenerator::generateChunk(operation.city, operation.chunkPos);
-                    }
-                    // Add it to the Scene
-                    if (chunk != nullptr) {
-                        operation.city->addChunk(chunk);
+                if (chunk == nullptr) {
+                    // Generate it, if it doesn't exist yet or its file couldn't be loaded, and save it for next time
+                    chunk = ChunkGenerator::generateChunk(operation.city, operation.chunkPos);
+                    if (chunk != nullptr && !chunk->saveToFile()) {
+                        std::cout << "Could not save chunk " << chunk->getChunkPos() << " to " << chunk->getFileName()
+                            << std::endl;
                     }
                 }
-                loader->lockMutex();
-                loader->getQueue()->pop_front();
-                loader->unlockMutex();
-            } else {
-                // Unload the Chunk
-                Chunk *chunk = operation.city->getChunkAt(operation.chunkPos, false);
-                if (chunk != nullptr) {
-                    /* The unload works in three steps: The Chunk is first removed from the entity list of CityScene,
-                     * then when CityScene finishes using it, the render thread will be notified of the Chunk's unload
-                     * and will unload and delete all OpenGL resources on the end of its next render() call. Finally,
-                     * when the Chunk is void of all OpenGL references and is not being used by anything anymore, it's
-                     * safe to actually unload and delete it.
-                     */
-                    if (Naquadah::getInstance()->getCurrentScene()->isEntityInScene(chunk->getEntityName())) {
-                        Naquadah::getInstance()->getCurrentScene()->removeEntity(chunk->getEntityName());
-                    } else if (chunk->isSafeToDelete()) {
-                        // This gives the update() method of the Chunk time to finish, and makes sure it won't be called again.
-                        // Only remove the Chunk from the queue once it's fully unloaded
-                        loader->lockMutex();
-                        loader->getQueue()->pop_front();
-                        loader->unlockMutex();
-                        operation.city->removeChunk(chunk);
-                        chunk->unload();
-                        delete chunk;
-                        chunk = nullptr;
-                    }
+                // Add it to the City and the Scene. This only fails if the same Chunk was published meanwhile
+                if (chunk != nullptr && !operation.city->addChunk(chunk)) {
+                    chunk->unload();
+                    delete chunk;
+                    chunk = nullptr;
+                }
+            }
+            loader->finishOperation(operation);
+        } else {
+            // Unload the Chunk
+            Chunk *chunk = operation.city->getChunkAt(operation.chunkPos, false);
+            if (chunk != nullptr) {
+                /* The unload works in three steps: The Chunk is first removed from the entity list of CityScene,
+                 * then when CityScene finishes using it, the render thread will be notified of the Chunk's unload
+                 * and will unload and delete all OpenGL resources on the end of its next render() call. Finally,
+                 * when the Chunk is void of all OpenGL references and is not being used by anything anymore, it's
+                 * safe to actually unload and delete it.
+                 */
+                if (Naquadah::getInstance()->getCurrentScene()->isEntityInScene(chunk->getSceneHandle())) {
+                    Naquadah::getInstance()->getCurrentScene()->removeEntity(chunk->getSceneHandle());
+                    loader->releaseOperation(operation);
+                } else if (chunk->isSafeToDelete()) {
+                    // This gives the update() method of the Chunk time to finish, and makes sure it won't be called again.
+                    // Only remove the Chunk from the queue once it's fully unloaded
+                    operation.city->removeChunk(chunk);
+                    chunk->unload();
+                    delete chunk;
+                    chunk = nullptr;
+                    loader->finishOperation(operation);
                 } else {
-                    // If Chunk is null, it probably was deleted already, so just remove it from the queue.
-                    loader->lockMutex();
-                    loader->getQueue()->pop_front();
-                    loader->unlockMutex();
+                    // Still waiting for the render thread, give the operation back for now
+                    loader->releaseOperation(operation);
                 }
+            } else {
+                // If Chunk is null, it probably was deleted already, so just remove it from the queue.
+                loader->finishOperation(operation);
             }
         }
     }
-    // Clean up and finish
-    delete loader;
     return 0;
 }
 
 ChunkLoader::ChunkLoader(void) {
     executing = true;
     queue = new std::deque<ChunkOperation>();
-    thread = SDL_CreateThread(&chunkLoaderLoop, "", (void*) this);
     mutex = SDL_CreateMutex();
+    // Leave one core for the main thread, but always have at least one worker
+    int numCores = SDL_GetCPUCount();
+    int defaultWorkers = clamp(numCores - 1, 1, City::MAX_PARALEL_LOADING_CHUNKS);
+    int numWorkers = ConfigurationManager::getInstance()->readInt("chunkLoaderWorkers", defaultWorkers);
+    numWorkers = clamp(numWorkers, 1, City::MAX_PARALEL_LOADING_CHUNKS);
+    threads = new std::vector<SDL_Thread*>();
+    for (int i = 0; i < numWorkers; i++) {
+        std::stringstream threadName;
+        threadName << "ChunkLoader" << i;
+        threads->push_back(SDL_CreateThread(&chunkLoaderLoop, threadName.str().c_str(), (void*) this));
+    }
 }
 
 void ChunkLoader::loadChunk(const Vector2 &chunkPos, City *city) {
@@ -95,18 +103,20 @@ void ChunkLoader::loadChunk(const Vector2 &chunkPos, City *city) {
 void ChunkLoader::unloadChunk(Chunk *chunk, City *city) {
     Vector2 chunkPos = chunk->getChunkPos();
     lockMutex();
-    if (!isChunkInQueue(chunkPos)) {
-        queue->push_back(ChunkOperation(chunkPos, city, false));
-    } else {
-        auto itEnd = queue->end();
-        for (auto it = queue->begin(); it != itEnd; it++) {
-            if ((*it).chunkPos == chunkPos && (*it).load) {
-                // Remove the loading operation by turning it into an unloading one. Unloading what's not loaded will
-                // not do anything.
-                (*it).load = false;
-            }
+    bool waiting = false;
+    auto itEnd = queue->end();
+    for (auto it = queue->begin(); it != itEnd; it++) {
+        if ((*it).chunkPos == chunkPos && !(*it).inProgress) {
+            // Remove the loading operation by turning it into an unloading one. Unloading what's not loaded will
+            // not do anything.
+            (*it).load = false;
+            waiting = true;
         }
     }
+    // If the Chunk is not in the queue, or if it's currently being loaded by a worker, queue the unloading after it
+    if (!waiting) {
+        queue->push_back(ChunkOperation(chunkPos, city, false));
+    }
     unlockMutex();
 }
 
@@ -122,6 +132,69 @@ bool ChunkLoader::isChunkInQueue(Vector2 chunkPos) {
     return isInTheQueue;
 }
 
+ChunkOperation ChunkLoader::getFirstUnloadInTheQueue() {
+    lockMutex();
+    ChunkOperation operation = ChunkOperation();
+    auto itEnd = queue->cend();
+    for (auto it = queue->cbegin(); it != itEnd; it++) {
+        if (!(*it).load) {
+            operation = (*it);
+            break;
+        }
+    }
+    unlockMutex();
+    return operation;
+}
+
+bool ChunkLoader::claimOperation(ChunkOperation &operation) {
+    lockMutex();
+    auto itEnd = queue->end();
+    for (auto it = queue->begin(); it != itEnd; it++) {
+        if ((*it).inProgress) continue;
+        bool blocked = false;
+        for (auto other = queue->begin(); other != itEnd; other++) {
+            if (other == it) continue;
+            if (other < it && (*other).chunkPos == (*it).chunkPos) {
+                // An older operation for this same Chunk must be processed first
+                blocked = true;
+                break;
+            }
+        }
+        if (!blocked) {
+            (*it).inProgress = true;
+            operation = (*it);
+            unlockMutex();
+            return true;
+        }
+    }
+    unlockMutex();
+    return false;
+}
+
+void ChunkLoader::finishOperation(const ChunkOperation &operation) {
+    lockMutex();
+    auto itEnd = queue->end();
+    for (auto it = queue->begin(); it != itEnd; it++) {
+        if ((*it).inProgress && (*it).chunkPos == operation.chunkPos) {
+            queue->erase(it);
+            break;
+        }
+    }
+    unlockMutex();
+}
+
+void ChunkLoader::releaseOperation(const ChunkOperation &operation) {
+    lockMutex();
+    auto itEnd = queue->end();
+    for (auto it = queue->begin(); it != itEnd; it++) {
+        if ((*it).inProgress && (*it).chunkPos == operation.chunkPos) {
+            (*it).inProgress = false;
+            break;
+        }
+    }
+    unlockMutex();
+}
+
 void ChunkLoader::lockMutex() {
     SDL_mutexP(mutex);
 }
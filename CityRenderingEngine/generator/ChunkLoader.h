@@ -2,17 +2,23 @@
  * Author: Rodrigo Castro Azevedo
  * Date: 02/07/2014
  *
- * Description: This is a Singleton class designed specifically to load and unload Chunks. It operates on a separate
- * worker thread, allowing the main solution to run smoothly. It implements a Queue, that will queue the Chunks that
- * shoule be loaded or unloaded. The main thread function will run a loop, checking if there's any Chunks in the queue.
- * It there is, it will load/unload the Chunk and move on to the next in the queue.
+ * Description: This is a Singleton class designed specifically to load and unload Chunks. It operates on a pool of
+ * worker threads, allowing the main solution to run smoothly. It implements a Queue, that will queue the Chunks that
+ * shoule be loaded or unloaded. Each worker thread will run a loop, checking if there's any Chunks in the queue that
+ * can be processed. It there is, it will claim that operation, load/unload the Chunk and move on to the next one.
+ *
+ * Chunks are generated only from their own coordinates and share nothing with their neighbours, so any number of
+ * Chunks can be processed at the same time. A worker will only skip an operation if there is an older operation for
+ * the same Chunk still in the queue (waiting or being processed), so operations on a Chunk keep their order.
  */
 
 #pragma once
 
 #include <SDL.h>
 #include <deque>
+#include <vector>
 #include "City.h"
+#include "../engine/input/ConfigurationManager.h"
 #include "../engine/math/Vector2.h"
 
 /* A struct to indicate the queue what operation to perform on a given Chunk. */
@@ -27,9 +33,13 @@ struct ChunkOperation {
     /* The operation. True will load a Chunk, false will unload it. */
     bool load;
 
+    /* Indicates if a worker thread is currently processing this operation. */
+    bool inProgress;
+
     /* Simple helper constructors. */
-    ChunkOperation(void) : chunkPos(0, 0), city(nullptr), load(true) {}
-    ChunkOperation(Vector2 chunkPos, City *city, bool load) : chunkPos(chunkPos), city(city), load(load) {}
+    ChunkOperation(void) : chunkPos(0, 0), city(nullptr), load(true), inProgress(false) {}
+    ChunkOperation(Vector2 chunkPos, City *city, bool load)
+        : chunkPos(chunkPos), city(city), load(load), inProgress(false) {}
 
 };
 
@@ -37,6 +47,10 @@ class ChunkLoader {
 public:
 
     ~ChunkLoader(void) {
+        if (threads != nullptr) {
+            delete threads;
+            threads = nullptr;
+        }
         if (queue != nullptr) {
             queue->clear();
             delete queue;
@@ -56,31 +70,62 @@ public:
         return instance;
     }
 
-    /* Deletes the instance of the ChunkLoader. This should be called when the game exits. */
+    /* Stops all worker threads and deletes the instance of the ChunkLoader. This should be called when the game exits. */
     static void terminate() {
         if (instance != nullptr) {
             instance->executing = false;
             int result;
-            SDL_WaitThread(instance->getThread(), &result);
+            for (auto it = instance->threads->begin(); it != instance->threads->end(); it++) {
+                SDL_WaitThread(*it, &result);
+            }
+            delete instance;
+            instance = nullptr;
         }
     }
 
     /* Returns true if this ChunkLoader is still executing, or false otherwise. */
     bool isExecuting() { return executing; }
 
-    /* Returns the SDL_Thread that is executing this ChunkLoader. */
-    SDL_Thread *getThread() { return thread; }
+    /* Returns the worker threads that are executing this ChunkLoader. */
+    std::vector<SDL_Thread*> *getThreads() { return threads; }
+
+    /* Returns the number of worker threads. */
+    int getNumWorkers() { return (int) threads->size(); }
 
     std::deque<ChunkOperation> *getQueue() { return queue; }
 
     /* Returns the first operation on the queue, without removing it from the queue. */
     ChunkOperation getFirstInTheQueue() {
+        lockMutex();
+        ChunkOperation operation = ChunkOperation();
         if (queue->size() > 0) {
-            return queue->front();
+            operation = queue->front();
         }
-        return ChunkOperation();
+        unlockMutex();
+        return operation;
     }
 
+    /*
+     * Returns the first unloading operation on the queue, without removing it from the queue. If there's none, the
+     * returned operation will have a null city.
+     */
+    ChunkOperation getFirstUnloadInTheQueue();
+
+    /*
+     * Looks for the oldest operation in the queue that can be processed right now, marks it as in progress and copies
+     * it to operation. Returns false if there's no operation that can be processed at the moment.
+     */
+    bool claimOperation(ChunkOperation &operation);
+
+    /* Removes an operation previously claimed with claimOperation from the queue, as it has been completed. */
+    void finishOperation(const ChunkOperation &operation);
+
+    /*
+     * Gives back an operation previously claimed with claimOperation, without removing it from the queue, so it can be
+     * claimed again later. This is used when the operation has to wait for something else before it's finished.
+     */
+    void releaseOperation(const ChunkOperation &operation);
+
     /*
      * Adds chunkPos to the queue. The Chunk corresponding to chunkPos will be loaded when possible. If chunkPos is
      * already on the queue, it will not be added a second time.
@@ -114,8 +159,11 @@ protected:
     /* A bool indicating that the ChunkLoader is not yet terminated. Defaults to true. */
     bool executing;
 
-    /* The worker thread that executes this ChunkLoader. */
-    SDL_Thread *thread;
+    /*
+     * The worker threads that execute this ChunkLoader. The number of workers is read from the configuration
+     * "chunkLoaderWorkers", and defaults to the number of CPU cores minus one, up to City::MAX_PARALEL_LOADING_CHUNKS.
+     */
+    std::vector<SDL_Thread*> *threads;
 
     /* Mutex to prevent racing conditions. */
     SDL_mutex *mutex;
@@ -2,6 +2,13 @@
 #include "ChunkLoader.h"
 
 City::City(void) {
+    seed = 0;
+    chunks = new std::vector<Chunk*>();
+    mutex = SDL_CreateMutex();
+}
+
+City::City(unsigned long long seed) {
+    this->seed = seed;
     chunks = new std::vector<Chunk*>();
     mutex = SDL_CreateMutex();
 }
@@ -18,11 +25,21 @@ City::~City(void) {
     }
 }
 
-void City::addChunk(Chunk *chunk) {
+bool City::addChunk(Chunk *chunk) {
+    // The Scene is locked first, the same order used by CityScene::update(), to avoid deadlocks between workers
+    Scene *scene = Naquadah::getInstance()->getCurrentScene();
+    scene->lockUpdateMutex();
     lockMutex();
+    if (isChunkLoaded(chunk->getChunkPos())) {
+        unlockMutex();
+        scene->unlockUpdateMutex();
+        return false;
+    }
     chunks->push_back(chunk);
-    Naquadah::getInstance()->getCurrentScene()->addEntity(chunk, chunk->getEntityName());
+    chunk->setSceneHandle(scene->addEntity(chunk, chunk->getEntityName()));
     unlockMutex();
+    scene->unlockUpdateMutex();
+    return true;
 }
 
 void City::removeChunk(Chunk *chunk) {
@@ -24,20 +24,29 @@ class ChunkGenerator;
 class City {
 public:
 
-    /* The maximum number of Chunks that are allowed to be loading at the same time. */
-    static const int MAX_PARALEL_LOADING_CHUNKS = 1;
+    /*
+     * The maximum number of Chunks that are allowed to be loading at the same time. This is the upper limit for the
+     * number of ChunkLoader worker threads.
+     */
+    static const int MAX_PARALEL_LOADING_CHUNKS = 16;
 
     City(void);
+    /* Creates a City with the given seed. Two Cities with the same seed will be generated exactly the same way. */
+    City(unsigned long long seed);
     ~City(void);
 
+    /* Returns the seed of this City. All random streams used to generate the City are derived from it. */
+    unsigned long long getSeed() { return seed; }
+
     /* Returns the vector containing the Chunks. */
     std::vector<Chunk*> *getChunks() { return chunks; }
 
     /*
      * Adds a Chunk to the City. The Chunk should be fully loaded before it's added. The Chunk will also be added to
-     * the current Scene.
+     * the current Scene. The check for duplicates and the insertion are done under the same lock, so a Chunk is
+     * published all at once. Returns false, without adding it, if there's already a Chunk at the same position.
      */
-    void addChunk(Chunk *chunk);
+    bool addChunk(Chunk *chunk);
 
     /* Removes a Chunk from the City. The Chunk should be unloaded before it's removed. */
     void removeChunk(Chunk *chunk);
@@ -69,6 +78,9 @@ public:
 
 protected:
 
+    /* The seed of this City. Defaults to zero. */
+    unsigned long long seed;
+
     /* The loaded chunks of the city. */
     std::vector<Chunk*> *chunks;
 
@@ -1,7 +1,15 @@
 #include "CityBlock.h"
+#include "../engine/rendering/RenderQueue.h"
+#include "../engine/rendering/LightShader.h"
+
+SDL_atomic_t CityBlock::batchVerticesBefore;
+SDL_atomic_t CityBlock::batchVerticesAfter;
+SDL_atomic_t CityBlock::batchBytesBefore;
+SDL_atomic_t CityBlock::batchBytesAfter;
 
 CityBlock::CityBlock(float density) : Entity() {
     vertices = new std::vector<Intersection*>();
+    batches = new std::vector<Model*>();
     //model = Model::getOrCreate("cube", "resources/meshes/cube.obj", false);
     //shader = Shader::getOrCreate("LightShader", "resources/shaders/vertNormal.glsl",
         //"resources/shaders/fragLight.glsl", false);
@@ -68,16 +76,24 @@ CityBlock::~CityBlock(void) {
         delete vertices;
         vertices = nullptr;
     }
+    if (batches != nullptr) {
+        for (auto it = batches->begin(); it != batches->end(); it++) {
+            ResourcesManager::releaseResource((*it)->getName());
+        }
+        delete batches;
+        batches = nullptr;
+    }
+    if (shader != nullptr) {
+        shader = nullptr;
+    }
 }
 
 void CityBlock::update(float millisElapsed) {
-    if (posChanged || rotChanged || scaleChanged) {
-        calculateModelMatrix(Vector3(), Vector3(), Vector3(1, 1, 1), false, false, false);
-    }
+    updateTransforms();
     // Update the distanceToCamera if that's changed, and if it is, also update the distance of the children.
     if (Naquadah::getInstance()->getCurrentScene()->getCamera()->hasChanged()) {
         Camera *camera = Naquadah::getInstance()->getCurrentScene()->getCamera();
-        Vector3 dir = position - camera->getPosition();
+        Vector3 dir = getPosition() - camera->getPosition();
         distanceToCamera = Vector3::dot(dir, dir);
         for (std::vector<Entity*>::iterator it = childEntities->begin(); it != childEntities->end(); it++) {
             (*it)->update(millisElapsed);
@@ -85,10 +101,20 @@ void CityBlock::update(float millisElapsed) {
     }
 }
 
+void CityBlock::queueDraw(RenderQueue *queue, unsigned char planeMask) {
+    Shader *buildingShader = LightShader::get(Naquadah::getInstance()->getCurrentScene(), LIGHT_SURFACE_BUILDING);
+    auto itEnd = batches->end();
+    for (auto it = batches->begin(); it != itEnd; it++) {
+        RenderItem &item = queue->addModel(buildingShader, *it, nullptr, getModelMatrix(), getPosition());
+        item.setIntParameter(Building::NUM_FLOORS_PARAMETER, Building::FLOORS_PER_VERTEX);
+    }
+    // Only the Buildings that aren't batched have a Model to draw
+    Entity::queueDraw(queue, planeMask);
+}
+
 void CityBlock::addVertice(Intersection *intersection) {
     this->vertices->push_back(intersection);
-    this->position = getCentralPosition();
-    this->posChanged = true;
+    setPosition(getCentralPosition());
 }
 
 void CityBlock::unloadOpenGL() {
@@ -99,14 +125,58 @@ void CityBlock::unloadOpenGL() {
             model->unload();
         }
     }
+    for (auto it = batches->begin(); it != batches->end(); it++) {
+        if ((*it)->getNumUsers() <= 1) {
+            (*it)->unload();
+        }
+    }
+}
+
+void CityBlock::buildBatches() {
+    calculateBoundingBox();
+    // Group the Buildings by texture, merging their meshes on the way
+    std::map<int, MeshData> meshes;
+    auto itEnd = childEntities->end();
+    for (auto it = childEntities->begin(); it != itEnd; it++) {
+        Building *building = (Building*) (*it);
+        if (building->isBatched()) {
+            building->buildMesh(meshes[building->getTextureIndex()]);
+        }
+    }
+    for (auto it = meshes.begin(); it != meshes.end(); it++) {
+        if (it->second.isEmpty()) continue;
+        // The Buildings are built as plain triangles, most of their corners are shared with the neighbour triangles
+        SDL_AtomicAdd(&batchVerticesBefore, (int) it->second.vertices.size());
+        SDL_AtomicAdd(&batchBytesBefore, (int) it->second.getByteSize());
+        it->second.optimise();
+        SDL_AtomicAdd(&batchVerticesAfter, (int) it->second.vertices.size());
+        SDL_AtomicAdd(&batchBytesAfter, (int) it->second.getByteSize());
+        std::stringstream texFileName;
+        texFileName << "resources/textures/buildings/office_" << it->first << ".png";
+        Texture *texture = Texture::getOrCreate(it->first + 1010, texFileName.str(), false);
+        Model *batch = Model::getOrCreate(ResourcesManager::generateNextName(), it->second, Colour::WHITE, texture,
+            false);
+        batch->addUser();
+        batches->push_back(batch);
+    }
+    if (!batches->empty() && shader == nullptr) {
+        shader = Shader::getOrCreate(SHADER_LIGHT_BASIC, "resources/shaders/vertNormal.glsl",
+            "resources/shaders/fragLight.glsl", false);
+    }
+}
+
+void CityBlock::resetBatchStatistics() {
+    SDL_AtomicSet(&batchVerticesBefore, 0);
+    SDL_AtomicSet(&batchVerticesAfter, 0);
+    SDL_AtomicSet(&batchBytesBefore, 0);
+    SDL_AtomicSet(&batchBytesAfter, 0);
 }
 
-void CityBlock::generateBuildings() {
+void CityBlock::generateBuildings(RandomStream &random) {
     if (density > 0) {
         // First we define the CityBlock's RenderRadius. This is the best place to do this as all the vertices (should) be
         // added already.
-        Vector2 minPos = Vector2((float) MAX_INT, (float) MAX_INT);
-        Vector2 maxPos = Vector2();
+        calculateRenderRadius();
 
         // TODO: Move the roadWidth and pavementWidth to Road.h, and make them relative to the road type and size
         float roadWidth = 10.0f;
@@ -115,15 +185,8 @@ void CityBlock::generateBuildings() {
         // The usable area of the CityBlock, inset to allow space for the road and pavement.
         std::vector<Vector2> usableArea = std::vector<Vector2>();
         for (auto it = vertices->begin(); it != vertices->end(); it++) {
-            Vector2 vertex = Vector2((*it)->getPosition().toVec2(Vector3(0, 1, 0)));
-            usableArea.push_back(vertex);
-            // To help define the RenderRadius
-            minPos.x = min(minPos.x, vertex.x);
-            minPos.y = min(minPos.y, vertex.y);
-            maxPos.x = max(maxPos.x, vertex.x);
-            maxPos.y = max(maxPos.y, vertex.y);
+            usableArea.push_back(Vector2((*it)->getPosition().toVec2(Vector3(0, 1, 0))));
         }
-        this->renderRadius = (maxPos - minPos).getLength() / 2.0f;
 
         usableArea = Geom::insetPolygon(usableArea, roadWidth / 2.0f + pavementWidth);
 
@@ -134,8 +197,37 @@ void CityBlock::generateBuildings() {
         auto itEnd = buildingLots.end();
         for (auto it = buildingLots.begin(); it != itEnd; it++) {
             addChild(*it);
-            (*it)->constructGeometry();
+            (*it)->constructGeometry(random);
         }
+        buildBatches();
+    }
+}
+
+void CityBlock::calculateRenderRadius() {
+    Vector2 minPos = Vector2((float) MAX_INT, (float) MAX_INT);
+    Vector2 maxPos = Vector2();
+    for (auto it = vertices->begin(); it != vertices->end(); it++) {
+        Vector2 vertex = Vector2((*it)->getPosition().toVec2(Vector3(0, 1, 0)));
+        minPos.x = min(minPos.x, vertex.x);
+        minPos.y = min(minPos.y, vertex.y);
+        maxPos.x = max(maxPos.x, vertex.x);
+        maxPos.y = max(maxPos.y, vertex.y);
+    }
+    this->renderRadius = (maxPos - minPos).getLength() / 2.0f;
+}
+
+void CityBlock::calculateBoundingBox() {
+    boundingBox = BoundingBox();
+    for (auto it = vertices->begin(); it != vertices->end(); it++) {
+        boundingBox.addPoint((*it)->getPosition());
+    }
+    float maxHeight = 0.0f;
+    auto itEnd = childEntities->end();
+    for (auto it = childEntities->begin(); it != itEnd; it++) {
+        maxHeight = max(maxHeight, ((Building*) (*it))->getHeight());
+    }
+    if (!boundingBox.isEmpty()) {
+        boundingBox.maxPos.y += maxHeight;
     }
 }
 
@@ -198,7 +290,7 @@ std::vector<Building*> CityBlock::splitLots(std::vector<Vector2> &lotPolygon, st
             std::vector<Building*> buildings = std::vector<Building*>();
             if (connectsToRoad) {
                 // Create an empty building and return a vector containing it.
-                Building *newBuilding = new Building(orderedLotPolygon, this, true, roadNormal);
+                Building *newBuilding = new (getAllocationArena()) Building(orderedLotPolygon, this, true, roadNormal);
                 buildings.push_back(newBuilding);
             }
             return buildings;
@@ -11,11 +11,16 @@
 
 #pragma once
 
+#include <map>
 #include <vector>
+#include <sstream>
+#include <SDL.h>
 #include "Intersection.h"
 #include "Building.h"
+#include "math/RandomStream.h"
 #include "../engine/Entity.h"
 #include "../engine/math/Geom.h"
+#include "../engine/math/BoundingBox.h"
 
 class Building;
 
@@ -38,13 +43,18 @@ public:
 
     /* Overload of Entity's methods. */
     virtual void update(float millisElapsed);
-    //virtual void draw(float millisElapsed);
+
+    /* Adds the batched meshes of this CityBlock to queue, and then the Buildings that still have their own Model. */
+    virtual void queueDraw(RenderQueue *queue, unsigned char planeMask);
 
     /* Adds an intersection to this CityBlock. */
     void addVertice(Intersection *intersection);
 
     std::vector<Intersection*> *getVertices() { return vertices; }
 
+    /* Returns the Buildings of this CityBlock, which are stored as its child entities. */
+    std::vector<Entity*> *getBuildings() { return childEntities; }
+
     /* Returns the number of Chunks that are currently using this CityBlock. */
     int getNumChunksSharing() { return (int) numChunksSharing; }
 
@@ -66,9 +76,43 @@ public:
     /*
      * This function should be called after all vertices are set. This will calculate the space of the block and decide
      * the number, size and position of buildings inside the block. This will erase all previous buildings, if any, and
-     * recreate the buildings vector.
+     * recreate the buildings vector. All random choices are taken from random, which should be keyed by the position
+     * of this CityBlock (see RandomStream::forPosition()), so it's the same for every Chunk that generates it.
+     */
+    void generateBuildings(RandomStream &random);
+
+    /*
+     * Merges the geometry of all batched Buildings that share a texture into a single mesh, already placed relative to
+     * this CityBlock, so the whole CityBlock can be drawn with one draw call per texture. Must be called after all the
+     * Buildings have their geometry constructed. The merged meshes are indexed and optimised for the vertex cache
+     * (see MeshData::optimise()). The Models are uploaded later by the UploadQueue, so this can be called from the
+     * ChunkLoader workers.
      */
-    void generateBuildings();
+    void buildBatches();
+
+    /*
+     * Totals of all batches built since the last reset, before and after their meshes were optimised. These are
+     * updated by every thread that builds batches, and are printed by the ChunkBenchmark.
+     */
+    static int getBatchVerticesBefore() { return SDL_AtomicGet(&batchVerticesBefore); }
+    static int getBatchVerticesAfter() { return SDL_AtomicGet(&batchVerticesAfter); }
+    static int getBatchBytesBefore() { return SDL_AtomicGet(&batchBytesBefore); }
+    static int getBatchBytesAfter() { return SDL_AtomicGet(&batchBytesAfter); }
+    static void resetBatchStatistics();
+
+    /* Returns the batched meshes of this CityBlock, one for each Building texture. */
+    std::vector<Model*> *getBatches() { return batches; }
+
+    /* Calculates the render radius of this CityBlock from its vertices. Must be called after all vertices are added. */
+    void calculateRenderRadius();
+
+    /*
+     * Calculates the world space box around the vertices and the Buildings of this CityBlock, used by the culling
+     * hierarchy of the Chunks. Called by buildBatches(), after all Buildings are constructed.
+     */
+    void calculateBoundingBox();
+
+    const BoundingBox &getBoundingBox() const { return boundingBox; }
 
     /* Unloads OpenGL resources and references. This function MUST ONLY be called from the render thread. */
     void unloadOpenGL();
@@ -78,7 +122,7 @@ public:
 
     /* Calculates and returns the world position of this entity. */
     virtual Vector3 getWorldPosition() {
-        return Vector3(position);
+        return getPosition();
     }
 
 protected:
@@ -96,6 +140,17 @@ protected:
     /* The Intersections that are "vertices" to this CityBlock. A CityBlock must have at least 3 vertices. */
     std::vector<Intersection*> *vertices;
 
+    /* The merged meshes of the batched Buildings, one for each texture used by them. */
+    std::vector<Model*> *batches;
+
+    static SDL_atomic_t batchVerticesBefore;
+    static SDL_atomic_t batchVerticesAfter;
+    static SDL_atomic_t batchBytesBefore;
+    static SDL_atomic_t batchBytesAfter;
+
+    /* The box around the vertices and Buildings of this CityBlock. */
+    BoundingBox boundingBox;
+
     /* The maximum perimiter that a single Building lot can occupy. This depends on the type of this CityBlock. */
     float maximumPerimeterPerBuilding;
 
@@ -1,15 +1,18 @@
 #include "CityScene.h"
+#include "../engine/rendering/LightShader.h"
 
 CityScene::CityScene() : Scene(new CitySceneInterface()) {
     this->city = nullptr;
     this->reloadShaders = false;
     this->reloadTextures = false;
+    this->cycleUpdateThreads = false;
 }
 
 CityScene::CityScene(const CityScene &copy) : Scene(copy) {
     this->city = new City(*(copy.city));
     this->reloadShaders = false;
     this->reloadTextures = false;
+    this->cycleUpdateThreads = false;
 }
 
 CityScene::CityScene(City *city) : Scene(new CitySceneInterface()) {
@@ -23,6 +26,7 @@ CityScene::CityScene(City *city) : Scene(new CitySceneInterface()) {
         ResourcesManager::generateNextName());
     this->reloadShaders = false;
     this->reloadTextures = false;
+    this->cycleUpdateThreads = false;
 }
 
 CityScene::~CityScene(void) {
@@ -39,12 +43,25 @@ void CityScene::onKeyPress(SDL_Keysym key) {
     if (key.sym == SDLK_F4) {
         reloadShaders = true;
     }
+    if (key.sym == SDLK_F5) {
+        cycleUpdateThreads = true;
+    }
 }
 
 void CityScene::update(float millisElapsed) {
     Scene::update(millisElapsed);
     lockUpdateMutex();
 
+    // Update threads cycle (F5), to measure how the update time scales with the number of threads
+    if (cycleUpdateThreads) {
+        JobSystem *jobSystem = JobSystem::getInstance();
+        int numThreads = jobSystem->getNumThreads();
+        std::cout << "Update with " << numThreads << " threads: " << Profiler::getTimer(2)->getAverageTime() << "ms"
+            << std::endl;
+        jobSystem->setNumThreads(numThreads > jobSystem->getNumWorkers() ? 1 : numThreads + 1);
+        cycleUpdateThreads = false;
+    }
+
     // TODO: Move distance that new chunks should be loaded to config
     float chunkViewDistance = 4000.0f;
 
@@ -114,10 +131,10 @@ void CityScene::render(Renderer *renderer, float millisElapsed) {
     // Check if there's a Chunk waiting for the OpenGL stuff be unloaded
     //Profiler::getTimer(4)->startMeasurement();
     bool unloaded = false;
-    ChunkOperation chunkOp = ChunkLoader::getInstance()->getFirstInTheQueue();
-    if (chunkOp.city != nullptr && !chunkOp.load) {
+    ChunkOperation chunkOp = ChunkLoader::getInstance()->getFirstUnloadInTheQueue();
+    if (chunkOp.city != nullptr) {
         Chunk *chunk = chunkOp.city->getChunkAt(chunkOp.chunkPos, false);
-        if (chunk != nullptr && !chunk->isSafeToDelete()) {
+        if (chunk != nullptr && !chunk->isSafeToDelete() && !isEntityInScene(chunk->getSceneHandle())) {
             chunk->unloadOpenGL();
             chunk->setSafeToDelete(true);
             unloaded = true;
@@ -130,6 +147,7 @@ void CityScene::render(Renderer *renderer, float millisElapsed) {
     if (reloadShaders) {
         ((Shader*) ResourcesManager::getResource(SHADER_LIGHT_BASIC))->reload();
         ((Shader*) ResourcesManager::getResource(SHADER_LIGHT_ROAD))->reload();
+        LightShader::reloadAll();
         ((Shader*) ResourcesManager::getResource(SHADER_SKY_BOX))->reload();
         std::cout << "Shaders reloaded!" << std::endl;
         reloadShaders = false;
@@ -154,11 +172,58 @@ void CityScene::render(Renderer *renderer, float millisElapsed) {
         //std::cout << chunkOp.chunkPos << " unloaded in " << Profiler::getTimer(4)->getAverageTime() << "ms" << std::endl;
 }
 
-void CityScene::addEntity(Entity *entity, std::string name) {
-    if (entity && name != "") {
-        if (entity->getParent() == nullptr) {
-            // Only add to this map if it's a root entity 
-            entities->insert(std::pair<std::string, Entity*>(name, entity));
+void CityScene::renderOccluders() {
+    Vector3 cameraPos = camera->getPosition();
+    float maxDistance = (float) MAX_OCCLUDER_DISTANCE;
+    float minHeight = (float) MIN_OCCLUDER_HEIGHT;
+    float chunkRadius = Chunk::CHUNK_SIZE * 0.75f; // A bit more than half the diagonal
+    std::vector<std::pair<float, Building*>> candidates;
+    for (auto it = entities->begin(); it != entities->end(); it++) {
+        // Only the Chunks have occluders, any other Entity in the Scene is skipped
+        Chunk *chunk = dynamic_cast<Chunk*>(*it);
+        if (chunk == nullptr) continue;
+        Vector2 chunkCentre = chunk->getCentrePos();
+        if ((Vector2(cameraPos.x, cameraPos.z) - chunkCentre).getLength() > maxDistance + chunkRadius) continue;
+        std::vector<CityBlock*> *cityBlocks = chunk->getCityBlocks();
+        for (auto itBlock = cityBlocks->begin(); itBlock != cityBlocks->end(); itBlock++) {
+            CityBlock *cityBlock = *itBlock;
+            Vector3 blockPos = cityBlock->getPosition();
+            if ((blockPos - cameraPos).getLength() > maxDistance + cityBlock->getRenderRadius()) continue;
+            std::vector<Entity*> *buildings = cityBlock->getBuildings();
+            for (auto itB = buildings->begin(); itB != buildings->end(); itB++) {
+                Building *building = (Building*) (*itB);
+                if (!building->isBatched() || building->getHeight() < minHeight) continue;
+                float distance = (blockPos + building->getPosition() - cameraPos).getLength();
+                if (distance > maxDistance) continue;
+                candidates.push_back(std::make_pair(building->getHeight() / max(distance, 1.0f), building));
+            }
         }
     }
+    // Keep only the Buildings that cover most of the screen
+    int numOccluders = min((int) candidates.size(), (int) MAX_OCCLUDERS);
+    std::partial_sort(candidates.begin(), candidates.begin() + numOccluders, candidates.end(),
+        [](const std::pair<float, Building*> &a, const std::pair<float, Building*> &b) { return a.first > b.first; });
+    for (int i = 0; i < numOccluders; i++) {
+        Building *building = candidates[i].second;
+        float bottom = building->getCityBlock()->getPosition().y;
+        occlusionBuffer->addOccluderPrism(*building->getLotArea(), bottom, bottom + building->getHeight());
+    }
+}
+
+EntityHandle CityScene::addEntity(Entity *entity, const std::string &name) {
+    // The render thread iterates the entities, and adding one may move them all to a bigger array
+    lockUpdateMutex();
+    lockRenderMutex();
+    EntityHandle handle = INVALID_ENTITY_HANDLE;
+    if (entity && entity->getParent() == nullptr) {
+        // Only add to this map if it's a root entity
+        handle = entities->add(entity);
+        (void) name; // Only kept in debug builds
+#ifdef _DEBUG
+        if (name != "") entities->setName(handle, name);
+#endif
+    }
+    unlockRenderMutex();
+    unlockUpdateMutex();
+    return handle;
 }
\ No newline at end of file
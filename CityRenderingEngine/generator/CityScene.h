@@ -15,6 +15,12 @@
 class CityScene : public Scene {
 public:
 
+    /* Maximum number of Buildings rasterized as occluders on each frame. */
+    static const int MAX_OCCLUDERS = 48;
+    /* Only Buildings at least this tall, and closer than this to the camera, are considered as occluders. */
+    static const int MIN_OCCLUDER_HEIGHT = 30;
+    static const int MAX_OCCLUDER_DISTANCE = 800;
+
     CityScene(void);
     CityScene(City *city);
     CityScene(const CityScene &copy);
@@ -39,7 +45,7 @@ public:
     //virtual void onKeyDown(SDL_Keysym key); // Will fire in every tick that a key is down
     //virtual void onKeyUp(SDL_Keysym key); // Will fire every time a key is released
 
-    virtual void addEntity(Entity *entity, std::string name);
+    virtual EntityHandle addEntity(Entity *entity, const std::string &name = "");
 
     /* Updates the Scene logic. */
     virtual void update(float millisElapsed);
@@ -47,6 +53,12 @@ public:
     /* Renders all the Scene objects and the interface. Renderer is the active renderer on the engine. */
     virtual void render(Renderer *renderer, float millisElapsed);
 
+    /*
+     * Rasterizes the tall Buildings close to the camera into the OcclusionBuffer. The Buildings are ranked by their
+     * height over their distance, roughly how much of the screen they cover, and only the best MAX_OCCLUDERS are used.
+     */
+    virtual void renderOccluders();
+
     /* Renders all the Scene objects and the interface. Renderer is the active renderer on the engine. */
     //virtual void render(Renderer *renderer, float millisElapsed);
 
@@ -59,6 +71,9 @@ protected:
     bool reloadShaders;
     bool reloadTextures;
 
+    /* Control flag to print the update time and move on to the next number of update threads. Debug tool. */
+    bool cycleUpdateThreads;
+
     /* The City that will be simulated in this CityScene. */
     City *city;
 };
\ No newline at end of file
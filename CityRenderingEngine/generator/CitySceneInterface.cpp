@@ -1,19 +1,30 @@
 #include "CitySceneInterface.h"
 #include "CityScene.h"
 #include "../engine/ui/TextItem.h"
+#include "../engine/rendering/UploadQueue.h"
 
 CitySceneInterface::CitySceneInterface(void) : UserInterface() {
     addItem(new TextItem(Vector2(10, 10), 0, "FPS", 18), "fpsCounter");
     addItem(new TextItem(Vector2(10, 29), 0, "Chunks", 18), "chunksCounter");
+    addItem(new TextItem(Vector2(10, 48), 0, "Uploads", 18), "uploadsCounter");
     addItem(new TextItem(Vector2(10, 70), 0, "XYZ", 18), "positionDebug");
     addItem(new TextItem(Vector2(10, 89), 0, "Facing", 18), "facingDebug");
+    addItem(new TextItem(Vector2(10, 108), 0, "Render", 18), "renderStats");
+    addItem(new TextItem(Vector2(10, 127), 0, "Culling", 18), "cullingStats");
+    addItem(new TextItem(Vector2(10, 146), 0, "Occlusion", 18), "occlusionStats");
+    addItem(new TextItem(Vector2(10, 165), 0, "Queue", 18), "queueStats");
 }
 
 CitySceneInterface::CitySceneInterface(const CitySceneInterface &copy) : UserInterface(copy) {
     addItem(new TextItem(Vector2(10, 10), 0, "FPS", 18), "fpsCounter");
     addItem(new TextItem(Vector2(10, 29), 0, "Chunks", 18), "chunksCounter");
+    addItem(new TextItem(Vector2(10, 48), 0, "Uploads", 18), "uploadsCounter");
     addItem(new TextItem(Vector2(10, 70), 0, "XYZ", 18), "positionDebug");
     addItem(new TextItem(Vector2(10, 89), 0, "Facing", 18), "facingDebug");
+    addItem(new TextItem(Vector2(10, 108), 0, "Render", 18), "renderStats");
+    addItem(new TextItem(Vector2(10, 127), 0, "Culling", 18), "cullingStats");
+    addItem(new TextItem(Vector2(10, 146), 0, "Occlusion", 18), "occlusionStats");
+    addItem(new TextItem(Vector2(10, 165), 0, "Queue", 18), "queueStats");
 }
 
 CitySceneInterface::~CitySceneInterface(void) {
@@ -25,20 +36,47 @@ void CitySceneInterface::update(unsigned millisElapsed) {
     CityScene *cityScene = (CityScene*) Naquadah::getInstance()->getCurrentScene();
     std::ostringstream fpsText;
     std::ostringstream chunksText;
+    std::ostringstream uploadsText;
     std::ostringstream positionText;
     std::ostringstream facingText;
+    std::ostringstream renderText;
+    std::ostringstream cullingText;
+    std::ostringstream occlusionText;
+    std::ostringstream queueText;
 
     fpsText << "FPS: " << fps << ", TPS: " << tps;
     chunksText << "Chunks: " << cityScene->getCity()->getChunks()->size();
+    uploadsText << "Pending uploads: " << UploadQueue::getBacklogCount() << " (" <<
+        UploadQueue::getBacklogBytes() / 1024 << " KB)";
     Vector3 cameraPos = cityScene->getCamera()->getPosition();
     Vector3 cameraRot = cityScene->getCamera()->getRotation();
     positionText << "XYZ: " << cameraPos.x << " / " << cameraPos.y << " / " << cameraPos.z;
+    Renderer *renderer = Naquadah::getRenderer();
+    renderText << "Draw calls: " << renderer->getLastFrameDrawCalls() << ", GL state calls: " <<
+        renderer->getLastFrameStateCalls() << " (" << renderer->getLastFrameFilteredCalls() << " filtered), " <<
+        "CPU render: " << Profiler::getTimer(1)->getAverageTime() << " ms";
+    Frustum *frustum = cityScene->getFrustum();
+    cullingText << "Culling: " << frustum->getLastFrameNodesVisited() << " volumes tested, " <<
+        frustum->getLastFrameObjectsDrawn() << " objects drawn";
+    OcclusionBuffer *occlusionBuffer = cityScene->getOcclusionBuffer();
+    occlusionText << "Occlusion: " << occlusionBuffer->getLastFrameOccluders() << " occluders, " <<
+        occlusionBuffer->getLastFrameCulled() << " / " << occlusionBuffer->getLastFrameTested() << " culled, " <<
+        Profiler::getTimer(5)->getAverageTime() << " ms";
+    RenderQueue *renderQueue = cityScene->getRenderQueue();
+    queueText << "Render queue: " << renderQueue->getLastFrameItems() << " items, " <<
+        renderQueue->getLastFrameShaderChanges() << " shader changes, " <<
+        renderQueue->getLastFrameTextureChanges() << " texture changes";
     facingText << "Facing (XY rotation): " << cameraRot.x << " / " << cameraRot.y;
 
     ((TextItem*) getItem("fpsCounter"))->setText(fpsText.str());
     ((TextItem*) getItem("chunksCounter"))->setText(chunksText.str());
+    ((TextItem*) getItem("uploadsCounter"))->setText(uploadsText.str());
     ((TextItem*) getItem("positionDebug"))->setText(positionText.str());
     ((TextItem*) getItem("facingDebug"))->setText(facingText.str());
+    ((TextItem*) getItem("renderStats"))->setText(renderText.str());
+    ((TextItem*) getItem("cullingStats"))->setText(cullingText.str());
+    ((TextItem*) getItem("occlusionStats"))->setText(occlusionText.str());
+    ((TextItem*) getItem("queueStats"))->setText(queueText.str());
 
     UserInterface::update(millisElapsed);
 
@@ -85,13 +85,9 @@ CityBlock *GridLayout::generateCityBlock(Chunk *chunk, Intersection *start) {
                 centralPosition += vertices.at(i)->getPosition();
             }
             centralPosition = centralPosition / (float) numVertices;
-            // Perform a simple boundary check to see if this CityBlock is contained whiin the Chunk
-            Vector2 chunkMin = chunk->getChunkPos();
-            Vector2 chunkMax = chunkMin + 1000.0f;
-            if (centralPosition.x <= chunkMin.x || centralPosition.x > chunkMax.x) {
-                if (centralPosition.y <= chunkMin.y || centralPosition.y > chunkMax.y) {
-                    return nullptr; // The CityBlock centre is outside the Chunk, discard it
-                }
+            // A CityBlock belongs to the Chunk that contains its centre. The neighbour Chunk will generate it otherwise
+            if (!chunk->containsPosition(centralPosition)) {
+                return nullptr; // The CityBlock centre is outside the Chunk, discard it
             }
             auto itEnd = chunk->getCityBlocks()->end();
             for (auto it = chunk->getCityBlocks()->begin(); it != itEnd; it++) {
@@ -100,7 +96,7 @@ CityBlock *GridLayout::generateCityBlock(Chunk *chunk, Intersection *start) {
                 }
             }
             float density = Perlin::getCityBlockDensity(centralPosition.x, centralPosition.z);
-            CityBlock *cityBlock = new CityBlock(density);
+            CityBlock *cityBlock = new (chunk->getArena()) CityBlock(density);
             for (auto it = vertices.begin(); it != vertices.end(); it++) {
                 cityBlock->addVertice((*it));
             }
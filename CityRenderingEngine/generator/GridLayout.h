@@ -11,6 +11,7 @@
 
 #include "City.h"
 #include "math/Perlin.h"
+#include "math/RandomStream.h"
 
 class Chunk;
 class Intersection;
@@ -25,10 +26,12 @@ public:
     virtual ~GridLayout(void) {}
 
     /*
-     * Calculates and returns a Vector2 position indicating the position of the intersection in the bounding space.
-     * This function will return (-1, -1) if there's no Intersection inside the bounding space provided. 
+     * Calculates the world position of the intersection in the bounding space (posMin and posMax, in world
+     * coordinates) and stores it in position. Returns false if there's no Intersection inside the bounding space. The
+     * result must depend only on the bounding space and random, never on what was generated before, so that any
+     * Chunk that covers the same space will get exactly the same Intersection.
      */
-    virtual Vector2 getIntersectionPosition() = 0;
+    virtual bool getIntersectionPosition(RandomStream &random, Vector2 &position) = 0;
 
     /*
      * This function should generate Roads from the newest Intersection created for the chunk. It must ensure that all
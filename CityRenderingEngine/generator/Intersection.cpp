@@ -1,5 +1,6 @@
 #include "Intersection.h"
 #include "Chunk.h"
+#include "../engine/rendering/RenderQueue.h"
 
 Intersection::Intersection(void) : Entity() {
     setModel(Model::getOrCreate(MODEL_INTERSECTION, "resources/meshes/plane.obj", false));
@@ -8,9 +9,7 @@ Intersection::Intersection(void) : Entity() {
     shader = Shader::getOrCreate(SHADER_LIGHT_ROAD,
         "resources/shaders/vertRoad.glsl", "resources/shaders/fragRoad.glsl", false);
     // Calculate the plane's model rotation, position and scale
-    this->position = Vector3();
-    this->rotation = Vector3();
-    this->scale = Vector3(10, 0, 10);
+    setScale(Vector3(10, 0, 10));
     this->setRenderRadius(15);
     this->numChunksSharing = 0;
     //connections = new std::vector<Intersection*>();
@@ -24,9 +23,8 @@ Intersection::Intersection(Vector3 position) : Entity() {
     shader = Shader::getOrCreate(SHADER_LIGHT_ROAD,
         "resources/shaders/vertRoad.glsl", "resources/shaders/fragRoad.glsl", false);
     // Calculate the plane's model rotation, position and scale
-    this->position = position;
-    this->rotation = Vector3();
-    this->scale = Vector3(10, 0, 10);
+    setPosition(position);
+    setScale(Vector3(10, 0, 10));
     this->setRenderRadius(15);
     this->numChunksSharing = 0;
     //connections = new std::vector<Intersection*>();
@@ -46,14 +44,11 @@ Intersection::~Intersection(void) {
     }
 }
 
-void Intersection::draw(float millisElapsed) {
+void Intersection::queueDraw(RenderQueue *queue, unsigned char /* planeMask */) {
     if (model != nullptr) {
-        Naquadah::getInstance()->getCurrentScene()->useShader(shader);
-        Naquadah::getRenderer()->updateShaderMatrix("modelMatrix", modelMatrix);
-        float distance = scale.z * 2.0f;
-        shader->getShaderParameter("roadScale")->setValue(&distance, false);
-        shader->updateShaderParameters(false);
-        model->draw();
+        const Matrix4 &modelMatrix = getModelMatrix();
+        RenderItem &item = queue->addModel(shader, model, nullptr, modelMatrix, modelMatrix.getPositionVector());
+        item.setFloatParameter(Road::ROAD_SCALE_PARAMETER, getScale().z * 2.0f);
     }
 }
 
@@ -64,7 +59,8 @@ Road *Intersection::connectTo(Intersection *other) {
     }
     //this->connections->push_back(other);
     //other->connections->push_back(this);
-    Road *road = new Road(this, other);
+    // The Road lives as long as the Intersections, so it goes in the same arena
+    Road *road = new (getAllocationArena()) Road(this, other);
     this->roads->push_back(road);
     other->roads->push_back(road);
     return road;
@@ -82,14 +78,14 @@ void Intersection::disconnectFrom(Road *connection) {
 
 void Intersection::disconnectFromAll(Chunk *chunk) {
     if (roads != nullptr) {
-        auto itEnd = roads->end();
-        for (auto it = roads->begin(); it != itEnd; it++) {
-            Intersection *other = (*it)->getOtherEnd(this);
-            other->disconnectFrom(*it);
+        // The list is cleared first, as each Road disconnects itself from both ends when it's deleted
+        std::vector<Road*> connectedRoads = *roads;
+        roads->clear();
+        auto itEnd = connectedRoads.end();
+        for (auto it = connectedRoads.begin(); it != itEnd; it++) {
             chunk->removeRoad(*it);
-            //delete (*it);
+            delete *it;
         }
-        roads->clear();
     }
 }
 
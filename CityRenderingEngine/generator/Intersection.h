@@ -25,7 +25,8 @@ public:
     Intersection(Vector3 position);
     virtual ~Intersection(void);
 
-    virtual void draw(float millisElapsed);
+    /* Same as Road::queueDraw(). */
+    virtual void queueDraw(RenderQueue *queue, unsigned char planeMask);
 
     /* Connects this intersction to another, creating a connection and a road between them. */
     Road *connectTo(Intersection *other);
@@ -62,7 +63,7 @@ public:
 
     /* Calculates and returns the world position of this entity. */
     virtual Vector3 getWorldPosition() {
-        return Vector3(position);
+        return getPosition();
     }
 
 protected:
@@ -0,0 +1,190 @@
+#include "IntersectionGrid.h"
+#include "Intersection.h"
+#include "../engine/math/Common.h"
+
+IntersectionGrid::IntersectionGrid(void) {
+    this->cellSize = 50.0f;
+    this->size = 0;
+    this->minCellX = this->minCellZ = 0;
+    this->maxCellX = this->maxCellZ = -1;
+    this->cells = new std::unordered_map<long long, std::vector<Intersection*>>();
+}
+
+IntersectionGrid::IntersectionGrid(float cellSize) {
+    this->cellSize = cellSize;
+    this->size = 0;
+    this->minCellX = this->minCellZ = 0;
+    this->maxCellX = this->maxCellZ = -1;
+    this->cells = new std::unordered_map<long long, std::vector<Intersection*>>();
+}
+
+IntersectionGrid::~IntersectionGrid(void) {
+    if (cells != nullptr) {
+        delete cells;
+        cells = nullptr;
+    }
+}
+
+void IntersectionGrid::insert(Intersection *intersection) {
+    Vector3 position = intersection->getPosition();
+    int cellX = getCell(position.x);
+    int cellZ = getCell(position.z);
+    (*cells)[getCellKey(cellX, cellZ)].push_back(intersection);
+    if (size == 0) {
+        minCellX = maxCellX = cellX;
+        minCellZ = maxCellZ = cellZ;
+    } else {
+        minCellX = min(minCellX, cellX);
+        minCellZ = min(minCellZ, cellZ);
+        maxCellX = max(maxCellX, cellX);
+        maxCellZ = max(maxCellZ, cellZ);
+    }
+    size++;
+}
+
+void IntersectionGrid::remove(Intersection *intersection) {
+    Vector3 position = intersection->getPosition();
+    auto cellIt = cells->find(getCellKey(getCell(position.x), getCell(position.z)));
+    if (cellIt == cells->end()) return;
+    std::vector<Intersection*> &cell = cellIt->second;
+    auto itEnd = cell.end();
+    auto it = std::find(cell.begin(), itEnd, intersection);
+    if (it != itEnd) {
+        cell.erase(it);
+        size--;
+        if (cell.empty()) {
+            cells->erase(cellIt);
+        }
+    }
+    // The bounds are not shrunk, they are only used as a limit for the searches
+}
+
+void IntersectionGrid::clear() {
+    cells->clear();
+    size = 0;
+    minCellX = minCellZ = 0;
+    maxCellX = maxCellZ = -1;
+}
+
+std::vector<Intersection*> *IntersectionGrid::getCellContents(int cellX, int cellZ) {
+    auto it = cells->find(getCellKey(cellX, cellZ));
+    if (it == cells->end()) return nullptr;
+    return &(it->second);
+}
+
+Intersection *IntersectionGrid::getClosestTo(const Vector3 &position, float maxDistance) {
+    if (size == 0) return nullptr;
+    int centreX = getCell(position.x);
+    int centreZ = getCell(position.z);
+    // The ring search can stop once it gets past the last occupied cell, or past maxDistance
+    int maxRing = max(max(abs(centreX - minCellX), abs(maxCellX - centreX)),
+        max(abs(centreZ - minCellZ), abs(maxCellZ - centreZ)));
+    if (maxDistance > 0) {
+        maxRing = min(maxRing, (int) ceil(maxDistance / cellSize));
+    }
+    Intersection *closest = nullptr;
+    float closestDistance = maxDistance > 0 ? maxDistance : 999999.9f;
+    for (int ring = 0; ring <= maxRing; ring++) {
+        for (int i = centreX - ring; i <= centreX + ring; i++) {
+            // Only the border cells of the ring are visited, the inner ones were already visited before
+            int step = (i == centreX - ring || i == centreX + ring) ? 1 : max(ring * 2, 1);
+            for (int j = centreZ - ring; j <= centreZ + ring; j += step) {
+                std::vector<Intersection*> *cell = getCellContents(i, j);
+                if (cell == nullptr) continue;
+                auto itEnd = cell->end();
+                for (auto it = cell->begin(); it != itEnd; it++) {
+                    float distance = (position - (*it)->getPosition()).getLength();
+                    if (distance < closestDistance) {
+                        closest = (*it);
+                        closestDistance = distance;
+                    }
+                }
+            }
+        }
+        // Anything on the next ring is at least (ring * cellSize) away, so if we already have something closer, stop
+        if (closest != nullptr && closestDistance <= ring * cellSize) break;
+    }
+    return closest;
+}
+
+std::vector<Intersection*> IntersectionGrid::getClosestListTo(const Vector3 &position, int number) {
+    std::vector<Intersection*> orderedIntersections = std::vector<Intersection*>();
+    std::vector<float> distances = std::vector<float>();
+    if (size == 0 || number <= 0) return orderedIntersections;
+    int centreX = getCell(position.x);
+    int centreZ = getCell(position.z);
+    int maxRing = max(max(abs(centreX - minCellX), abs(maxCellX - centreX)),
+        max(abs(centreZ - minCellZ), abs(maxCellZ - centreZ)));
+    for (int ring = 0; ring <= maxRing; ring++) {
+        for (int i = centreX - ring; i <= centreX + ring; i++) {
+            int step = (i == centreX - ring || i == centreX + ring) ? 1 : max(ring * 2, 1);
+            for (int j = centreZ - ring; j <= centreZ + ring; j += step) {
+                std::vector<Intersection*> *cell = getCellContents(i, j);
+                if (cell == nullptr) continue;
+                auto itEnd = cell->end();
+                for (auto it = cell->begin(); it != itEnd; it++) {
+                    float distance = (position - (*it)->getPosition()).getLength();
+                    if (distance == 0.0f) continue;
+                    // Insertion sort, the lists here are always very small
+                    int index = (int) distances.size();
+                    while (index > 0 && distance <= distances.at(index - 1)) index--;
+                    orderedIntersections.insert(orderedIntersections.begin() + index, (*it));
+                    distances.insert(distances.begin() + index, distance);
+                }
+            }
+        }
+        // We can stop once we have enough Intersections that are guaranteed to be closer than any on the next ring
+        if ((int) distances.size() >= number && distances.at(number - 1) <= ring * cellSize) break;
+    }
+    if ((int) orderedIntersections.size() > number) {
+        orderedIntersections.erase(orderedIntersections.begin() + number, orderedIntersections.end());
+    }
+    return orderedIntersections;
+}
+
+std::vector<Intersection*> IntersectionGrid::getWithinRadius(const Vector3 &position, float radius) {
+    std::vector<Intersection*> found = std::vector<Intersection*>();
+    if (size == 0) return found;
+    int cellMinX = max(getCell(position.x - radius), minCellX);
+    int cellMaxX = min(getCell(position.x + radius), maxCellX);
+    int cellMinZ = max(getCell(position.z - radius), minCellZ);
+    int cellMaxZ = min(getCell(position.z + radius), maxCellZ);
+    float radiusSquared = radius * radius;
+    for (int i = cellMinX; i <= cellMaxX; i++) {
+        for (int j = cellMinZ; j <= cellMaxZ; j++) {
+            std::vector<Intersection*> *cell = getCellContents(i, j);
+            if (cell == nullptr) continue;
+            auto itEnd = cell->end();
+            for (auto it = cell->begin(); it != itEnd; it++) {
+                Vector3 dir = position - (*it)->getPosition();
+                if (Vector3::dot(dir, dir) < radiusSquared) {
+                    found.push_back(*it);
+                }
+            }
+        }
+    }
+    return found;
+}
+
+bool IntersectionGrid::hasAnyWithinRadius(const Vector3 &position, float radius) {
+    if (size == 0) return false;
+    int cellMinX = max(getCell(position.x - radius), minCellX);
+    int cellMaxX = min(getCell(position.x + radius), maxCellX);
+    int cellMinZ = max(getCell(position.z - radius), minCellZ);
+    int cellMaxZ = min(getCell(position.z + radius), maxCellZ);
+    float radiusSquared = radius * radius;
+    for (int i = cellMinX; i <= cellMaxX; i++) {
+        for (int j = cellMinZ; j <= cellMaxZ; j++) {
+            std::vector<Intersection*> *cell = getCellContents(i, j);
+            if (cell == nullptr) continue;
+            auto itEnd = cell->end();
+            for (auto it = cell->begin(); it != itEnd; it++) {
+                Vector3 dir = position - (*it)->getPosition();
+                if (Vector3::dot(dir, dir) < radiusSquared) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,84 @@
+/*
+ * Description: A spatial hash grid used to quickly find Intersections by their position. The XZ plane is split into
+ * square cells of cellSize meters, and each cell keeps a list of the Intersections that are inside it. Cells are only
+ * created when an Intersection is inserted in them, so the grid has no fixed bounds, which is necessary because a
+ * Chunk may also contain Intersections that are outside of its area (shared with its neighbours).
+ *
+ * The cell size should be close to the minimum distance allowed between two Intersections. That way, a radius query
+ * for that distance only has to look at the 3x3 block of cells around the position, and each cell will hold at most a
+ * handful of Intersections, making the queries O(1) in the expected case, instead of O(n) with a linear search.
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include "../engine/math/Vector3.h"
+
+class Intersection;
+
+class IntersectionGrid {
+public:
+
+    IntersectionGrid(void);
+    IntersectionGrid(float cellSize);
+    ~IntersectionGrid(void);
+
+    /* Inserts an Intersection in the grid, at the cell corresponding to its position. */
+    void insert(Intersection *intersection);
+
+    /* Removes an Intersection from the grid. Its position must not have changed since it was inserted. */
+    void remove(Intersection *intersection);
+
+    /* Removes all Intersections from the grid. */
+    void clear();
+
+    /*
+     * Returns the closest Intersection to position. If maxDistance is positive, only Intersections within that
+     * distance will be considered. If no Intersection is found, returns nullptr.
+     */
+    Intersection *getClosestTo(const Vector3 &position, float maxDistance = -1.0f);
+
+    /*
+     * Returns up to number Intersections closest to position, ordered from the closest to the farthest. Intersections
+     * that are exactly at position are ignored, so an Intersection is never returned as one of its own neighbours.
+     */
+    std::vector<Intersection*> getClosestListTo(const Vector3 &position, int number);
+
+    /* Returns all Intersections that are within radius of position, in no particular order. */
+    std::vector<Intersection*> getWithinRadius(const Vector3 &position, float radius);
+
+    /* Returns true if there's at least one Intersection within radius of position. */
+    bool hasAnyWithinRadius(const Vector3 &position, float radius);
+
+    /* Returns the number of Intersections stored in this grid. */
+    int getSize() { return size; }
+
+    float getCellSize() { return cellSize; }
+
+protected:
+
+    /* Calculates the cell coordinate of a world coordinate. */
+    int getCell(float coordinate) { return (int) floor(coordinate / cellSize); }
+
+    /* Packs a pair of cell coordinates into a single key for the cells map. */
+    static long long getCellKey(int cellX, int cellZ) {
+        return (((long long) cellX) << 32) | ((long long) cellZ & 0xFFFFFFFFLL);
+    }
+
+    /* Returns the list of Intersections of a cell, or nullptr if the cell is empty. */
+    std::vector<Intersection*> *getCellContents(int cellX, int cellZ);
+
+    /* Size, in meters, of each cell of the grid. */
+    float cellSize;
+
+    /* The number of Intersections stored in the grid. */
+    int size;
+
+    /* Bounds of the cells currently in use. Used to stop the ring search when there's nothing else to search. */
+    int minCellX, minCellZ, maxCellX, maxCellZ;
+
+    /* The Intersections on each non-empty cell, indexed by the key generated by getCellKey. */
+    std::unordered_map<long long, std::vector<Intersection*>> *cells;
+};
@@ -0,0 +1,331 @@
+#include "RegionFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+RegionFile::RegionFile(const std::string &fileName) {
+    this->fileName = fileName;
+    RegionEntry emptyEntry = { 0, 0 };
+    this->entries = new std::vector<RegionEntry>(REGION_SIZE * REGION_SIZE, emptyEntry);
+    this->fileValid = false;
+    this->fileSize = 0;
+    this->wastedSize = 0;
+    this->mappedData = nullptr;
+    this->mappedSize = 0;
+    this->fileHandle = nullptr;
+    this->mappingHandle = nullptr;
+    this->mutex = SDL_CreateMutex();
+}
+
+RegionFile::~RegionFile(void) {
+    close();
+    if (entries != nullptr) {
+        delete entries;
+        entries = nullptr;
+    }
+    if (mutex != nullptr) {
+        SDL_DestroyMutex(mutex);
+        mutex = nullptr;
+    }
+}
+
+void RegionFile::open() {
+    lockMutex();
+    fileValid = false;
+    fileSize = 0;
+    wastedSize = 0;
+    if (map() && mappedSize >= HEADER_SIZE) {
+        BinaryBuffer header;
+        header.writeBytes(mappedData, HEADER_SIZE);
+        unsigned int magic = header.read<unsigned int>();
+        unsigned short version = header.read<unsigned short>();
+        unsigned short regionSize = header.read<unsigned short>();
+        if (magic == FILE_MAGIC && version == FILE_VERSION && regionSize == REGION_SIZE) {
+            fileValid = true;
+            fileSize = (unsigned int) mappedSize;
+            unsigned int usedSize = HEADER_SIZE;
+            for (int i = 0; i < REGION_SIZE * REGION_SIZE; i++) {
+                RegionEntry entry = header.read<RegionEntry>();
+                if (entry.offset < HEADER_SIZE || entry.offset + entry.size > fileSize) {
+                    entry.offset = 0; // Points outside of the file, probably an interrupted write
+                    entry.size = 0;
+                }
+                (*entries)[i] = entry;
+                usedSize += entry.size;
+            }
+            wastedSize = fileSize > usedSize ? fileSize - usedSize : 0;
+        }
+    }
+    if (!fileValid) {
+        // There's no file yet, or it can't be used. It will be created again on the first write
+        unmap();
+        RegionEntry emptyEntry = { 0, 0 };
+        entries->assign(REGION_SIZE * REGION_SIZE, emptyEntry);
+    }
+    unlockMutex();
+}
+
+void RegionFile::close() {
+    lockMutex();
+    unmap();
+    unlockMutex();
+}
+
+bool RegionFile::hasChunk(int index) {
+    if (index < 0 || index >= REGION_SIZE * REGION_SIZE) return false;
+    lockMutex();
+    bool exists = (*entries)[index].offset != 0;
+    unlockMutex();
+    return exists;
+}
+
+unsigned int RegionFile::getChunkSize(int index) {
+    if (index < 0 || index >= REGION_SIZE * REGION_SIZE) return 0;
+    lockMutex();
+    unsigned int size = (*entries)[index].size;
+    unlockMutex();
+    return size;
+}
+
+bool RegionFile::readChunk(int index, BinaryBuffer &buffer) {
+    if (index < 0 || index >= REGION_SIZE * REGION_SIZE) return false;
+    lockMutex();
+    RegionEntry entry = (*entries)[index];
+    bool success = false;
+    if (entry.offset != 0 && map() && entry.offset + entry.size <= mappedSize) {
+        buffer.clear();
+        buffer.writeBytes(mappedData + entry.offset, entry.size);
+        success = true;
+    }
+    unlockMutex();
+    return success;
+}
+
+bool RegionFile::writeChunk(int index, BinaryBuffer &buffer) {
+    if (index < 0 || index >= REGION_SIZE * REGION_SIZE) return false;
+    lockMutex();
+    // The file can't be resized while it's mapped, it will be mapped again on the next read
+    unmap();
+    if (!fileValid && !createFile()) {
+        unlockMutex();
+        return false;
+    }
+    std::fstream file;
+    file.open(fileName, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file.is_open()) {
+        unlockMutex();
+        return false;
+    }
+    // Append the data first, and only then point the offset table to it
+    RegionEntry entry;
+    entry.offset = fileSize;
+    entry.size = (unsigned int) buffer.getSize();
+    file.seekp(entry.offset, std::ios::beg);
+    if (entry.size > 0) {
+        file.write(&(*buffer.getData())[0], entry.size);
+    }
+    file.flush();
+    file.seekp(8 + index * sizeof(RegionEntry), std::ios::beg);
+    file.write((const char*) &entry, sizeof(RegionEntry));
+    bool success = !file.fail();
+    file.close();
+    if (success) {
+        wastedSize += (*entries)[index].size;
+        (*entries)[index] = entry;
+        fileSize += entry.size;
+    } else {
+        // We don't know what was written, read the table back on the next access
+        open();
+    }
+    unlockMutex();
+    return success;
+}
+
+bool RegionFile::removeChunk(int index) {
+    if (index < 0 || index >= REGION_SIZE * REGION_SIZE) return false;
+    lockMutex();
+    if ((*entries)[index].offset == 0) {
+        unlockMutex();
+        return false;
+    }
+    unmap();
+    std::fstream file;
+    file.open(fileName, std::ios::in | std::ios::out | std::ios::binary);
+    bool success = false;
+    if (file.is_open()) {
+        RegionEntry emptyEntry = { 0, 0 };
+        file.seekp(8 + index * sizeof(RegionEntry), std::ios::beg);
+        file.write((const char*) &emptyEntry, sizeof(RegionEntry));
+        success = !file.fail();
+        file.close();
+        if (success) {
+            wastedSize += (*entries)[index].size;
+            (*entries)[index] = emptyEntry;
+        }
+    }
+    unlockMutex();
+    return success;
+}
+
+bool RegionFile::compact() {
+    lockMutex();
+    if (!fileValid || wastedSize == 0) {
+        unlockMutex();
+        return true;
+    }
+    if (!map()) {
+        unlockMutex();
+        return false;
+    }
+    // Build the new file in memory, with the Chunks in the same order as the offset table
+    std::vector<RegionEntry> newEntries = *entries;
+    unsigned int offset = HEADER_SIZE;
+    int numChunks = 0;
+    for (auto it = newEntries.begin(); it != newEntries.end(); it++) {
+        if ((*it).offset != 0) {
+            (*it).offset = offset;
+            offset += (*it).size;
+            numChunks++;
+        }
+    }
+    bool success;
+    if (numChunks == 0) {
+        unmap();
+        success = std::remove(fileName.c_str()) == 0;
+        if (success) {
+            fileValid = false;
+            fileSize = 0;
+            wastedSize = 0;
+        }
+    } else {
+        BinaryBuffer compacted;
+        compacted.write((unsigned int) FILE_MAGIC);
+        compacted.write((unsigned short) FILE_VERSION);
+        compacted.write((unsigned short) REGION_SIZE);
+        for (auto it = newEntries.begin(); it != newEntries.end(); it++) {
+            compacted.write(*it);
+        }
+        for (auto it = entries->begin(); it != entries->end(); it++) {
+            if ((*it).offset != 0) {
+                compacted.writeBytes(mappedData + (*it).offset, (*it).size);
+            }
+        }
+        unmap();
+        success = compacted.saveToFile(fileName);
+        if (success) {
+            *entries = newEntries;
+            fileSize = offset;
+            wastedSize = 0;
+        }
+    }
+    unlockMutex();
+    return success;
+}
+
+float RegionFile::getWastedRatio() {
+    lockMutex();
+    float ratio = fileSize > 0 ? (float) wastedSize / (float) fileSize : 0.0f;
+    unlockMutex();
+    return ratio;
+}
+
+bool RegionFile::createFile() {
+    BinaryBuffer header;
+    header.write((unsigned int) FILE_MAGIC);
+    header.write((unsigned short) FILE_VERSION);
+    header.write((unsigned short) REGION_SIZE);
+    RegionEntry emptyEntry = { 0, 0 };
+    for (int i = 0; i < REGION_SIZE * REGION_SIZE; i++) {
+        header.write(emptyEntry);
+    }
+    if (!header.saveToFile(fileName)) {
+        return false;
+    }
+    entries->assign(REGION_SIZE * REGION_SIZE, emptyEntry);
+    fileValid = true;
+    fileSize = HEADER_SIZE;
+    wastedSize = 0;
+    return true;
+}
+
+#ifdef _WIN32
+
+bool RegionFile::map() {
+    if (mappedData != nullptr) return true;
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        CloseHandle(file);
+        return false;
+    }
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    mappedData = (const char*) view;
+    mappedSize = (size_t) size.QuadPart;
+    return true;
+}
+
+void RegionFile::unmap() {
+    if (mappedData != nullptr) {
+        UnmapViewOfFile(mappedData);
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle((HANDLE) mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != nullptr) {
+        CloseHandle((HANDLE) fileHandle);
+        fileHandle = nullptr;
+    }
+}
+
+#else
+
+bool RegionFile::map() {
+    if (mappedData != nullptr) return true;
+    int file = ::open(fileName.c_str(), O_RDONLY);
+    if (file < 0) return false;
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+        ::close(file);
+        return false;
+    }
+    void *view = mmap(nullptr, (size_t) fileStat.st_size, PROT_READ, MAP_SHARED, file, 0);
+    // The mapping keeps its own reference to the file
+    ::close(file);
+    if (view == MAP_FAILED) return false;
+    mappedData = (const char*) view;
+    mappedSize = (size_t) fileStat.st_size;
+    return true;
+}
+
+void RegionFile::unmap() {
+    if (mappedData != nullptr) {
+        munmap((void*) mappedData, mappedSize);
+        mappedData = nullptr;
+        mappedSize = 0;
+    }
+}
+
+#endif
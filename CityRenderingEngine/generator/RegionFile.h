@@ -0,0 +1,116 @@
+/*
+ * Description: A RegionFile packs the files of REGION_SIZE x REGION_SIZE Chunks into a single file on the disk, so
+ * loading the Chunks around the camera doesn't need to open hundreds of small files. The file starts with a header
+ * containing an offset table, with the offset and size of each Chunk's data inside the file, followed by the data of
+ * the Chunks themselves. An offset of zero means the Chunk is not in the file.
+ *
+ * The offset table is kept in memory, so checking if a Chunk exists never touches the disk. Chunks are read through a
+ * read-only memory map of the file, which is only created when the first Chunk is read. New Chunks are always appended
+ * to the end of the file and then the offset table is updated, so a crash in the middle of a write never corrupts the
+ * Chunks that were already saved. Overwritten or removed Chunks leave unused space behind, which can be reclaimed
+ * with compact().
+ *
+ * All methods are thread safe, as the ChunkLoader workers may read and write Chunks of the same region concurrently.
+ */
+
+#pragma once
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+#include "../engine/input/BinaryBuffer.h"
+#include "../engine/input/FileIO.h"
+
+/* An entry of the offset table of a RegionFile. */
+struct RegionEntry {
+    unsigned int offset;
+    unsigned int size;
+};
+
+class RegionFile {
+public:
+
+    /* The number of Chunks on each side of the region. */
+    static const int REGION_SIZE = 32;
+    /* The first four bytes of every region file, "RGNF". */
+    static const unsigned int FILE_MAGIC = 0x464E4752;
+    /* Version of the region file format. Must be incremented whenever the format changes. */
+    static const unsigned short FILE_VERSION = 1;
+    /* Size of the header: magic, version, region size and the offset table. */
+    static const unsigned int HEADER_SIZE = 8 + REGION_SIZE * REGION_SIZE * sizeof(RegionEntry);
+
+    RegionFile(const std::string &fileName);
+    ~RegionFile(void);
+
+    /*
+     * Reads the offset table from the file, if the file exists. A file that doesn't exist is an empty region, and will
+     * be created on the first write. A file with an invalid header is also treated as empty, and will be replaced.
+     */
+    void open();
+
+    /* Closes the memory map and the file. The offset table is kept, and the file will be mapped again if needed. */
+    void close();
+
+    /* Returns true if the Chunk at index (x + z * REGION_SIZE, relative to the region) is stored in this file. */
+    bool hasChunk(int index);
+
+    /* Returns the size in bytes of the data of the Chunk at index, or zero if it's not stored. */
+    unsigned int getChunkSize(int index);
+
+    /* Copies the data of the Chunk at index to buffer. Returns false if the Chunk is not stored or can't be read. */
+    bool readChunk(int index, BinaryBuffer &buffer);
+
+    /* Appends the data in buffer to the file as the Chunk at index, replacing any previous data of that Chunk. */
+    bool writeChunk(int index, BinaryBuffer &buffer);
+
+    /* Removes the Chunk at index from the offset table. Its data is only removed from the file by compact(). */
+    bool removeChunk(int index);
+
+    /*
+     * Rewrites the file with only the data that's still referenced by the offset table, removing the space left by
+     * overwritten or removed Chunks. If the region has no Chunks left, the file is deleted.
+     */
+    bool compact();
+
+    /* Returns the fraction of the file, from 0 to 1, that's taken by data no longer used. */
+    float getWastedRatio();
+
+    std::string getFileName() { return fileName; }
+
+protected:
+
+    /* Maps the file to memory for reading, if it's not mapped yet. Returns false if it can't be mapped. */
+    bool map();
+
+    /* Releases the memory map, if any. Must be called before the file is modified. */
+    void unmap();
+
+    /* Writes a new file containing only the header, with the current offset table. */
+    bool createFile();
+
+    void lockMutex() { SDL_LockMutex(mutex); }
+    void unlockMutex() { SDL_UnlockMutex(mutex); }
+
+    /* The name of the file on the disk. */
+    std::string fileName;
+
+    /* The offset table, with REGION_SIZE * REGION_SIZE entries. */
+    std::vector<RegionEntry> *entries;
+
+    /* Indicates if the file exists on the disk with a valid header. */
+    bool fileValid;
+
+    /* The total size of the file, and how much of it is taken by data that's no longer referenced. */
+    unsigned int fileSize;
+    unsigned int wastedSize;
+
+    /* The memory mapped contents of the file, or nullptr if it's not mapped. */
+    const char *mappedData;
+    size_t mappedSize;
+
+    /* Platform handles of the memory map. */
+    void *fileHandle;
+    void *mappingHandle;
+
+    SDL_mutex *mutex;
+};
@@ -0,0 +1,100 @@
+#include "RegionManager.h"
+
+const float RegionManager::COMPACTION_THRESHOLD = 0.25f;
+std::map<long long, RegionFile*> *RegionManager::regions = nullptr;
+SDL_mutex *RegionManager::mutex = nullptr;
+
+void RegionManager::initialize() {
+    if (regions == nullptr) {
+        regions = new std::map<long long, RegionFile*>();
+        mutex = SDL_CreateMutex();
+    }
+}
+
+void RegionManager::terminate() {
+    if (regions == nullptr) return;
+    compactAll(COMPACTION_THRESHOLD);
+    SDL_LockMutex(mutex);
+    for (auto it = regions->begin(); it != regions->end(); it++) {
+        delete it->second;
+    }
+    regions->clear();
+    delete regions;
+    regions = nullptr;
+    SDL_UnlockMutex(mutex);
+    SDL_DestroyMutex(mutex);
+    mutex = nullptr;
+}
+
+bool RegionManager::chunkExists(const Vector2 &chunkPos) {
+    int index;
+    RegionFile *region = getRegion(chunkPos, index);
+    return region != nullptr && region->hasChunk(index);
+}
+
+unsigned int RegionManager::getChunkSize(const Vector2 &chunkPos) {
+    int index;
+    RegionFile *region = getRegion(chunkPos, index);
+    return region != nullptr ? region->getChunkSize(index) : 0;
+}
+
+bool RegionManager::readChunk(const Vector2 &chunkPos, BinaryBuffer &buffer) {
+    int index;
+    RegionFile *region = getRegion(chunkPos, index);
+    return region != nullptr && region->readChunk(index, buffer);
+}
+
+bool RegionManager::writeChunk(const Vector2 &chunkPos, BinaryBuffer &buffer) {
+    int index;
+    RegionFile *region = getRegion(chunkPos, index);
+    return region != nullptr && region->writeChunk(index, buffer);
+}
+
+bool RegionManager::removeChunk(const Vector2 &chunkPos) {
+    int index;
+    RegionFile *region = getRegion(chunkPos, index);
+    return region != nullptr && region->removeChunk(index);
+}
+
+void RegionManager::compactAll(float minWastedRatio) {
+    if (regions == nullptr) return;
+    SDL_LockMutex(mutex);
+    for (auto it = regions->begin(); it != regions->end(); it++) {
+        RegionFile *region = it->second;
+        if (region->getWastedRatio() > minWastedRatio) {
+            if (!region->compact()) {
+                std::cout << "Could not compact " << region->getFileName() << std::endl;
+            }
+        }
+    }
+    SDL_UnlockMutex(mutex);
+}
+
+void RegionManager::getRegionCoordinates(const Vector2 &chunkPos, int &regionX, int &regionZ, int &index) {
+    int chunkX = (int) floor(chunkPos.x / Chunk::CHUNK_SIZE);
+    int chunkZ = (int) floor(chunkPos.y / Chunk::CHUNK_SIZE);
+    regionX = (int) floor((float) chunkX / RegionFile::REGION_SIZE);
+    regionZ = (int) floor((float) chunkZ / RegionFile::REGION_SIZE);
+    int localX = chunkX - regionX * RegionFile::REGION_SIZE;
+    int localZ = chunkZ - regionZ * RegionFile::REGION_SIZE;
+    index = localX + localZ * RegionFile::REGION_SIZE;
+}
+
+RegionFile *RegionManager::getRegion(const Vector2 &chunkPos, int &index) {
+    if (regions == nullptr) return nullptr;
+    int regionX, regionZ;
+    getRegionCoordinates(chunkPos, regionX, regionZ, index);
+    long long key = (((long long) regionX) << 32) | ((long long) regionZ & 0xFFFFFFFFLL);
+    SDL_LockMutex(mutex);
+    RegionFile *region = nullptr;
+    auto it = regions->find(key);
+    if (it != regions->end()) {
+        region = it->second;
+    } else {
+        region = new RegionFile(getFileName(chunkPos));
+        region->open();
+        (*regions)[key] = region;
+    }
+    SDL_UnlockMutex(mutex);
+    return region;
+}
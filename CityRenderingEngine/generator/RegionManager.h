@@ -0,0 +1,83 @@
+/*
+ * Description: Keeps track of the RegionFiles where the Chunks are saved, and finds the correct RegionFile and offset
+ * table entry for each Chunk. Region files are opened the first time one of their Chunks is needed, and stay open
+ * until terminate() is called, so checking if a Chunk exists is just a lookup on the offset table in memory. This is
+ * an instance-less class, like ResourcesManager, and must be initialized before the ChunkLoader starts.
+ *
+ * When the game ends, region files with too much unused space are compacted. compactAll() can also be called at any
+ * other time, as a tool to reclaim all the unused space of the open regions.
+ */
+
+#pragma once
+
+#include <map>
+#include <SDL.h>
+#include <string>
+#include <sstream>
+#include "Chunk.h"
+#include "RegionFile.h"
+#include "../engine/math/Vector2.h"
+#include "../engine/input/BinaryBuffer.h"
+
+class RegionManager {
+public:
+
+    /* Region files with more than this fraction of unused space are compacted when the game ends. */
+    static const float COMPACTION_THRESHOLD;
+
+    /* Creates the region list. Must be called before any Chunk is saved or loaded. */
+    static void initialize();
+
+    /* Compacts the regions that need it, closes all region files and releases the memory. */
+    static void terminate();
+
+    /* Returns true if the Chunk at chunkPos is saved on its region file. */
+    static bool chunkExists(const Vector2 &chunkPos);
+
+    /* Returns the size in bytes of the data of the Chunk at chunkPos, or zero if it's not saved. */
+    static unsigned int getChunkSize(const Vector2 &chunkPos);
+
+    /* Copies the saved data of the Chunk at chunkPos to buffer. Returns false if it's not saved or can't be read. */
+    static bool readChunk(const Vector2 &chunkPos, BinaryBuffer &buffer);
+
+    /* Saves the data in buffer as the Chunk at chunkPos, replacing any previous data. */
+    static bool writeChunk(const Vector2 &chunkPos, BinaryBuffer &buffer);
+
+    /* Removes the Chunk at chunkPos from its region. */
+    static bool removeChunk(const Vector2 &chunkPos);
+
+    /* Compacts every open region file that has more than minWastedRatio of unused space. */
+    static void compactAll(float minWastedRatio = 0.0f);
+
+    /* Returns the name of the region file that contains the Chunk at chunkPos. */
+    static std::string getFileName(const Vector2 &chunkPos) {
+        int regionX, regionZ, index;
+        getRegionCoordinates(chunkPos, regionX, regionZ, index);
+        std::stringstream fileName;
+        fileName << "r." << regionX << "." << regionZ << ".rgn";
+        return fileName.str();
+    }
+
+protected:
+
+    /*
+     * Calculates the coordinates of the region that contains the Chunk at chunkPos, and the index of the Chunk inside
+     * that region's offset table. Works for negative positions as well.
+     */
+    static void getRegionCoordinates(const Vector2 &chunkPos, int &regionX, int &regionZ, int &index);
+
+    /*
+     * Returns the RegionFile that contains the Chunk at chunkPos, opening it if necessary, and sets index to the
+     * Chunk's index inside the region. Returns nullptr if the manager hasn't been initialized.
+     */
+    static RegionFile *getRegion(const Vector2 &chunkPos, int &index);
+
+    /* The open region files, indexed by their packed coordinates. */
+    static std::map<long long, RegionFile*> *regions;
+
+    /* Protects the regions map. Each RegionFile has its own mutex for its contents. */
+    static SDL_mutex *mutex;
+
+    RegionManager(void) {}
+    ~RegionManager(void) {}
+};
@@ -1,4 +1,7 @@
 #include "Road.h"
+#include "../engine/rendering/RenderQueue.h"
+
+const ShaderParameterHandle Road::ROAD_SCALE_PARAMETER = ShaderParameter::getHandle("roadScale");
 
 Road::Road(void) : Entity() {
     setModel(Model::getOrCreate(MODEL_ROAD, "resources/meshes/plane.obj", false));
@@ -20,15 +23,23 @@ Road::Road(Intersection *pointA, Intersection *pointB) : Entity() {
     this->numChunksSharing = 0;
 
     // Calculate the quad model rotation, position and scale
-    this->position = Vector3::average(pointA->getPosition(), pointB->getPosition());
-    this->rotation = pointB->getPosition() - pointA->getPosition();
-    Vector2 horizDiff = Vector2(rotation.x, rotation.z);
+    setPosition(Vector3::average(pointA->getPosition(), pointB->getPosition()));
+    Vector3 direction = pointB->getPosition() - pointA->getPosition();
+    Vector2 horizDiff = Vector2(direction.x, direction.z);
     float angle = atan2f(horizDiff.x, horizDiff.y) * (180 / PI);
     float distance = (pointA->getPosition() - pointB->getPosition()).getLength() - 20.0f;
-    this->rotation = Vector3(0, angle, 0);
-    this->scale = Vector3(10, 0, distance / 2.0f);
+    setRotation(Vector3(0, angle, 0));
+    setScale(Vector3(10, 0, distance / 2.0f));
     this->setRenderRadius(distance / 2.0f);
-    shader->addShaderParameter("roadScale", PARAMETER_FLOAT, &distance);
+}
+
+void Road::registerShaderParameters() {
+    Shader *roadShader = Shader::getOrCreate(SHADER_LIGHT_ROAD,
+        "resources/shaders/vertRoad.glsl", "resources/shaders/fragRoad.glsl", false);
+    if (roadShader->getShaderParameter(ROAD_SCALE_PARAMETER) == nullptr) {
+        // The value is owned by the parameter, and deleted with it
+        roadShader->addShaderParameter("roadScale", PARAMETER_FLOAT, new float(0));
+    }
 }
 
 Road::~Road(void) {
@@ -42,14 +53,11 @@ Road::~Road(void) {
     pointB = nullptr;
 }
 
-void Road::draw(float millisElapsed) {
+void Road::queueDraw(RenderQueue *queue, unsigned char /* planeMask */) {
     if (model != nullptr) {
-        Naquadah::getInstance()->getCurrentScene()->useShader(shader);
-        Naquadah::getRenderer()->updateShaderMatrix("modelMatrix", modelMatrix);
-        float distance = scale.z * 2.0f;
-        shader->getShaderParameter("roadScale")->setValue(&distance, false);
-        shader->updateShaderParameters(false);
-        model->draw();
+        const Matrix4 &modelMatrix = getModelMatrix();
+        RenderItem &item = queue->addModel(shader, model, nullptr, modelMatrix, modelMatrix.getPositionVector());
+        item.setFloatParameter(ROAD_SCALE_PARAMETER, getScale().z * 2.0f);
     }
 }
 
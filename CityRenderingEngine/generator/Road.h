@@ -18,11 +18,21 @@ class Intersection;
 class Road : public Entity {
 public:
 
+    /* Handle of the roadScale shader parameter, also used by Intersection. */
+    static const ShaderParameterHandle ROAD_SCALE_PARAMETER;
+
+    /*
+     * Adds the roadScale parameter to the shared Road Shader. It must be called once, on the main thread, before any
+     * Chunk is generated, as the parameters of a Shader can't be changed while the render thread is using them.
+     */
+    static void registerShaderParameters();
+
     Road(void);
     Road(Intersection *pointA, Intersection *pointB);
     virtual ~Road(void);
 
-    virtual void draw(float millisElapsed);
+    /* Adds the Model of this Road with its roadScale to queue. The Roads of a Chunk are instanced by the Chunk. */
+    virtual void queueDraw(RenderQueue *queue, unsigned char planeMask);
 
     void setPointA(Intersection *pointA);
     void setPointB(Intersection *pointB);
@@ -52,7 +62,7 @@ public:
 
     /* Calculates and returns the world position of this entity. */
     virtual Vector3 getWorldPosition() {
-        return Vector3(position);
+        return getPosition();
     }
 
 protected:
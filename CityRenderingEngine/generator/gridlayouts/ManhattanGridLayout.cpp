@@ -3,25 +3,28 @@
 ManhattanGridLayout::ManhattanGridLayout(const Vector2 &posMin, const Vector2 &posMax)
     : GridLayout(MANHATTAN_GRID_LAYOUT_ID, posMin, posMax) {}
 
-Vector2 ManhattanGridLayout::getIntersectionPosition() {
-    Vector2 position = Vector2(-100, -100);
+bool ManhattanGridLayout::getIntersectionPosition(RandomStream &random, Vector2 &position) {
     int blockWidth = 200;
     int blockDepth = 100;
     Vector2 posAvg = (posMax + posMin) / 2;
-    int offsetX = ((int) (posAvg.x)) % blockWidth;
-    int offsetY = ((int) (posAvg.y)) % blockDepth;
+    // Keep the modulo positive, so the grid is the same on both sides of the origin
+    int offsetX = ((((int) floor(posAvg.x)) % blockWidth) + blockWidth) % blockWidth;
+    int offsetY = ((((int) floor(posAvg.y)) % blockDepth) + blockDepth) % blockDepth;
     offsetX = abs(offsetX) > Chunk::SUBCHUNK_SIZE ? offsetX - blockWidth : offsetX;
     offsetY = abs(offsetY) > Chunk::SUBCHUNK_SIZE ? offsetY - blockDepth : offsetY;
     int maxOffsetAllowed = Chunk::SUBCHUNK_SIZE / 2;
     if (abs(offsetX) <= maxOffsetAllowed && abs(offsetY) <= maxOffsetAllowed) {
-        position.x = posAvg.x - (offsetX * generateRandom(0, 4));
-        position.y = posAvg.y - (offsetY * generateRandom(0, 4));
+        position.x = posAvg.x - (offsetX * random.nextFloat(0, 4));
+        position.y = posAvg.y - (offsetY * random.nextFloat(0, 4));
+        return true;
     }
-    return position;
+    return false;
 }
 
 void ManhattanGridLayout::generateRoads(Chunk *chunk, Intersection *newIntersection) {
-    std::vector<Intersection*> closestInter = chunk->getClosestIntersectionsTo(newIntersection, 4);
+    // All Intersections already exist when the Roads are generated, so look at the full neighbourhood: the four sides
+    // and the four diagonals
+    std::vector<Intersection*> closestInter = chunk->getClosestIntersectionsTo(newIntersection, 8);
     if (closestInter.size() > 0) {
         float bestDistX = 999999.0f;
         float bestDistZ = 999999.0f;
@@ -50,8 +53,12 @@ void ManhattanGridLayout::generateRoads(Chunk *chunk, Intersection *newIntersect
         }
         if (bestConnectionZ != nullptr) {
             bool intersectsOtherIntersection = false;
-            auto itEnd = chunk->getIntersections()->end();
-            for (auto it = chunk->getIntersections()->begin(); it != itEnd; it++) {
+            // Only the Intersections close enough to the new road's segment need to be checked
+            Vector3 segmentCentre = Vector3::average(newInterPos, bestConnectionZ->getPosition());
+            float segmentRadius = (newInterPos - bestConnectionZ->getPosition()).getLength() / 2.0f + 20.0f;
+            std::vector<Intersection*> nearby = chunk->getIntersectionsWithin(segmentCentre, segmentRadius);
+            auto itEnd = nearby.end();
+            for (auto it = nearby.begin(); it != itEnd; it++) {
                 if ((*it) == bestConnectionZ || (*it) == newIntersection)
                     continue;
                 Vector2 lineA = bestConnectionZ->getPosition().toVec2(Vector3(0, 1, 0));
@@ -81,8 +88,12 @@ void ManhattanGridLayout::generateRoads(Chunk *chunk, Intersection *newIntersect
 
         if (bestConnectionX != nullptr) {
            bool intersectsOtherIntersection = false;
-            auto itEnd = chunk->getIntersections()->end();
-            for (auto it = chunk->getIntersections()->begin(); it != itEnd; it++) {
+            // Only the Intersections close enough to the new road's segment need to be checked
+            Vector3 segmentCentre = Vector3::average(newInterPos, bestConnectionX->getPosition());
+            float segmentRadius = (newInterPos - bestConnectionX->getPosition()).getLength() / 2.0f + 20.0f;
+            std::vector<Intersection*> nearby = chunk->getIntersectionsWithin(segmentCentre, segmentRadius);
+            auto itEnd = nearby.end();
+            for (auto it = nearby.begin(); it != itEnd; it++) {
                 if ((*it) == bestConnectionX || (*it) == newIntersection)
                     continue;
                 Vector2 lineA = bestConnectionX->getPosition().toVec2(Vector3(0, 1, 0));
@@ -22,10 +22,10 @@ public:
     virtual ~ManhattanGridLayout(void) {}
 
     /*
-     * Calculates and returns a Vector2 position indicating the position of the intersection in the bounding space.
-     * This function will return (-1, -1) if there's no Intersection inside the bounding space provided. 
+     * Calculates the world position of the intersection in the bounding space and stores it in position. Returns
+     * false if there's no Intersection inside the bounding space provided.
      */
-    virtual Vector2 getIntersectionPosition();
+    virtual bool getIntersectionPosition(RandomStream &random, Vector2 &position);
 
     /*
      * This function should generate Roads from the newest Intersection created for the chunk. It must ensure that all
@@ -0,0 +1,91 @@
+/*
+ * Description: A small deterministic random number generator, used by the city generation instead of the global
+ * rand(). It's a counter-based generator: each number is the SplitMix64 hash of a key and an increasing counter, so it
+ * has no hidden global state, costs only a few multiplications per number, and two streams with different keys are
+ * completely independent from each other.
+ *
+ * Each Chunk gets its own stream, keyed by the City seed and the Chunk coordinates, so the same Chunk is always
+ * generated exactly the same way, no matter in which order or in which thread the Chunks are generated. Streams for
+ * smaller things (like a single CityBlock) can be derived from a parent stream with derive(), or keyed directly by a
+ * world position with forPosition(), which makes them independent of how many numbers were drawn before.
+ */
+
+#pragma once
+
+#include <cmath>
+
+class RandomStream {
+public:
+
+    RandomStream(void) : key(0), counter(0) {}
+    RandomStream(unsigned long long seed) : key(mix(seed)), counter(0) {}
+
+    /* Returns the stream used to generate the Chunk at chunkPos (its bottom left corner) for the given City seed. */
+    static RandomStream forChunk(unsigned long long citySeed, float chunkPosX, float chunkPosY) {
+        return RandomStream(citySeed).derive(hashCoordinates((int) chunkPosX, (int) chunkPosY));
+    }
+
+    /*
+     * Returns a stream keyed by a world position, rounded to the meter. This should be used for things that may be
+     * generated by more than one Chunk, like CityBlocks on the edges, so they come out the same in both.
+     */
+    static RandomStream forPosition(unsigned long long citySeed, float posX, float posZ) {
+        return RandomStream(citySeed ^ 0x9E3779B97F4A7C15ULL).derive(hashCoordinates((int) floor(posX + 0.5f),
+            (int) floor(posZ + 0.5f)));
+    }
+
+    /* Creates a new independent stream from this one, identified by id. This stream's counter is not affected. */
+    RandomStream derive(unsigned long long id) const {
+        RandomStream child;
+        child.key = mix(key ^ mix(id + 0x632BE59BD9B4E019ULL));
+        return child;
+    }
+
+    /* Returns the next 64 bit random number of the stream. */
+    unsigned long long nextLong() {
+        return mix(key + (++counter) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    /* Returns the next random number of the stream as a float between 0 and 1, inclusive. */
+    float nextFloat() {
+        // The 24 highest bits fit exactly in a float's mantissa
+        return (float) (nextLong() >> 40) / (float) 0xFFFFFF;
+    }
+
+    /* Returns the next random number of the stream as a float ranging from min to max. Same as generateRandom(). */
+    float nextFloat(float min, float max) {
+        return (nextFloat() * (max - min)) + min;
+    }
+
+    /* Returns the next random number of the stream as an int ranging from min to max, both inclusive. */
+    int nextInt(int min, int max) {
+        if (max <= min) return min;
+        return min + (int) (nextLong() % (unsigned long long) (max - min + 1));
+    }
+
+    /* Returns the key of this stream. Two streams with the same key and counter generate the same numbers. */
+    unsigned long long getKey() const { return key; }
+
+    /* Returns how many numbers were already generated by this stream. */
+    unsigned long long getCounter() const { return counter; }
+
+    /* The SplitMix64 finalizer. Scrambles all the bits of value, and is also used as a general purpose hash. */
+    static unsigned long long mix(unsigned long long value) {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+
+    /* Packs a pair of integer coordinates into a single 64 bit value. */
+    static unsigned long long hashCoordinates(int x, int y) {
+        return (((unsigned long long) (unsigned int) x) << 32) | (unsigned long long) (unsigned int) y;
+    }
+
+protected:
+
+    /* The key of this stream, derived from the seed. */
+    unsigned long long key;
+
+    /* The number of values already generated. Each value is the hash of the key and the counter. */
+    unsigned long long counter;
+};
@@ -16,11 +16,17 @@
 #include <SDL.h>
 #include "engine/Naquadah.h"
 
+#include "engine/JobSystem.h"
 #include "engine/ResourcesManager.h"
+#include "engine/rendering/UploadQueue.h"
+#include "engine/rendering/ObjBenchmark.h"
 #include "generator/CityScene.h"
 #include "generator/City.h"
 
 #include "generator/ChunkGenerator.h"
+#include "generator/ChunkBenchmark.h"
+#include "generator/ChunkLoader.h"
+#include "generator/RegionManager.h"
 
 int main(int argc, char* argv[]) {
 
@@ -29,7 +35,16 @@ int main(int argc, char* argv[]) {
     Naquadah::initialize(Naquadah::NAQUADAH_INIT_EVERYTHING);
 
     // Create the first Scene and start the game
-    CityScene *scene = new CityScene(new City());
+    unsigned long long citySeed = (unsigned long long) ConfigurationManager::getInstance()->readInt("citySeed", 0);
+    RegionManager::initialize();
+    // The shared shaders get their parameters now, as the Chunks are generated on other threads
+    Building::registerShaderParameters();
+    Road::registerShaderParameters();
+    City *city = new City(citySeed);
+    // Compare the time to load chunks from their files against generating them, if requested on the configurations
+    ChunkBenchmark::run(city, ConfigurationManager::getInstance()->readInt("chunkBenchmark", 0));
+    ObjBenchmark::run(ConfigurationManager::getInstance()->readString("objBenchmark", ""));
+    CityScene *scene = new CityScene(city);
     Naquadah::getInstance()->setNextScene(scene);
 
     //Shader *shader = Shader::getOrCreate("LightShader", "resources/shaders/vertNormal.glsl", "resources/shaders/fragLight.glsl");
@@ -52,6 +67,7 @@ int main(int argc, char* argv[]) {
     Profiler::addProfilingTimer(entityLoopTimer);
     Profiler::addProfilingTimer(creationTimer);
     Profiler::addProfilingTimer(new ProfilingTimer(4, 1));
+    Profiler::addProfilingTimer(new ProfilingTimer(5, 10)); // Occlusion pass
     Profiler::startProfiler();
 
     //Chunk *chunk = ChunkGenerator::generateChunk(Vector2(0, 0));
@@ -73,6 +89,10 @@ int main(int argc, char* argv[]) {
 
     Naquadah::getInstance()->runGame();
 
-    // Cleanup after the game ends
+    // Cleanup after the game ends. The workers must stop before the region files are closed
+    ChunkLoader::terminate();
+    JobSystem::terminate();
+    RegionManager::terminate();
+    UploadQueue::terminate();
     return 0;
 }
\ No newline at end of file
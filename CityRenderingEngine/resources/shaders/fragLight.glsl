@@ -1,5 +1,13 @@
 # version 440 core
 
+// The variants of this shader (see LightShader) define one of LIGHT_POINT, LIGHT_SPOT or LIGHT_DIRECTIONAL, one of
+// SURFACE_BUILDING or SURFACE_GROUND, and FOG if the fog is on. Without them, this is the generic shader, which picks
+// the light and the surface at runtime, and always has fog.
+#if !defined(LIGHT_POINT) && !defined(LIGHT_SPOT) && !defined(LIGHT_DIRECTIONAL)
+#define LIGHT_ANY
+#define FOG
+#endif
+
 uniform sampler2D texture0;
 
 // Light variables
@@ -12,10 +20,20 @@ struct LightSource {
     int type; // 1 = POINT, 2 = SPOT, 3 = DIRECTIONAL
 };
 
-uniform LightSource lightSource;
+// Data shared by all Shaders, updated once per frame. Must match FrameData in FrameUniforms.h
+layout(std140) uniform FrameData {
+    mat4 viewMatrix;
+    mat4 projMatrix;
+    mat4 viewProjMatrix;
+    vec4 cameraPosition;
+    vec4 lightPosition; // w = radius
+    vec4 lightDirection; // w = intensity
+    vec4 lightColour; // w = type
+    vec4 fogColour;
+    vec4 fogDistance; // x = start, y = end
+};
 
 uniform float time;
-uniform int numFloors;
 
 in Vertex {
 	vec3 worldPos;
@@ -25,18 +43,17 @@ in Vertex {
 	vec3 normal;
     vec3 cameraPos;
     vec4 viewSpace;
+    flat int numFloors;
 } IN;
 
 out vec4 gl_FragColor;
 
-const vec4 fogColour = vec4(0.0, 0.0, 0.0, 0.0);
 const float fogDensity = 0.05;
 
-void main(void) {
-    // Calculate correct uv_map
-    //numFloors = 7;
-    vec2 correctUv = IN.uv_map;
-    float uvY = IN.uv_map.y;
+// Remaps the uv_map of a building to the floors of its texture: the top, middle and ground floors, and the roof.
+vec2 buildingUv(vec2 uv_map, int numFloors) {
+    vec2 correctUv = uv_map;
+    float uvY = uv_map.y;
     if (numFloors >= 3) {
         if (uvY <= 1) {
             // Top floor
@@ -66,97 +83,103 @@ void main(void) {
     if (uvY < 0) {
         // Roof of the building
         correctUv.x = 1.0 - abs(correctUv.x);
-        correctUv.y = abs(fract(IN.uv_map.y) / 7.0) * 4.0;
+        correctUv.y = abs(fract(uv_map.y) / 7.0) * 4.0;
     }
+    return correctUv;
+}
+
+// POINT and SPOT LIGHT
+vec3 pointLight(LightSource lightSource, vec4 texCol) {
+    vec3 incident = normalize(lightSource.position - IN.worldPos);
+    vec3 viewDir = normalize(IN.cameraPos - IN.worldPos);
+    vec3 halfDir = normalize(incident + viewDir);
+
+    float dist = length(lightSource.position - IN.worldPos);
+    float atten = 0.8 - clamp(dist / (lightSource.radius * lightSource.radius), 0.0, 1.0);
+
+    float lambert = max(0.0, dot(incident, IN.normal));
+
+    float rFactor = max(0.0, dot(halfDir, IN.normal));
+    float sFactor = pow(rFactor, 10.0);
+
+    vec3 ambient = texCol.rgb * lightSource.colour * 0.05;
+    vec3 diffuse = texCol.rgb * lightSource.colour * lambert * atten * lightSource.intensity;
+    vec3 specular = lightSource.colour * sFactor * atten * lightSource.intensity;
     
-    if (numFloors < 0) {
-        // It's not a building at all! Leave the uv_map alone!
-        correctUv = IN.uv_map;
-    }
+    return vec3(ambient + diffuse + specular);
+}
+
+// DIRECTIONAL LIGHT, with gamma correction and fog
+vec4 directionalLight(LightSource lightSource, vec4 texCol) {
+    vec3 incident = normalize(-lightSource.direction);
+    vec3 viewDir = normalize(IN.cameraPos - IN.worldPos);
+    vec3 halfDir = normalize(viewDir - incident);
+
+    float lambert = max(0.0, dot(incident, IN.normal));
+
+    float rFactor = max(0.0, dot(IN.normal, halfDir));
+    float sFactor = pow(rFactor, 16.0);
+
+    // Calculate ambient, diffuse and specular lighting
+    vec3 texLightCol = texCol.rgb * lightSource.colour;
+    vec3 ambient = texLightCol * 0.2;
+    vec3 diffuse = texLightCol * lambert * lightSource.intensity;
+    vec3 specular = texLightCol * sFactor * lightSource.intensity;
+    
+    // Calculate rim lighting
+    float gamma = 1.0/0.7;
+    vec3 rimColour = vec3(0.15, 0.10, 0.05) + (vec3(0.05, 0.05, 0.05) * texLightCol);
+    float rim = 1.0 - max(dot(viewDir, IN.worldNormal), 0.0);
+    rim = smoothstep(0.6, 1.0, rim);
+    vec3 finalRim = rimColour * vec3(rim, rim, rim);
     
+    vec3 finalColour = vec3(ambient + diffuse + finalRim);
+    vec4 finalColourGamma = vec4(pow(finalColour.r, gamma), pow(finalColour.g, gamma), pow(finalColour.b, gamma),
+        texCol.w);
+    
+#ifdef FOG
+    // Calculate fog
+    //float dist = abs(IN.viewSpace.z);
+    float dist = length(IN.viewSpace);
+    float heightFactor = 0.5 + clamp(IN.cameraPos.y / 3000.0, 0.0, 1.0);
+    float fogMinDist = fogDistance.x * heightFactor;
+    float fogMaxDist = fogDistance.y * heightFactor;
+    float fogFactor = (fogMaxDist - dist) / (fogMaxDist - fogMinDist);
+    fogFactor = clamp(fogFactor, 0.0, 1.0);
+    
+    finalColourGamma = mix(fogColour, finalColourGamma, fogFactor);
+#endif
+    return finalColourGamma;
+}
+
+void main(void) {
+    LightSource lightSource = LightSource(lightPosition.xyz, lightDirection.xyz, lightColour.rgb, lightPosition.w,
+        lightDirection.w, int(lightColour.w));
+    // Calculate correct uv_map
+#if defined(SURFACE_BUILDING)
+    vec2 correctUv = buildingUv(IN.uv_map, IN.numFloors);
+#elif defined(SURFACE_GROUND)
+    vec2 correctUv = IN.uv_map;
+#else
+    // If numFloors is negative, it's not a building at all! Leave the uv_map alone!
+    vec2 correctUv = (IN.numFloors < 0) ? IN.uv_map : buildingUv(IN.uv_map, IN.numFloors);
+#endif
     
 	vec3 finalColour = vec3(0, 0, 0);
     vec4 finalColourGamma = vec4(0, 0, 0, 0);
 	vec4 texCol = texture(texture0, correctUv);
     //vec4 texCol = vec4(1,1,1,1);
 	
-	for(int i = 0; i < 1; i++) {
-        if (lightSource.type == 1) {
-            // POINT LIGHT
-            vec3 incident = normalize(lightSource.position - IN.worldPos);
-            vec3 viewDir = normalize(IN.cameraPos - IN.worldPos);
-            vec3 halfDir = normalize(incident + viewDir);
-
-            float dist = length(lightSource.position - IN.worldPos);
-            float atten = 0.8 - clamp(dist / (lightSource.radius * lightSource.radius), 0.0, 1.0);
-
-            float lambert = max(0.0, dot(incident, IN.normal));
-
-            float rFactor = max(0.0, dot(halfDir, IN.normal));
-            float sFactor = pow(rFactor, 10.0);
-
-            vec3 ambient = texCol.rgb * lightSource.colour * 0.05;
-            vec3 diffuse = texCol.rgb * lightSource.colour * lambert * atten * lightSource.intensity;
-            vec3 specular = lightSource.colour * sFactor * atten * lightSource.intensity;
-            
-            finalColour = vec3(ambient + diffuse + specular);
-        } else if (lightSource.type == 2) {
-            // SPOT LIGHT
-            vec3 incident = normalize(lightSource.position - IN.worldPos);
-            vec3 viewDir = normalize(IN.cameraPos - IN.worldPos);
-            vec3 halfDir = normalize(incident + viewDir);
-
-            float dist = length(lightSource.position - IN.worldPos);
-            float atten = 0.8 - clamp(dist / (lightSource.radius * lightSource.radius), 0.0, 1.0);
-
-            float lambert = max(0.0, dot(incident, IN.normal));
-
-            float rFactor = max(0.0, dot(halfDir, IN.normal));
-            float sFactor = pow(rFactor, 10.0);
-
-            vec3 ambient = texCol.rgb * lightSource.colour * 0.05;
-            vec3 diffuse = texCol.rgb * lightSource.colour * lambert * atten * lightSource.intensity;
-            vec3 specular = lightSource.colour * sFactor * atten * lightSource.intensity;
-            
-            finalColour = vec3(ambient + diffuse + specular);
-        } else {
-            // DIRECTIONAL LIGHT
-            vec3 incident = normalize(-lightSource.direction);
-            vec3 viewDir = normalize(IN.cameraPos - IN.worldPos);
-            vec3 halfDir = normalize(viewDir - incident);
-
-            float lambert = max(0.0, dot(incident, IN.normal));
-
-            float rFactor = max(0.0, dot(IN.normal, halfDir));
-            float sFactor = pow(rFactor, 16.0);
-
-            // Calculate ambient, diffuse and specular lighting
-            vec3 texLightCol = texCol.rgb * lightSource.colour;
-            vec3 ambient = texLightCol * 0.2;
-            vec3 diffuse = texLightCol * lambert * lightSource.intensity;
-            vec3 specular = texLightCol * sFactor * lightSource.intensity;
-            
-            // Calculate rim lighting
-            float gamma = 1.0/0.7;
-            vec3 rimColour = vec3(0.15, 0.10, 0.05) + (vec3(0.05, 0.05, 0.05) * texLightCol);
-            float rim = 1.0 - max(dot(viewDir, IN.worldNormal), 0.0);
-            rim = smoothstep(0.6, 1.0, rim);
-            vec3 finalRim = rimColour * vec3(rim, rim, rim);
-            
-            // Calculate fog
-            //float dist = abs(IN.viewSpace.z);
-            float dist = length(IN.viewSpace);
-            float heightFactor = 0.5 + clamp(IN.cameraPos.y / 3000.0, 0.0, 1.0);
-            float fogMinDist = 3000 * heightFactor;
-            float fogMaxDist = 4000 * heightFactor;
-            float fogFactor = (fogMaxDist - dist) / (fogMaxDist - fogMinDist);
-            fogFactor = clamp(fogFactor, 0.0, 1.0);
-            
-            finalColour = vec3(ambient + diffuse + finalRim);
-            finalColourGamma = vec4(pow(finalColour.r, gamma), pow(finalColour.g, gamma), pow(finalColour.b, gamma), texCol.w);
-            
-            finalColourGamma = mix(fogColour, finalColourGamma, fogFactor);
-        }
-	}
+#if defined(LIGHT_POINT) || defined(LIGHT_SPOT)
+    finalColour = pointLight(lightSource, texCol);
+#elif defined(LIGHT_DIRECTIONAL)
+    finalColourGamma = directionalLight(lightSource, texCol);
+#else
+    if (lightSource.type == 1 || lightSource.type == 2) {
+        finalColour = pointLight(lightSource, texCol);
+    } else {
+        finalColourGamma = directionalLight(lightSource, texCol);
+    }
+#endif
 	gl_FragColor = finalColourGamma;
 }
\ No newline at end of file
@@ -12,7 +12,18 @@ struct LightSource {
     int type; // 1 = POINT, 2 = SPOT, 3 = DIRECTIONAL
 };
 
-uniform LightSource lightSource;
+// Data shared by all Shaders, updated once per frame. Must match FrameData in FrameUniforms.h
+layout(std140) uniform FrameData {
+    mat4 viewMatrix;
+    mat4 projMatrix;
+    mat4 viewProjMatrix;
+    vec4 cameraPosition;
+    vec4 lightPosition; // w = radius
+    vec4 lightDirection; // w = intensity
+    vec4 lightColour; // w = type
+    vec4 fogColour;
+    vec4 fogDistance; // x = start, y = end
+};
 
 uniform float time;
 
@@ -27,6 +38,8 @@ in Vertex {
 out vec4 gl_FragColor;
 
 void main(void) {
+    LightSource lightSource = LightSource(lightPosition.xyz, lightDirection.xyz, lightColour.rgb, lightPosition.w,
+        lightDirection.w, int(lightColour.w));
 	vec3 finalColour = vec3(0, 0, 0);
     vec4 texCol = vec4(1,1,1,1);
 	
@@ -12,10 +12,20 @@ struct LightSource {
     int type; // 1 = POINT, 2 = SPOT, 3 = DIRECTIONAL
 };
 
-uniform LightSource lightSource;
+// Data shared by all Shaders, updated once per frame. Must match FrameData in FrameUniforms.h
+layout(std140) uniform FrameData {
+    mat4 viewMatrix;
+    mat4 projMatrix;
+    mat4 viewProjMatrix;
+    vec4 cameraPosition;
+    vec4 lightPosition; // w = radius
+    vec4 lightDirection; // w = intensity
+    vec4 lightColour; // w = type
+    vec4 fogColour;
+    vec4 fogDistance; // x = start, y = end
+};
 
 uniform float time;
-uniform float roadScale;
 
 in Vertex {
 	vec3 worldPos;
@@ -25,17 +35,19 @@ in Vertex {
 	vec3 normal;
     vec3 cameraPos;
     vec4 viewSpace;
+    flat float roadScale;
 } IN;
 
 out vec4 gl_FragColor;
 
-const vec4 fogColour = vec4(0.0, 0.0, 0.0, 0.0);
 const float fogDensity = 0.05;
 
-void main(void) {    
+void main(void) {
+    LightSource lightSource = LightSource(lightPosition.xyz, lightDirection.xyz, lightColour.rgb, lightPosition.w,
+        lightDirection.w, int(lightColour.w));
     
     vec2 correctUv = IN.uv_map;
-    correctUv.x *= roadScale / 20.0;
+    correctUv.x *= IN.roadScale / 20.0;
     
 	vec3 finalColour = vec3(0, 0, 0);
     vec4 finalColourGamma = vec4(0, 0, 0, 0);
@@ -70,8 +82,8 @@ void main(void) {
         //float dist = abs(IN.viewSpace.z);
         float dist = length(IN.viewSpace);
         float heightFactor = 0.5 + clamp(IN.cameraPos.y / 3000.0, 0.0, 1.0);
-        float fogMinDist = 3000 * heightFactor;
-        float fogMaxDist = 4000 * heightFactor;
+        float fogMinDist = fogDistance.x * heightFactor;
+        float fogMaxDist = fogDistance.y * heightFactor;
         float fogFactor = (fogMaxDist - dist) / (fogMaxDist - fogMinDist);
         fogFactor = clamp(fogFactor, 0.0, 1.0);
         
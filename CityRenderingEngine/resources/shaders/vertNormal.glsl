@@ -1,14 +1,30 @@
 # version 330 core
 
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projMatrix;
+
+// Data shared by all Shaders, updated once per frame. Must match FrameData in FrameUniforms.h
+layout(std140) uniform FrameData {
+    mat4 viewMatrix;
+    mat4 projMatrix;
+    mat4 viewProjMatrix;
+    vec4 cameraPosition;
+    vec4 lightPosition; // w = radius
+    vec4 lightDirection; // w = intensity
+    vec4 lightColour; // w = type
+    vec4 fogColour;
+    vec4 fogDistance; // x = start, y = end
+};
+
 uniform float time;
+uniform int instanced; // When set, the model matrix comes from the instance attributes, see InstanceBatch
+uniform int numFloors; // -2 means the number of floors comes from the floors attribute, see CityBlock::draw()
 
 in vec3 position;
 in vec4 colour;
 in vec2 uv_map;
 in vec3 normal;
+in float floors;
+in mat4 instanceMatrix;
 
 out Vertex {
 	vec3 worldPos;
@@ -18,21 +34,24 @@ out Vertex {
 	vec3 normal;
     vec3 cameraPos;
     vec4 viewSpace;
+    flat int numFloors;
 } OUT;
 
 void main(void) {
-    mat3 modelMat3 = mat3(modelMatrix);
+    mat4 model = (instanced != 0) ? instanceMatrix : modelMatrix;
+    mat3 modelMat3 = mat3(model);
 	OUT.worldPos = modelMat3 * position;
     OUT.worldPos = normalize(modelMat3 * normal);
-    OUT.viewSpace = viewMatrix * modelMatrix * vec4(position, 1);
+    OUT.viewSpace = viewMatrix * model * vec4(position, 1);
     
 	gl_Position = projMatrix * OUT.viewSpace;
 
 	OUT.uv_map = uv_map;
 	OUT.colour = colour;
+    OUT.numFloors = (numFloors == -2) ? int(round(floors)) : numFloors;
 
-	mat3 normalMatrix = transpose(inverse(mat3(modelMatrix)));
+	mat3 normalMatrix = transpose(inverse(mat3(model)));
     
     OUT.normal = normalize(normalMatrix * normal);
-    OUT.cameraPos = -(viewMatrix[3].xyz) * mat3(viewMatrix);
+    OUT.cameraPos = cameraPosition.xyz;
 }
\ No newline at end of file